@@ -0,0 +1,75 @@
+#ifndef ARRAY_STRUCT_H_INCLUDED
+#define ARRAY_STRUCT_H_INCLUDED
+ 
+#include <stdlib.h>
+#include "linear_sequence.h"
+#include "../Instrumentation/instrumentation.h"
+ 
+#define PERCENT_LOW_LINE 0.5
+#define GROWTH_FACTOR 2
+ 
+#define ARRAY_FILE_MAGIC "LSQARRAY"
+#define ARRAY_FILE_MAGIC_SIZE 8
+#define ARRAY_FILE_VERSION 1
+ 
+/* Заголовок файла массива, за ним сразу идут realSize элементов. size записывается при уничтожении *
+ * контейнера, после чего хвост емкости отрезается, так что длина файла соответствует size.        */
+typedef struct {
+    char magic[ARRAY_FILE_MAGIC_SIZE];
+    LSQ_IntegerIndexT version;
+    LSQ_IntegerIndexT size;
+} ArrayFileHeader;
+ 
+/* Файл, отображенный в память целиком: header - начало отображения, advice - подсказка madvise, *
+ * которая повторяется после каждого mremap                                                      */
+typedef struct {
+    int descriptor;
+    ArrayFileHeader *header;
+    size_t mappedBytes;
+    int advice;
+} ArrayFile;
+ 
+/* Непрерывный буфер значений: realSize - выделено, logicalSize - занято. Если file задан, *
+ * value указывает в отображение файла сразу за заголовком, иначе буфер выделен в куче.   */
+typedef struct ArrayStruct_ {
+    LSQ_BaseTypeT *value;
+    LSQ_IntegerIndexT realSize;
+    LSQ_IntegerIndexT logicalSize;
+    ArrayFile *file;
+#ifdef LSQ_STATS
+    LSQ_StatsT stats;
+#endif
+#ifdef LSQ_LATENCY
+    LatencyProfile *latency;
+#endif
+    /* Соседи в списке живых контейнеров */
+    struct ArrayStruct_ *nextLive;
+    struct ArrayStruct_ *prevLive;
+} ArrayStruct;
+ 
+/* Функция, меняющая длину файла и емкость отображенного массива. Возвращает 0, если длину файла или *
+ * отображение изменить не удалось; массив тогда остается прежним.                                   */
+extern int resizeMapping(ArrayStruct *array, LSQ_IntegerIndexT size);
+ 
+/* Перевыделение буфера в куче. Очередь с приоритетом пользуется только им и потому собирается *
+ * без linear_sequence.c, где определен resizeMapping. При неудаче прежний буфер сохраняется.  */
+static inline int setHeapSize(ArrayStruct *array, LSQ_IntegerIndexT size) {
+    STATS_ADD(array, reallocCalls, 1);
+    LSQ_BaseTypeT *newValue = (LSQ_BaseTypeT *) realloc(array->value, size * sizeof(LSQ_BaseTypeT));
+    if (newValue == LSQ_HandleInvalid && size > 0)
+        return 0;
+    array->value = newValue;
+    array->realSize = size;
+    return 1;
+}
+ 
+/* Возвращает 0, если емкость изменить не удалось: вставка тогда не должна писать за realSize */
+static inline int setSize(ArrayStruct *array, LSQ_IntegerIndexT size) {
+    if (array->file != LSQ_HandleInvalid) {
+        STATS_ADD(array, reallocCalls, 1);
+        return resizeMapping(array, size);
+    }
+    return setHeapSize(array, size);
+}
+ 
+#endif
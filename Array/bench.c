@@ -0,0 +1,101 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include "priority_queue.h"
+#include "bench_util.h"
+#include "bench_tree.h"
+ 
+/* Очередь планировщика: извлечение минимума и добавление элемента с большим приоритетом */
+static double holdQueue(LSQ_IntegerIndexT arity, LSQ_IntegerIndexT size, LSQ_IntegerIndexT operations,
+                        long long *checksum) {
+    seed = 1;
+    PQ_HandleT queue = PQ_CreateQueue(arity);
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        PQ_Push(queue, (LSQ_IntegerIndexT) (nextRandom() % (16 * size)), i);
+    double start = getTime();
+    for (LSQ_IntegerIndexT i = 0; i < operations; i++) {
+        LSQ_IntegerIndexT priority;
+        LSQ_BaseTypeT value;
+        PQ_PopMin(queue, &priority, &value);
+        *checksum += value;
+        PQ_Push(queue, priority + 1 + (LSQ_IntegerIndexT) (nextRandom() % (16 * size)), i);
+    }
+    double elapsed = getTime() - start;
+    PQ_DestroyQueue(queue);
+    return elapsed * 1e9 / operations;
+}
+ 
+static void benchHold(void) {
+    static const LSQ_IntegerIndexT sizes[] = {1000, 100000, 1000000};
+    LSQ_IntegerIndexT operations = 2000000;
+ 
+    for (int s = 0; s < 3; s++) {
+        long long checksum = 0;
+        double binary = holdQueue(2, sizes[s], operations, &checksum);
+        double quaternary = holdQueue(4, sizes[s], operations, &checksum);
+        double tree = holdTree(sizes[s], operations, &checksum);
+        printf("n=%-8d: binary heap %6.1f ns, 4-ary heap %6.1f ns, Tree %7.1f ns per pop + push (checksum %lld)\n",
+               sizes[s], binary, quaternary, tree, checksum);
+    }
+}
+ 
+static void benchBuild(void) {
+    LSQ_IntegerIndexT size = 1000000;
+    LSQ_IntegerIndexT *priorities = (LSQ_IntegerIndexT *) malloc(size * sizeof(LSQ_IntegerIndexT));
+    LSQ_BaseTypeT *values = (LSQ_BaseTypeT *) malloc(size * sizeof(LSQ_BaseTypeT));
+    seed = 1;
+    for (LSQ_IntegerIndexT i = 0; i < size; i++) {
+        priorities[i] = (LSQ_IntegerIndexT) nextRandom();
+        values[i] = i;
+    }
+ 
+    for (LSQ_IntegerIndexT arity = 2; arity <= 4; arity += 2) {
+        double start = getTime();
+        PQ_HandleT queue = PQ_CreateQueue(arity);
+        for (LSQ_IntegerIndexT i = 0; i < size; i++)
+            PQ_Push(queue, priorities[i], values[i]);
+        double pushTime = getTime() - start;
+        PQ_DestroyQueue(queue);
+ 
+        start = getTime();
+        queue = PQ_CreateQueue(arity);
+        PQ_Heapify(queue, priorities, values, size, NULL);
+        double heapifyTime = getTime() - start;
+ 
+        start = getTime();
+        while (PQ_PopMin(queue, NULL, NULL))
+            ;
+        double drainTime = getTime() - start;
+        PQ_DestroyQueue(queue);
+        printf("arity %d n=%d: push one by one %6.1f ms, heapify %6.1f ms, drain %6.1f ms\n",
+               arity, size, pushTime * 1e3, heapifyTime * 1e3, drainTime * 1e3);
+    }
+ 
+    buildTree(priorities, values, size);
+    free(priorities);
+    free(values);
+}
+ 
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} Benchmark;
+ 
+static const Benchmark benchmarks[] = {
+    {"hold", benchHold},
+    {"build", benchBuild},
+};
+ 
+int main(int argc, char **argv) {
+    int count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    for (int i = 0; i < count; i++) {
+        int selected = (argc == 1);
+        for (int j = 1; j < argc; j++)
+            selected |= (strcmp(argv[j], benchmarks[i].name) == 0);
+        if (selected) {
+            printf("== %s\n", benchmarks[i].name);
+            benchmarks[i].run();
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include "../Tree/linear_sequence_assoc.h"
+#include "bench_util.h"
+#include "bench_tree.h"
+ 
+/* Очередь планировщика на дереве, как holdQueue в bench.c. В дереве ключи уникальны, *
+ * поэтому совпавший ключ сдвигается до свободного.                                    */
+double holdTree(LSQ_IntegerIndexT size, LSQ_IntegerIndexT operations, long long *checksum) {
+    seed = 1;
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        LSQ_InsertElement(handle, (LSQ_IntegerIndexT) (nextRandom() % (16 * size)), i);
+    double start = getTime();
+    for (LSQ_IntegerIndexT i = 0; i < operations; i++) {
+        LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+        LSQ_IntegerIndexT priority = LSQ_GetIteratorKey(iterator);
+        *checksum += *LSQ_DereferenceIterator(iterator);
+        LSQ_DestroyIterator(iterator);
+        LSQ_DeleteFrontElement(handle);
+        LSQ_IntegerIndexT key = priority + 1 + (LSQ_IntegerIndexT) (nextRandom() % (16 * size));
+        for (iterator = LSQ_GetElementByIndex(handle, key); LSQ_IsIteratorDereferencable(iterator);
+             iterator = LSQ_GetElementByIndex(handle, ++key))
+            LSQ_DestroyIterator(iterator);
+        LSQ_DestroyIterator(iterator);
+        LSQ_InsertElement(handle, key, i);
+    }
+    double elapsed = getTime() - start;
+    LSQ_DestroySequence(handle);
+    return elapsed * 1e9 / operations;
+}
+ 
+void buildTree(const LSQ_IntegerIndexT *priorities, const LSQ_BaseTypeT *values, LSQ_IntegerIndexT size) {
+    double start = getTime();
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        LSQ_InsertElement(handle, priorities[i], values[i]);
+    double insertTime = getTime() - start;
+    start = getTime();
+    while (LSQ_GetSize(handle) > 0)
+        LSQ_DeleteFrontElement(handle);
+    printf("Tree    n=%d: LSQ_InsertElement %6.1f ms, drain %6.1f ms\n", size, insertTime * 1e3,
+           (getTime() - start) * 1e3);
+    LSQ_DestroySequence(handle);
+}
@@ -0,0 +1,14 @@
+#ifndef BENCH_TREE_H_INCLUDED
+#define BENCH_TREE_H_INCLUDED
+ 
+/* Замеры дерева для сравнения с очередью. Они вынесены в bench_tree.c, потому что linear_sequence.h *
+ * и ../Tree/linear_sequence_assoc.h объявляют одни и те же имена с разными типами, и одна единица   *
+ * трансляции не может подключить оба. Подключается после заголовка контейнера.                     */
+ 
+/* Удержание очереди на дереве: size элементов, operations пар извлечения минимума и вставки. *
+ * Возвращает наносекунды на пару, значения извлеченных элементов добавляет к checksum        */
+extern double holdTree(LSQ_IntegerIndexT size, LSQ_IntegerIndexT operations, long long *checksum);
+/* Построение дерева поэлементной вставкой и его опустошение с начала, с печатью времени */
+extern void buildTree(const LSQ_IntegerIndexT *priorities, const LSQ_BaseTypeT *values, LSQ_IntegerIndexT size);
+ 
+#endif
@@ -0,0 +1,24 @@
+#ifndef BENCH_UTIL_H_INCLUDED
+#define BENCH_UTIL_H_INCLUDED
+ 
+#include <time.h>
+ 
+/* Генератор и часы замеров, общие для bench.c и bench_tree.c. У каждой единицы трансляции свое *
+ * состояние генератора; замер задает его перед началом, так что обе части видят одну и ту же    *
+ * последовательность.                                                                           */
+static unsigned long long seed = 88172645463325252ULL;
+ 
+static inline unsigned int nextRandom(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int) (seed >> 32);
+}
+ 
+static inline double getTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+ 
+#endif
@@ -1,25 +1,27 @@
+#define _GNU_SOURCE
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "linear_sequence.h"
-   
-#define PERCENT_LOW_LINE 0.5
-#define GROWTH_FACTOR 2
+#include "array_struct.h"
   
   
-typedef struct {
-    LSQ_BaseTypeT *value;
-    LSQ_IntegerIndexT realSize;
-    LSQ_IntegerIndexT logicalSize;
-} ArrayStruct;
-  
 typedef struct {
     LSQ_IntegerIndexT index;
     ArrayStruct *array;
 } Iterator;
   
-static void setSize(ArrayStruct *array, LSQ_IntegerIndexT size) {
-    array->realSize = size;
-    array->value = (LSQ_BaseTypeT *) realloc(array->value, size * sizeof(LSQ_BaseTypeT));
-}
+LIVE_CONTAINERS(ArrayStruct)
+  
+static size_t arrayFileBytes(LSQ_IntegerIndexT );
+static int checkArrayFileHeader(ArrayFileHeader *);
+static int mapArrayFile(ArrayStruct *, ArrayFile *);
+static void closeArrayFile(ArrayStruct *);
   
 extern LSQ_HandleT LSQ_CreateSequence(void) { //
     ArrayStruct *newArray = (ArrayStruct *) malloc(sizeof(ArrayStruct));
@@ -28,6 +30,14 @@ extern LSQ_HandleT LSQ_CreateSequence(void) { //
     newArray->value = (LSQ_BaseTypeT *) malloc(2 * sizeof(LSQ_BaseTypeT));
     newArray->realSize = 2;
     newArray->logicalSize = 0;
+    newArray->file = LSQ_HandleInvalid;
+#ifdef LSQ_STATS
+    newArray->stats = (LSQ_StatsT) {0, 0};
+#endif
+#ifdef LSQ_LATENCY
+    newArray->latency = LSQ_HandleInvalid;
+#endif
+    registerContainer(newArray);
     return  newArray;
 }
   
@@ -35,11 +45,124 @@ extern void LSQ_DestroySequence(LSQ_HandleT handle) { ///
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
         return;
-    free(tmpArray->value);
+    LATENCY(tmpArray, LATENCY_DESTROY_SEQUENCE);
+    unregisterContainer(tmpArray);
+    if (tmpArray->file != LSQ_HandleInvalid)
+        closeArrayFile(tmpArray);
+    else
+        free(tmpArray->value);
     free(tmpArray);
     return;
 }
   
+extern LSQ_HandleT LSQ_OpenSequence(const char *path) {
+    if (path == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    ArrayStruct *newArray = (ArrayStruct *) malloc(sizeof(ArrayStruct));
+    ArrayFile *file = (ArrayFile *) malloc(sizeof(ArrayFile));
+    if (newArray == LSQ_HandleInvalid || file == LSQ_HandleInvalid) {
+        free(newArray);
+        free(file);
+        return LSQ_HandleInvalid;
+    }
+    file->descriptor = open(path, O_RDWR | O_CREAT, 0644);
+    if (file->descriptor < 0 || !mapArrayFile(newArray, file)) {
+        if (file->descriptor >= 0)
+            close(file->descriptor);
+        free(file);
+        free(newArray);
+        return LSQ_HandleInvalid;
+    }
+#ifdef LSQ_STATS
+    newArray->stats = (LSQ_StatsT) {0, 0};
+#endif
+#ifdef LSQ_LATENCY
+    newArray->latency = LSQ_HandleInvalid;
+#endif
+    registerContainer(newArray);
+    return newArray;
+}
+  
+extern void LSQ_AdviseAccess(LSQ_HandleT handle, LSQ_AccessPatternT pattern) {
+    ArrayStruct *tmpArray = (ArrayStruct *) handle;
+    if (tmpArray == LSQ_HandleInvalid || tmpArray->file == LSQ_HandleInvalid)
+        return;
+    ArrayFile *file = tmpArray->file;
+    switch (pattern) {
+        case LSQ_ACCESS_SEQUENTIAL:
+            file->advice = MADV_SEQUENTIAL;
+            break;
+        case LSQ_ACCESS_RANDOM:
+            file->advice = MADV_RANDOM;
+            break;
+        default:
+            file->advice = MADV_NORMAL;
+    }
+    madvise(file->header, file->mappedBytes, file->advice);
+}
+  
+/* Файл пишется под временным именем и переименовывается: path может быть открыт LSQ_OpenSequence, *
+ * и усечение файла на месте сломало бы отображение                                                */
+extern int LSQ_Save(LSQ_HandleT handle, const char *path) {
+    ArrayStruct *tmpArray = (ArrayStruct *) handle;
+    if (tmpArray == LSQ_HandleInvalid || path == LSQ_HandleInvalid)
+        return 0;
+    size_t length = strlen(path);
+    char *temporary = (char *) malloc(length + sizeof(".tmp"));
+    if (temporary == LSQ_HandleInvalid)
+        return 0;
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+    FILE *stream = fopen(temporary, "wb");
+    if (stream == LSQ_HandleInvalid) {
+        free(temporary);
+        return 0;
+    }
+    ArrayFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE);
+    header.version = ARRAY_FILE_VERSION;
+    header.size = tmpArray->logicalSize;
+    int written = fwrite(&header, sizeof(header), 1, stream) == 1
+                  && fwrite(tmpArray->value, sizeof(LSQ_BaseTypeT), header.size, stream) == (size_t) header.size;
+    int saved = (fclose(stream) == 0) && written && rename(temporary, path) == 0;
+    if (!saved)
+        remove(temporary);
+    free(temporary);
+    return saved;
+}
+  
+extern LSQ_HandleT LSQ_Load(const char *path) {
+    if (path == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    FILE *stream = fopen(path, "rb");
+    if (stream == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    ArrayFileHeader header;
+    ArrayStruct *newArray = LSQ_HandleInvalid;
+    if (fread(&header, sizeof(header), 1, stream) == 1 && checkArrayFileHeader(&header))
+        newArray = (ArrayStruct *) LSQ_CreateSequence();
+    if (newArray != LSQ_HandleInvalid) {
+        if ((header.size > newArray->realSize && !setSize(newArray, header.size))
+            || fread(newArray->value, sizeof(LSQ_BaseTypeT), header.size, stream) != (size_t) header.size) {
+            LSQ_DestroySequence(newArray);
+            newArray = LSQ_HandleInvalid;
+        } else {
+            newArray->logicalSize = header.size;
+        }
+    }
+    fclose(stream);
+    return newArray;
+}
+  
+/* Массив освобождается двумя вызовами free, так что передавать его фоновому потоку незачем */
+extern void LSQ_DestroySequenceAsync(LSQ_HandleT handle) {
+    LSQ_DestroySequence(handle);
+}
+  
+extern void LSQ_WaitForAsyncDestroy(void) {
+}
+  
 extern LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle) { //
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
@@ -75,6 +198,7 @@ extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpArray, LATENCY_GET_ELEMENT_BY_INDEX);
     Iterator *tmpIterator = (Iterator *) malloc(sizeof(Iterator));
     tmpIterator->array = tmpArray;
     tmpIterator->index = index;
@@ -85,6 +209,7 @@ extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpArray, LATENCY_GET_FRONT_ELEMENT);
     Iterator *tmpIterator = (Iterator *) malloc(sizeof(Iterator));
     tmpIterator->array = tmpArray;
     tmpIterator->index = 0;
@@ -95,6 +220,7 @@ extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpArray, LATENCY_GET_PAST_REAR_ELEMENT);
     Iterator *tmpIterator = (Iterator *) malloc(sizeof(Iterator));
     if (tmpIterator == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
@@ -112,6 +238,7 @@ extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (tmpIterator == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->array, LATENCY_ADVANCE_ONE_ELEMENT);
     tmpIterator->index++;
 }
   
@@ -119,6 +246,7 @@ extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (tmpIterator == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->array, LATENCY_REWIND_ONE_ELEMENT);
     tmpIterator->index--;
 }
   
@@ -126,6 +254,7 @@ extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (tmpIterator == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->array, LATENCY_SHIFT_POSITION);
     tmpIterator->index += shift;
 }
   
@@ -133,18 +262,66 @@ extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (tmpIterator == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->array, LATENCY_SET_POSITION);
     tmpIterator->index = pos;
 }
   
+extern void LSQ_ForEach(LSQ_HandleT handle, LSQ_VisitorT visitor, void *context) {
+    ArrayStruct *tmpArray = (ArrayStruct *)handle;
+    if (tmpArray == LSQ_HandleInvalid)
+        return;
+    LSQ_ForEachRange(handle, 0, tmpArray->logicalSize, visitor, context);
+}
+  
+extern void LSQ_ForEachRange(LSQ_HandleT handle, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last,
+                             LSQ_VisitorT visitor, void *context) {
+    ArrayStruct *tmpArray = (ArrayStruct *)handle;
+    if (tmpArray == LSQ_HandleInvalid || visitor == LSQ_HandleInvalid)
+        return;
+    if (first < 0)
+        first = 0;
+    if (last > tmpArray->logicalSize)
+        last = tmpArray->logicalSize;
+    LSQ_BaseTypeT *end = tmpArray->value + last;
+    for (LSQ_BaseTypeT *value = tmpArray->value + first; value < end; value++, first++)
+        if (visitor(first, value, context))
+            return;
+}
+  
+extern LSQ_IntegerIndexT LSQ_ReadBlock(LSQ_IteratorT iterator, LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count) {
+    Iterator *tmpIterator = (Iterator *)iterator;
+    if (buffer == LSQ_HandleInvalid || count <= 0 || !LSQ_IsIteratorDereferencable(iterator))
+        return 0;
+    if (count > tmpIterator->array->logicalSize - tmpIterator->index)
+        count = tmpIterator->array->logicalSize - tmpIterator->index;
+    memcpy(buffer, tmpIterator->array->value + tmpIterator->index, count * sizeof(LSQ_BaseTypeT));
+    tmpIterator->index += count;
+    return count;
+}
+  
+extern LSQ_IntegerIndexT LSQ_WriteBlock(LSQ_IteratorT iterator, const LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count) {
+    Iterator *tmpIterator = (Iterator *)iterator;
+    if (buffer == LSQ_HandleInvalid || count <= 0 || !LSQ_IsIteratorDereferencable(iterator))
+        return 0;
+    if (count > tmpIterator->array->logicalSize - tmpIterator->index)
+        count = tmpIterator->array->logicalSize - tmpIterator->index;
+    memcpy(tmpIterator->array->value + tmpIterator->index, buffer, count * sizeof(LSQ_BaseTypeT));
+    tmpIterator->index += count;
+    return count;
+}
+  
 extern void LSQ_InsertFrontElement(LSQ_HandleT handle, LSQ_BaseTypeT element) {
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpArray, LATENCY_INSERT_FRONT_ELEMENT);
     if (tmpArray->logicalSize == tmpArray->realSize) {
         LSQ_IntegerIndexT size = tmpArray->realSize * GROWTH_FACTOR;
-        setSize(tmpArray, size);
+        if (!setSize(tmpArray, size))
+            return;
     }
  
+    STATS_ADD(tmpArray, bytesMoved, tmpArray->logicalSize * sizeof(LSQ_BaseTypeT));
     for (LSQ_IntegerIndexT i = tmpArray->logicalSize; i > 0; i--) {
         tmpArray->value[i] = tmpArray->value[i - 1];
     }
@@ -156,9 +333,11 @@ extern void LSQ_InsertRearElement(LSQ_HandleT handle, LSQ_BaseTypeT element) {
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpArray, LATENCY_INSERT_REAR_ELEMENT);
     if (tmpArray->logicalSize == tmpArray->realSize) {
         LSQ_IntegerIndexT size = tmpArray->realSize * GROWTH_FACTOR;
-        setSize(tmpArray, size);
+        if (!setSize(tmpArray, size))
+            return;
     }
     tmpArray->value[tmpArray->logicalSize] = element;
     tmpArray->logicalSize++;
@@ -168,12 +347,15 @@ extern void LSQ_InsertElementBeforeGiven(LSQ_IteratorT iterator, LSQ_BaseTypeT n
     Iterator *tmpIterator = (Iterator *)iterator;
     if (tmpIterator == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->array, LATENCY_INSERT_ELEMENT_BEFORE_GIVEN);
   
     if (tmpIterator->array->logicalSize == tmpIterator->array->realSize) {
         LSQ_IntegerIndexT size = tmpIterator->array->realSize * GROWTH_FACTOR;
-        setSize(tmpIterator->array, size);
+        if (!setSize(tmpIterator->array, size))
+            return;
     }
   
+    STATS_ADD(tmpIterator->array, bytesMoved, (tmpIterator->array->logicalSize - tmpIterator->index) * sizeof(LSQ_BaseTypeT));
     for (LSQ_IntegerIndexT i = tmpIterator->array->logicalSize; i > tmpIterator->index; i--) {
         tmpIterator->array->value[i] = tmpIterator->array->value[i - 1];
     }
@@ -185,8 +367,10 @@ extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid || tmpArray->logicalSize == 0)
         return;
+    LATENCY(tmpArray, LATENCY_DELETE_FRONT_ELEMENT);
  
     tmpArray->logicalSize--;
+    STATS_ADD(tmpArray, bytesMoved, tmpArray->logicalSize * sizeof(LSQ_BaseTypeT));
     for (LSQ_IntegerIndexT i = 0; i < tmpArray->logicalSize; i++) {
         tmpArray->value[i] = tmpArray->value[i + 1];
     }
@@ -202,6 +386,7 @@ extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
     ArrayStruct *tmpArray = (ArrayStruct *) handle;
     if (tmpArray == LSQ_HandleInvalid || tmpArray->logicalSize == 0)
         return;
+    LATENCY(tmpArray, LATENCY_DELETE_REAR_ELEMENT);
  
     tmpArray->logicalSize--;
     if (tmpArray->logicalSize < tmpArray->realSize * PERCENT_LOW_LINE) {
@@ -216,8 +401,10 @@ extern void LSQ_DeleteGivenElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (!LSQ_IsIteratorDereferencable(iterator))
         return;
+    LATENCY(tmpIterator->array, LATENCY_DELETE_GIVEN_ELEMENT);
   
     tmpIterator->array->logicalSize--;
+    STATS_ADD(tmpIterator->array, bytesMoved, (tmpIterator->array->logicalSize - tmpIterator->index) * sizeof(LSQ_BaseTypeT));
     for (LSQ_IntegerIndexT i = tmpIterator->index; i < tmpIterator->array->logicalSize; i++) {
         tmpIterator->array->value[i] = tmpIterator->array->value[i + 1];
     }
@@ -227,4 +414,140 @@ extern void LSQ_DeleteGivenElement(LSQ_IteratorT iterator) {
             tmpIterator->array->realSize = 5;
         setSize(tmpIterator->array, size);
     }
+}
+  
+extern void LSQ_GetStats(LSQ_HandleT handle, LSQ_StatsT *stats) {
+    if (stats == LSQ_HandleInvalid)
+        return;
+#ifdef LSQ_STATS
+    ArrayStruct *tmpArray = (ArrayStruct *) handle;
+    if (tmpArray != LSQ_HandleInvalid) {
+        *stats = tmpArray->stats;
+        return;
+    }
+#else
+    (void) handle;
+#endif
+    *stats = (LSQ_StatsT) {0, 0};
+}
+  
+extern void LSQ_SetLatencyProfile(LSQ_HandleT handle, struct LatencyProfile_ *profile) {
+#ifdef LSQ_LATENCY
+    ArrayStruct *tmpArray = (ArrayStruct *) handle;
+    if (tmpArray != LSQ_HandleInvalid)
+        tmpArray->latency = profile;
+#else
+    (void) handle;
+    (void) profile;
+#endif
+}
+  
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    ArrayStruct *tmpArray = (ArrayStruct *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpArray == LSQ_HandleInvalid)
+        return;
+    usage->payload = tmpArray->logicalSize * sizeof(LSQ_BaseTypeT);
+    usage->overhead = sizeof(ArrayStruct);
+    if (tmpArray->file != LSQ_HandleInvalid)
+        usage->overhead += sizeof(ArrayFile) + sizeof(ArrayFileHeader);
+    if (tmpArray->realSize > tmpArray->logicalSize)
+        usage->slack = (tmpArray->realSize - tmpArray->logicalSize) * sizeof(LSQ_BaseTypeT);
+}
+  
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (ArrayStruct *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+  
+int resizeMapping(ArrayStruct *array, LSQ_IntegerIndexT size) {
+    ArrayFile *file = array->file;
+    size_t bytes = arrayFileBytes(size);
+    if (ftruncate(file->descriptor, (off_t) bytes) != 0)
+        return 0;
+    void *mapping = mremap(file->header, file->mappedBytes, bytes, MREMAP_MAYMOVE);
+    if (mapping == MAP_FAILED) {
+        ftruncate(file->descriptor, (off_t) file->mappedBytes);
+        return 0;
+    }
+    file->header = (ArrayFileHeader *) mapping;
+    file->mappedBytes = bytes;
+    if (file->advice != MADV_NORMAL)
+        madvise(mapping, bytes, file->advice);
+    array->value = (LSQ_BaseTypeT *) (file->header + 1);
+    array->realSize = size;
+    return 1;
+}
+  
+static size_t arrayFileBytes(LSQ_IntegerIndexT size) {
+    return sizeof(ArrayFileHeader) + (size_t) size * sizeof(LSQ_BaseTypeT);
+}
+  
+static int checkArrayFileHeader(ArrayFileHeader *header) {
+    return memcmp(header->magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE) == 0 && header->version == ARRAY_FILE_VERSION
+           && header->size >= 0;
+}
+  
+/* Пустой файл получает заголовок и емкость в два элемента; у существующего проверяются заголовок и длина. *
+ * Элементы не копируются: value указывает прямо в отображение.                                           */
+static int mapArrayFile(ArrayStruct *array, ArrayFile *file) {
+    struct stat status;
+    if (fstat(file->descriptor, &status) != 0)
+        return 0;
+    size_t bytes = (size_t) status.st_size;
+    int created = (bytes == 0);
+    if (created) {
+        bytes = arrayFileBytes(2);
+        if (ftruncate(file->descriptor, (off_t) bytes) != 0)
+            return 0;
+    }
+    if (bytes < sizeof(ArrayFileHeader) || (bytes - sizeof(ArrayFileHeader)) % sizeof(LSQ_BaseTypeT) != 0 ||
+        (bytes - sizeof(ArrayFileHeader)) / sizeof(LSQ_BaseTypeT) > INT_MAX)
+        return 0;
+    void *mapping = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, file->descriptor, 0);
+    if (mapping == MAP_FAILED)
+        return 0;
+    file->header = (ArrayFileHeader *) mapping;
+    file->mappedBytes = bytes;
+    file->advice = MADV_NORMAL;
+    if (created) {
+        memcpy(file->header->magic, ARRAY_FILE_MAGIC, ARRAY_FILE_MAGIC_SIZE);
+        file->header->version = ARRAY_FILE_VERSION;
+        file->header->size = 0;
+    }
+    LSQ_IntegerIndexT capacity = (LSQ_IntegerIndexT) ((bytes - sizeof(ArrayFileHeader)) / sizeof(LSQ_BaseTypeT));
+    if (!checkArrayFileHeader(file->header) || file->header->size > capacity) {
+        munmap(mapping, bytes);
+        return 0;
+    }
+    array->file = file;
+    array->value = (LSQ_BaseTypeT *) (file->header + 1);
+    array->realSize = capacity;
+    array->logicalSize = file->header->size;
+    if (array->realSize < 2 && !resizeMapping(array, 2)) {
+        munmap(file->header, file->mappedBytes);
+        return 0;
+    }
+    return 1;
+}
+  
+static void closeArrayFile(ArrayStruct *array) {
+    ArrayFile *file = array->file;
+    file->header->size = array->logicalSize;
+    munmap(file->header, file->mappedBytes);
+    ftruncate(file->descriptor, (off_t) arrayFileBytes(array->logicalSize));
+    close(file->descriptor);
+    free(file);
 }
\ No newline at end of file
@@ -22,6 +22,33 @@ typedef int LSQ_IntegerIndexT;
 extern LSQ_HandleT LSQ_CreateSequence(void);
 /* Функция, уничтожающая контейнер с заданным дескриптором. Освобождает принадлежащую ему память */
 extern void LSQ_DestroySequence(LSQ_HandleT handle);
+/* Функция, уничтожающая контейнер с заданным дескриптором за O(1): дескриптор сразу становится недействительным, *
+ * а память крупного контейнера освобождает фоновый поток                                                       */
+extern void LSQ_DestroySequenceAsync(LSQ_HandleT handle);
+/* Функция, ожидающая, пока фоновый поток освободит все контейнеры, переданные LSQ_DestroySequenceAsync */
+extern void LSQ_WaitForAsyncDestroy(void);
+/* Функция, открывающая контейнер, элементы которого хранятся в файле path и отображены в память.         *
+ * Несуществующий или пустой файл создается. Элементы не копируются, емкость растет вместе с файлом.    *
+ * LSQ_DestroySequence сохраняет размер и закрывает файл. Возвращает LSQ_HandleInvalid, если файл       *
+ * не удалось открыть или он не является файлом массива                                                 */
+extern LSQ_HandleT LSQ_OpenSequence(const char *path);
+ 
+/* Характер доступа к элементам для LSQ_AdviseAccess */
+typedef enum {
+    LSQ_ACCESS_NORMAL,
+    LSQ_ACCESS_SEQUENTIAL,
+    LSQ_ACCESS_RANDOM
+} LSQ_AccessPatternT;
+/* Функция, сообщающая ядру характер доступа к файлу контейнера, открытого LSQ_OpenSequence. Последовательный *
+ * доступ включает упреждающее чтение, случайный - отключает его. Для контейнера в памяти ничего не делает   */
+extern void LSQ_AdviseAccess(LSQ_HandleT handle, LSQ_AccessPatternT pattern);
+ 
+/* Функция, записывающая контейнер в файл path в двоичном формате с номером версии. Возвращает 0 при ошибке. *
+ * Это формат файла LSQ_OpenSequence, так что сохраненный массив можно открыть и без чтения                */
+extern int LSQ_Save(LSQ_HandleT handle, const char *path);
+/* Функция, создающая контейнер из файла, записанного LSQ_Save. Возвращает LSQ_HandleInvalid, *
+ * если файл не удалось прочитать или его формат либо версия не подходят                     */
+extern LSQ_HandleT LSQ_Load(const char *path);
  
 /* Функция, возвращающая текущее количество элементов в контейнере */
 extern LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle);
@@ -56,6 +83,24 @@ extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift);
 /* Функция, устанавливающая итератор на элемент с указанным номером */
 extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos);
  
+/* Функция обратного вызова для обхода: получает номер элемента, указатель на его значение и context.     *
+ * Ненулевой результат прекращает обход. Менять состав контейнера из нее нельзя.                          */
+typedef int (*LSQ_VisitorT)(LSQ_IntegerIndexT index, LSQ_BaseTypeT *value, void *context);
+/* Функция, вызывающая visitor для всех элементов контейнера по порядку. В отличие от прохода итератором, *
+ * обход идет внутри контейнера и не тратит вызов и проверки на каждый шаг.                              */
+extern void LSQ_ForEach(LSQ_HandleT handle, LSQ_VisitorT visitor, void *context);
+/* Функция, вызывающая visitor для элементов с номерами из [first, last) */
+extern void LSQ_ForEachRange(LSQ_HandleT handle, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last,
+                             LSQ_VisitorT visitor, void *context);
+ 
+/* Функция, копирующая в buffer до count элементов, начиная с указываемого итератором, и передвигающая   *
+ * итератор за последний скопированный. Возвращает число скопированных элементов, меньшее count, если    *
+ * контейнер кончился раньше, и 0, если итератор не указывает на элемент.                                */
+extern LSQ_IntegerIndexT LSQ_ReadBlock(LSQ_IteratorT iterator, LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count);
+/* Функция, записывающая до count элементов из buffer поверх элементов, начиная с указываемого итератором, *
+ * по тем же правилам. Размер контейнера не меняется.                                                    */
+extern LSQ_IntegerIndexT LSQ_WriteBlock(LSQ_IteratorT iterator, const LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count);
+ 
 /* Функция, добавляющая элемент в начало контейнера */
 extern void LSQ_InsertFrontElement(LSQ_HandleT handle, LSQ_BaseTypeT element);
 /* Функция, добавляющая элемент в конец контейнера */
@@ -74,4 +119,33 @@ extern void LSQ_DeleteRearElement(LSQ_HandleT handle);
 /* Заданный итератор продолжает указывать на элемент последовательности с тем же индексом. */
 extern void LSQ_DeleteGivenElement(LSQ_IteratorT iterator);
  
+/* Счетчики операций контейнера: reallocCalls - перевыделения буфера при росте и сжатии, bytesMoved - байты, *
+ * перемещенные сдвигом элементов при вставке и удалении не в конце.                                        */
+typedef struct {
+    unsigned long long reallocCalls;
+    unsigned long long bytesMoved;
+} LSQ_StatsT;
+/* Функция, записывающая счетчики контейнера в stats. Счетчики ведутся, только если библиотека собрана  *
+ * с LSQ_STATS, иначе все они равны нулю, а операции контейнера не тратят на них ни одной инструкции.   */
+extern void LSQ_GetStats(LSQ_HandleT handle, LSQ_StatsT *stats);
+ 
+/* Функция, назначающая контейнеру профиль задержек (NULL - снимает его). Профиль создается и печатается   *
+ * функциями Instrumentation/latency.h и должен жить, пока назначен. Замеры ведутся, только если            *
+ * библиотека собрана с LSQ_LATENCY, иначе функция ничего не делает.                                       */
+struct LatencyProfile_;
+extern void LSQ_SetLatencyProfile(LSQ_HandleT handle, struct LatencyProfile_ *profile);
+ 
+/* Память контейнера в байтах без учета заголовков malloc: payload - значения элементов, *
+ * overhead - служебные поля и структуры, slack - выделенная, но не занятая емкость.     *
+ * slack - свободная часть буфера: после роста вдвое она достигает половины.             */
+typedef struct {
+    size_t payload;
+    size_t overhead;
+    size_t slack;
+} LSQ_MemoryUsageT;
+/* Функция, записывающая в usage память, занимаемую контейнером */
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage);
+/* Функция, записывающая в usage суммарную память всех существующих контейнеров процесса */
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage);
+ 
 #endif
\ No newline at end of file
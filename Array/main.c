@@ -1,7 +1,14 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <stdarg.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
 #include "linear_sequence.h"
+#include "priority_queue.h"
+#ifdef LSQ_LATENCY
+#include "../Instrumentation/latency.h"
+#endif
 
 
 #define TEST { test_line = __LINE__; test_init(); } {
@@ -95,6 +102,22 @@ void dump(LSQ_HandleT seq)
     LSQ_DestroyIterator(it);
 }
 
+/* Запоминает номера и значения посещенных элементов, увеличивает значения на 1 и останавливает обход после limit */
+typedef struct {
+    int indices[16];
+    int values[16];
+    int count;
+    int limit;
+} Visited;
+
+int visit(LSQ_IntegerIndexT index, LSQ_BaseTypeT *value, void *context)
+{
+    Visited *visited = (Visited *) context;
+    visited->indices[visited->count] = index;
+    visited->values[visited->count] = (*value)++;
+    return ++visited->count == visited->limit;
+}
+
 int main()
 {
     int i, count;
@@ -355,6 +378,282 @@ int main()
         test_assert(ITER_VAL(iter) == 9);
     ENDTEST
     
+    TEST
+        PQ_HandleT queue = PQ_CreateQueue(2);
+        PQ_ElementT elements[5];
+        LSQ_IntegerIndexT priority;
+        LSQ_BaseTypeT value;
+        test_assert(!PQ_PopMin(queue, &priority, &value));
+        elements[0] = PQ_Push(queue, 50, 5);
+        elements[1] = PQ_Push(queue, 30, 3);
+        elements[2] = PQ_Push(queue, 40, 4);
+        elements[3] = PQ_Push(queue, 10, 1);
+        elements[4] = PQ_Push(queue, 20, 2);
+        test_assert(PQ_GetSize(queue) == 5);
+        test_assert(PQ_Peek(queue, &priority, &value) && priority == 10 && value == 1);
+
+        PQ_DecreaseKey(queue, elements[0], 5);
+        PQ_DecreaseKey(queue, elements[2], 45);
+        test_assert(PQ_PopMin(queue, &priority, &value) && priority == 5 && value == 5);
+        for (i = 1; i <= 4; i++)
+            test_assert(PQ_PopMin(queue, &priority, &value) && priority == 10 * i && value == i);
+        test_assert(PQ_GetSize(queue) == 0);
+        PQ_DestroyQueue(queue);
+    ENDTEST
+
+    TEST
+        PQ_HandleT queue = PQ_CreateQueue(4);
+        LSQ_IntegerIndexT priorities[100];
+        LSQ_BaseTypeT values[100];
+        PQ_ElementT elements[100];
+        LSQ_IntegerIndexT priority, previous = -1;
+        for (i = 0; i < 100; i++) {
+            priorities[i] = (i * 37) % 100;
+            values[i] = i;
+        }
+        PQ_Heapify(queue, priorities, values, 100, elements);
+        PQ_Push(queue, 1000, -1);
+        PQ_DecreaseKey(queue, elements[99], -5);
+        test_assert(PQ_PopMin(queue, &priority, NULL) && priority == -5);
+        for (count = 0; PQ_PopMin(queue, &priority, NULL); count++) {
+            test_assert(priority >= previous);
+            previous = priority;
+        }
+        test_assert(count == 100 && previous == 1000);
+        PQ_DestroyQueue(queue);
+    ENDTEST
+    
+    TEST
+        LSQ_StatsT stats;
+        for (i = 0; i < 10; i++)
+            LSQ_InsertRearElement(seq, i);
+        LSQ_InsertFrontElement(seq, -1);
+        LSQ_GetStats(seq, &stats);
+#ifdef LSQ_STATS
+        test_assert(stats.reallocCalls == 3 && stats.bytesMoved == 10 * sizeof(LSQ_BaseTypeT));
+#else
+        test_assert(stats.reallocCalls == 0 && stats.bytesMoved == 0);
+#endif
+    ENDTEST
+    
+    TEST
+#ifdef LSQ_LATENCY
+        LatencyProfile *profile = latencyCreateProfile();
+        LatencyHistogram histogram = {{0}, 0, 0};
+        LSQ_HandleT other = LSQ_CreateSequence();
+        LSQ_SetLatencyProfile(seq, profile);
+        LSQ_SetLatencyProfile(other, profile);
+        for (i = 0; i < 10; i++)
+            LSQ_InsertRearElement(seq, i);
+        LSQ_InsertFrontElement(seq, -1);
+        LSQ_InsertFrontElement(other, -1);
+        LSQ_DestroySequence(other);
+        LSQ_SetLatencyProfile(seq, LSQ_HandleInvalid);
+        LSQ_InsertRearElement(seq, 10);
+        test_assert(profile->histograms[LATENCY_INSERT_REAR_ELEMENT].count == 10);
+        test_assert(profile->histograms[LATENCY_INSERT_FRONT_ELEMENT].count == 2);
+        test_assert(profile->histograms[LATENCY_DESTROY_SEQUENCE].count == 1 && profile->nesting == 0);
+        test_assert(latencyPercentile(&profile->histograms[LATENCY_INSERT_REAR_ELEMENT], 0.5)
+                    <= profile->histograms[LATENCY_INSERT_REAR_ELEMENT].max);
+        for (i = 1; i <= 1000; i++)
+            latencyRecord(&histogram, i);
+        test_assert(latencyPercentile(&histogram, 0.5) >= 500 && latencyPercentile(&histogram, 0.5) < 500 + 500 / 16);
+        test_assert(latencyPercentile(&histogram, 0.999) >= 999 && latencyPercentile(&histogram, 1) == 1000);
+        latencyDestroyProfile(profile);
+#else
+        LSQ_SetLatencyProfile(seq, LSQ_HandleInvalid);
+        LSQ_InsertRearElement(seq, 1);
+        test_assert(LSQ_GetSize(seq) == 1);
+#endif
+    ENDTEST
+    
+    TEST
+        Visited visited = {{0}, {0}, 0, 16};
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 0);
+        seq_push(seq, 5, 10, 20, 30, 40, 50);
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 5 && visited.indices[4] == 4 && visited.values[4] == 50);
+        test_assert_seq(seq, 5, 11, 21, 31, 41, 51);
+        visited.count = 0;
+        visited.limit = 2;
+        LSQ_ForEachRange(seq, 1, 10, visit, &visited);
+        test_assert(visited.count == 2 && visited.indices[0] == 1 && visited.values[1] == 31);
+        visited.count = 0;
+        visited.limit = 16;
+        LSQ_ForEachRange(seq, 3, 3, visit, &visited);
+        test_assert(visited.count == 0);
+        LSQ_ForEachRange(seq, -2, 2, visit, &visited);
+        test_assert(visited.count == 2 && visited.indices[1] == 1);
+        LSQ_ForEachRange(seq, 4, 100, visit, &visited);
+        test_assert(visited.count == 3 && visited.indices[2] == 4 && visited.values[2] == 51);
+        test_assert_seq(seq, 5, 12, 23, 32, 41, 52);
+    ENDTEST
+    
+    TEST
+        LSQ_BaseTypeT block[8] = {0};
+        LSQ_BaseTypeT values[3] = {-1, -2, -3};
+        seq_push(seq, 10, 0,1,2,3,4,5,6,7,8,9);
+        iter = LSQ_GetElementByIndex(seq, 2);
+        test_assert(LSQ_ReadBlock(iter, block, 5) == 5);
+        test_assert(block[0] == 2 && block[4] == 6 && ITER_VAL(iter) == 7);
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 3 && block[2] == 9 && LSQ_IsIteratorPastRear(iter));
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 0 && LSQ_WriteBlock(iter, values, 3) == 0);
+        LSQ_SetPosition(iter, 8);
+        test_assert(LSQ_WriteBlock(iter, values, 3) == 2 && LSQ_IsIteratorPastRear(iter));
+        LSQ_SetPosition(iter, 0);
+        test_assert(LSQ_WriteBlock(iter, values, 1) == 1 && ITER_VAL(iter) == 1);
+        test_assert(LSQ_GetSize(seq) == 10);
+        test_assert_seq(seq, 10, -1,1,2,3,4,5,6,7,-1,-2);
+        LSQ_DestroyIterator(iter);
+    ENDTEST
+    
+    TEST
+        LSQ_MemoryUsageT usage, total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 100; i++)
+            LSQ_InsertRearElement(other, i);
+        LSQ_GetMemoryUsage(other, &usage);
+        test_assert(usage.payload == 100 * sizeof(LSQ_BaseTypeT));
+        test_assert(usage.slack == 28 * sizeof(LSQ_BaseTypeT) && usage.overhead > 0);
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequence(other);
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == usage.payload && total.overhead - reduced.overhead == usage.overhead);
+        test_assert(total.slack - reduced.slack == usage.slack);
+    ENDTEST
+    
+    TEST
+        LSQ_MemoryUsageT total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 100; i++)
+            LSQ_InsertRearElement(other, i);
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequenceAsync(other);
+        LSQ_DestroySequenceAsync(LSQ_HandleInvalid);
+        LSQ_WaitForAsyncDestroy();
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == 100 * sizeof(LSQ_BaseTypeT));
+    ENDTEST
+    
+    TEST
+        char path[] = "/tmp/lsq_arrayXXXXXX";
+        int descriptor = mkstemp(path);
+        test_assert(descriptor >= 0);
+        close(descriptor);
+        LSQ_HandleT other = LSQ_OpenSequence(path);
+        test_assert(other != LSQ_HandleInvalid && LSQ_GetSize(other) == 0);
+        LSQ_AdviseAccess(other, LSQ_ACCESS_SEQUENTIAL);
+        for(i = 0; i < 10000; i++)
+            LSQ_InsertRearElement(other, i);
+        LSQ_InsertFrontElement(other, -1);
+        LSQ_DeleteRearElement(other);
+        LSQ_MemoryUsageT usage;
+        LSQ_GetMemoryUsage(other, &usage);
+        test_assert(usage.payload == 10000 * sizeof(LSQ_BaseTypeT) && usage.slack == 6384 * sizeof(LSQ_BaseTypeT));
+        LSQ_DestroySequence(other);
+    
+        other = LSQ_OpenSequence(path);
+        test_assert(LSQ_GetSize(other) == 10000);
+        iter = LSQ_GetElementByIndex(other, 0);
+        test_assert(ITER_VAL(iter) == -1);
+        LSQ_SetPosition(iter, 9999);
+        test_assert(ITER_VAL(iter) == 9998);
+        LSQ_DestroyIterator(iter);
+        LSQ_AdviseAccess(other, LSQ_ACCESS_RANDOM);
+        for(i = 0; i < 9998; i++)
+            LSQ_DeleteFrontElement(other);
+        test_assert_seq(other, 2, 9997, 9998);
+        LSQ_DestroySequence(other);
+        other = LSQ_OpenSequence(path);
+        test_assert_seq(other, 2, 9997, 9998);
+        LSQ_DestroySequence(other);
+    
+        FILE *stream = fopen(path, "w");
+        fputs("not an array", stream);
+        fclose(stream);
+        test_assert(LSQ_OpenSequence(path) == LSQ_HandleInvalid);
+        unlink(path);
+        test_assert(LSQ_OpenSequence("/nonexistent/lsq_array") == LSQ_HandleInvalid);
+    ENDTEST
+    
+    TEST
+        /* Файл не может вырасти больше 4096 байт: вставки сверх емкости отбрасываются */
+        char path[] = "/tmp/lsq_arrayXXXXXX";
+        int descriptor = mkstemp(path);
+        test_assert(descriptor >= 0);
+        close(descriptor);
+        struct rlimit oldLimit;
+        struct rlimit limit;
+        getrlimit(RLIMIT_FSIZE, &oldLimit);
+        limit = oldLimit;
+        limit.rlim_cur = 4096;
+        signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &limit);
+        LSQ_HandleT other = LSQ_OpenSequence(path);
+        for(i = 0; i < 5000; i++)
+            LSQ_InsertRearElement(other, i);
+        LSQ_InsertFrontElement(other, -1);
+        iter = LSQ_GetElementByIndex(other, 1);
+        LSQ_InsertElementBeforeGiven(iter, -2);
+        LSQ_DestroyIterator(iter);
+        LSQ_IntegerIndexT size = LSQ_GetSize(other);
+        test_assert(size > 0 && size < 5000);
+        iter = LSQ_GetElementByIndex(other, size - 1);
+        test_assert(ITER_VAL(iter) == size - 1);
+        LSQ_DestroyIterator(iter);
+        LSQ_DestroySequence(other);
+        setrlimit(RLIMIT_FSIZE, &oldLimit);
+        signal(SIGXFSZ, SIG_DFL);
+        other = LSQ_OpenSequence(path);
+        test_assert(LSQ_GetSize(other) == size);
+        LSQ_DestroySequence(other);
+        unlink(path);
+    ENDTEST
+    
+    TEST
+        char path[] = "/tmp/lsq_arrayXXXXXX";
+        int descriptor = mkstemp(path);
+        test_assert(descriptor >= 0);
+        close(descriptor);
+        for(i = 0; i < 1000; i++)
+            LSQ_InsertRearElement(seq, i);
+        test_assert(LSQ_Save(seq, path));
+        LSQ_HandleT other = LSQ_Load(path);
+        test_assert(LSQ_GetSize(other) == 1000);
+        iter = LSQ_GetElementByIndex(other, 999);
+        test_assert(ITER_VAL(iter) == 999);
+        LSQ_DestroyIterator(iter);
+        LSQ_InsertRearElement(other, 1000);
+        LSQ_DestroySequence(other);
+    
+        other = LSQ_OpenSequence(path);
+        test_assert(LSQ_GetSize(other) == 1000);
+        LSQ_DeleteRearElement(other);
+        test_assert(LSQ_Save(other, path));
+        LSQ_InsertRearElement(other, -1);
+        LSQ_DestroySequence(other);
+        other = LSQ_Load(path);
+        test_assert(LSQ_GetSize(other) == 999);
+        LSQ_DestroySequence(other);
+    
+        other = LSQ_CreateSequence();
+        test_assert(LSQ_Save(other, path));
+        LSQ_DestroySequence(other);
+        other = LSQ_Load(path);
+        test_assert(other != LSQ_HandleInvalid && LSQ_GetSize(other) == 0);
+        LSQ_InsertRearElement(other, 1);
+        test_assert_seq(other, 1, 1);
+        LSQ_DestroySequence(other);
+    
+        FILE *stream = fopen(path, "w");
+        fputs("not an array", stream);
+        fclose(stream);
+        test_assert(LSQ_Load(path) == LSQ_HandleInvalid);
+        unlink(path);
+        test_assert(LSQ_Load(path) == LSQ_HandleInvalid);
+    ENDTEST
+    
     printf("All tests passed!\n");
     return EXIT_SUCCESS;
 }
@@ -0,0 +1,243 @@
+#include <stdlib.h>
+#include <string.h>
+#include "priority_queue.h"
+#include "array_struct.h"
+  
+#define MIN_CAPACITY 16
+  
+/* Куча хранится в двух параллельных буферах: приоритеты и номера элементов по позициям кучи. *
+ * По номеру элемента находятся его позиция в куче (-1 - номер свободен) и значение.           */
+typedef struct {
+    ArrayStruct priorities;
+    ArrayStruct elements;
+    ArrayStruct positions;
+    ArrayStruct values;
+    ArrayStruct freeElements;
+    LSQ_IntegerIndexT arity;
+} PriorityQueue;
+  
+static int initArray(ArrayStruct *);
+static int reserve(ArrayStruct *, LSQ_IntegerIndexT );
+static PQ_ElementT allocateElement(PriorityQueue *, LSQ_BaseTypeT );
+static void siftUp(PriorityQueue *, LSQ_IntegerIndexT );
+static void siftDown(PriorityQueue *, LSQ_IntegerIndexT );
+  
+extern PQ_HandleT PQ_CreateQueue(LSQ_IntegerIndexT arity) {
+    if (arity < 2)
+        return LSQ_HandleInvalid;
+    PriorityQueue *newQueue = (PriorityQueue *) malloc(sizeof(PriorityQueue));
+    if (newQueue == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    int success = initArray(&newQueue->priorities);
+    success &= initArray(&newQueue->elements);
+    success &= initArray(&newQueue->positions);
+    success &= initArray(&newQueue->values);
+    success &= initArray(&newQueue->freeElements);
+    newQueue->arity = arity;
+    if (!success) {
+        PQ_DestroyQueue(newQueue);
+        return LSQ_HandleInvalid;
+    }
+    return newQueue;
+}
+  
+extern void PQ_DestroyQueue(PQ_HandleT handle) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (tmpQueue == LSQ_HandleInvalid)
+        return;
+    free(tmpQueue->priorities.value);
+    free(tmpQueue->elements.value);
+    free(tmpQueue->positions.value);
+    free(tmpQueue->values.value);
+    free(tmpQueue->freeElements.value);
+    free(tmpQueue);
+}
+  
+extern LSQ_IntegerIndexT PQ_GetSize(PQ_HandleT handle) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (tmpQueue == LSQ_HandleInvalid)
+        return 0;
+    return tmpQueue->priorities.logicalSize;
+}
+  
+extern PQ_ElementT PQ_Push(PQ_HandleT handle, LSQ_IntegerIndexT priority, LSQ_BaseTypeT value) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (tmpQueue == LSQ_HandleInvalid)
+        return PQ_ElementInvalid;
+    LSQ_IntegerIndexT size = tmpQueue->priorities.logicalSize;
+    if (!reserve(&tmpQueue->priorities, size + 1) || !reserve(&tmpQueue->elements, size + 1))
+        return PQ_ElementInvalid;
+    PQ_ElementT element = allocateElement(tmpQueue, value);
+    if (element == PQ_ElementInvalid)
+        return PQ_ElementInvalid;
+  
+    tmpQueue->priorities.value[size] = priority;
+    tmpQueue->elements.value[size] = element;
+    tmpQueue->positions.value[element] = size;
+    tmpQueue->priorities.logicalSize++;
+    tmpQueue->elements.logicalSize++;
+    siftUp(tmpQueue, size);
+    return element;
+}
+  
+/* Алгоритм Флойда: просеивание вниз всех внутренних узлов, начиная с последнего */
+extern void PQ_Heapify(PQ_HandleT handle, const LSQ_IntegerIndexT *priorities, const LSQ_BaseTypeT *values,
+                       LSQ_IntegerIndexT count, PQ_ElementT *elements) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (tmpQueue == LSQ_HandleInvalid || count <= 0)
+        return;
+    LSQ_IntegerIndexT size = tmpQueue->priorities.logicalSize;
+    if (!reserve(&tmpQueue->priorities, size + count) || !reserve(&tmpQueue->elements, size + count))
+        return;
+  
+    for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+        PQ_ElementT element = allocateElement(tmpQueue, values[i]);
+        if (elements != LSQ_HandleInvalid)
+            elements[i] = element;
+        if (element == PQ_ElementInvalid)
+            continue;
+        LSQ_IntegerIndexT position = tmpQueue->priorities.logicalSize++;
+        tmpQueue->elements.logicalSize++;
+        tmpQueue->priorities.value[position] = priorities[i];
+        tmpQueue->elements.value[position] = element;
+        tmpQueue->positions.value[element] = position;
+    }
+  
+    size = tmpQueue->priorities.logicalSize;
+    for (LSQ_IntegerIndexT i = (size - 2) / tmpQueue->arity; i >= 0; i--)
+        siftDown(tmpQueue, i);
+}
+  
+extern int PQ_Peek(PQ_HandleT handle, LSQ_IntegerIndexT *priority, LSQ_BaseTypeT *value) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (tmpQueue == LSQ_HandleInvalid || tmpQueue->priorities.logicalSize == 0)
+        return 0;
+    if (priority != LSQ_HandleInvalid)
+        *priority = tmpQueue->priorities.value[0];
+    if (value != LSQ_HandleInvalid)
+        *value = tmpQueue->values.value[tmpQueue->elements.value[0]];
+    return 1;
+}
+  
+extern int PQ_PopMin(PQ_HandleT handle, LSQ_IntegerIndexT *priority, LSQ_BaseTypeT *value) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (!PQ_Peek(handle, priority, value))
+        return 0;
+  
+    PQ_ElementT element = tmpQueue->elements.value[0];
+    tmpQueue->positions.value[element] = -1;
+    tmpQueue->freeElements.value[tmpQueue->freeElements.logicalSize++] = element;
+  
+    LSQ_IntegerIndexT last = --tmpQueue->priorities.logicalSize;
+    tmpQueue->elements.logicalSize--;
+    if (last > 0) {
+        tmpQueue->priorities.value[0] = tmpQueue->priorities.value[last];
+        tmpQueue->elements.value[0] = tmpQueue->elements.value[last];
+        tmpQueue->positions.value[tmpQueue->elements.value[0]] = 0;
+        siftDown(tmpQueue, 0);
+    }
+    return 1;
+}
+  
+extern void PQ_DecreaseKey(PQ_HandleT handle, PQ_ElementT element, LSQ_IntegerIndexT priority) {
+    PriorityQueue *tmpQueue = (PriorityQueue *) handle;
+    if (tmpQueue == LSQ_HandleInvalid || element < 0 || element >= tmpQueue->positions.logicalSize)
+        return;
+    LSQ_IntegerIndexT position = tmpQueue->positions.value[element];
+    if (position < 0 || tmpQueue->priorities.value[position] <= priority)
+        return;
+    tmpQueue->priorities.value[position] = priority;
+    siftUp(tmpQueue, position);
+}
+  
+/* Счетчики, профиль и соседи в списке живых контейнеров очереди не нужны, но setHeapSize *
+ * пишет в stats при сборке с LSQ_STATS, поэтому структура обнуляется целиком             */
+static int initArray(ArrayStruct *array) {
+    memset(array, 0, sizeof(*array));
+    array->value = (LSQ_BaseTypeT *) malloc(MIN_CAPACITY * sizeof(LSQ_BaseTypeT));
+    array->realSize = MIN_CAPACITY;
+    array->logicalSize = 0;
+    array->file = LSQ_HandleInvalid;
+    return array->value != LSQ_HandleInvalid;
+}
+  
+/* Буфер растет в GROWTH_FACTOR раз; при извлечении не сжимается, чтобы не перевыделять память *
+ * при колебании размера очереди около границы                                                 */
+static int reserve(ArrayStruct *array, LSQ_IntegerIndexT size) {
+    if (size <= array->realSize)
+        return 1;
+    LSQ_IntegerIndexT newSize = array->realSize;
+    while (newSize < size)
+        newSize *= GROWTH_FACTOR;
+    return setHeapSize(array, newSize);
+}
+  
+/* Стек свободных номеров всегда вмещает все выданные номера, поэтому при извлечении не растет */
+static PQ_ElementT allocateElement(PriorityQueue *queue, LSQ_BaseTypeT value) {
+    PQ_ElementT element;
+    if (queue->freeElements.logicalSize > 0) {
+        element = queue->freeElements.value[--queue->freeElements.logicalSize];
+    }
+    else {
+        element = queue->positions.logicalSize;
+        if (!reserve(&queue->positions, element + 1) || !reserve(&queue->values, element + 1)
+            || !reserve(&queue->freeElements, element + 1))
+            return PQ_ElementInvalid;
+        queue->positions.logicalSize++;
+        queue->values.logicalSize++;
+    }
+    queue->values.value[element] = value;
+    return element;
+}
+  
+/* Просеивание с "дыркой": элементы сдвигаются на место дырки, сохраняемый ставится один раз в конце */
+static void siftUp(PriorityQueue *queue, LSQ_IntegerIndexT position) {
+    LSQ_BaseTypeT *priorities = queue->priorities.value;
+    LSQ_BaseTypeT *elements = queue->elements.value;
+    LSQ_BaseTypeT *positions = queue->positions.value;
+    LSQ_IntegerIndexT priority = priorities[position];
+    PQ_ElementT element = elements[position];
+  
+    while (position > 0) {
+        LSQ_IntegerIndexT parent = (position - 1) / queue->arity;
+        if (priorities[parent] <= priority)
+            break;
+        priorities[position] = priorities[parent];
+        elements[position] = elements[parent];
+        positions[elements[position]] = position;
+        position = parent;
+    }
+    priorities[position] = priority;
+    elements[position] = element;
+    positions[element] = position;
+}
+  
+static void siftDown(PriorityQueue *queue, LSQ_IntegerIndexT position) {
+    LSQ_BaseTypeT *priorities = queue->priorities.value;
+    LSQ_BaseTypeT *elements = queue->elements.value;
+    LSQ_BaseTypeT *positions = queue->positions.value;
+    LSQ_IntegerIndexT size = queue->priorities.logicalSize;
+    LSQ_IntegerIndexT arity = queue->arity;
+    LSQ_IntegerIndexT priority = priorities[position];
+    PQ_ElementT element = elements[position];
+  
+    for (;;) {
+        LSQ_IntegerIndexT first = arity * position + 1;
+        if (first >= size)
+            break;
+        LSQ_IntegerIndexT last = (first + arity < size) ? first + arity : size;
+        LSQ_IntegerIndexT minChild = first;
+        for (LSQ_IntegerIndexT child = first + 1; child < last; child++)
+            if (priorities[child] < priorities[minChild])
+                minChild = child;
+        if (priorities[minChild] >= priority)
+            break;
+        priorities[position] = priorities[minChild];
+        elements[position] = elements[minChild];
+        positions[elements[position]] = position;
+        position = minChild;
+    }
+    priorities[position] = priority;
+    elements[position] = element;
+    positions[element] = position;
+}
@@ -0,0 +1,41 @@
+#ifndef PRIORITY_QUEUE_H_INCLUDED
+#define PRIORITY_QUEUE_H_INCLUDED
+ 
+#include "linear_sequence.h"
+ 
+/* Дескриптор очереди с приоритетом */
+typedef void* PQ_HandleT;
+ 
+/* Номер элемента очереди, выдается при добавлении и нужен для уменьшения приоритета.  *
+ * Номер действителен, пока элемент в очереди; после извлечения он может быть выдан снова. */
+typedef LSQ_IntegerIndexT PQ_ElementT;
+ 
+/* Недействительный номер элемента */
+#define PQ_ElementInvalid (-1)
+ 
+/* Функция, создающая пустую очередь - d-арную кучу с минимумом в корне. arity - число сыновей узла:  *
+ * 2 - двоичная куча, 4 - четверичная (сыновья узла обычно в одной строке кэша, куча ниже вдвое).  */
+extern PQ_HandleT PQ_CreateQueue(LSQ_IntegerIndexT arity);
+/* Функция, уничтожающая очередь и освобождающая принадлежащую ей память */
+extern void PQ_DestroyQueue(PQ_HandleT handle);
+ 
+/* Функция, возвращающая количество элементов в очереди */
+extern LSQ_IntegerIndexT PQ_GetSize(PQ_HandleT handle);
+ 
+/* Функция, добавляющая элемент с заданным приоритетом за O(log n). Возвращает номер элемента */
+extern PQ_ElementT PQ_Push(PQ_HandleT handle, LSQ_IntegerIndexT priority, LSQ_BaseTypeT value);
+/* Функция, добавляющая count элементов и восстанавливающая кучу снизу вверх за O(n). Если elements не NULL, *
+ * в elements[i] записывается номер i-го элемента.                                                         */
+extern void PQ_Heapify(PQ_HandleT handle, const LSQ_IntegerIndexT *priorities, const LSQ_BaseTypeT *values,
+                       LSQ_IntegerIndexT count, PQ_ElementT *elements);
+ 
+/* Функция, записывающая приоритет и значение элемента с минимальным приоритетом. Возвращает 0, если очередь пуста. *
+ * Указатели priority и value могут быть NULL.                                                                   */
+extern int PQ_Peek(PQ_HandleT handle, LSQ_IntegerIndexT *priority, LSQ_BaseTypeT *value);
+/* Функция, извлекающая элемент с минимальным приоритетом, аналогично PQ_Peek */
+extern int PQ_PopMin(PQ_HandleT handle, LSQ_IntegerIndexT *priority, LSQ_BaseTypeT *value);
+ 
+/* Функция, уменьшающая приоритет элемента. Если новый приоритет не меньше текущего, ничего не делает */
+extern void PQ_DecreaseKey(PQ_HandleT handle, PQ_ElementT element, LSQ_IntegerIndexT priority);
+ 
+#endif
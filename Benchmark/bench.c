@@ -0,0 +1,387 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <sys/resource.h>
+
+/* Один и тот же набор тестов собирается с каждым контейнером (см. makefile). Контейнеры с интерфейсом *
+ * linear_sequence_assoc.h собираются с BENCH_ASSOCIATIVE, остальные - с linear_sequence.h. Контейнеры  *
+ * без LSQ_ForEach и LSQ_DestroySequenceAsync собираются с BENCH_BASIC_INTERFACE и пропускают их замеры. */
+#ifdef BENCH_ASSOCIATIVE
+#include "linear_sequence_assoc.h"
+#else
+#include "linear_sequence.h"
+#endif
+
+#ifndef BENCH_CONTAINER
+#define BENCH_CONTAINER "unknown"
+#endif
+
+#define MIN_SIZE 1000
+#define DEFAULT_MAX_SIZE 1000000
+#define DEFAULT_MAX_OPERATIONS 1000000
+#define DEFAULT_BUDGET 0.5
+#define TIME_CHECK_MASK 255
+#define ZIPF_THETA 0.99
+#define ZIPF_EXACT_TERMS 1000000
+#define SCRAMBLE_MULTIPLIER 2654435761ULL
+
+typedef enum {
+    PATTERN_SEQUENTIAL,
+    PATTERN_RANDOM,
+    PATTERN_ZIPF,
+    PATTERN_COUNT
+} Pattern;
+
+static const char *patternNames[PATTERN_COUNT] = {"sequential", "random", "zipf"};
+
+typedef enum {
+    FORMAT_CSV,
+    FORMAT_JSON
+} Format;
+
+/* Параметры запуска и накопленная контрольная сумма, чтобы компилятор не выбросил чтения */
+static struct {
+    LSQ_IntegerIndexT maxSize;
+    LSQ_IntegerIndexT maxOperations;
+    double budget;
+    Format format;
+    FILE *output;
+    long long checksum;
+} bench = {DEFAULT_MAX_SIZE, DEFAULT_MAX_OPERATIONS, DEFAULT_BUDGET, FORMAT_CSV, NULL, 0};
+
+static unsigned long long seed;
+
+static unsigned int nextRandom(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int) (seed >> 32);
+}
+
+static double nextUniform(void) {
+    return nextRandom() / 4294967296.0;
+}
+
+static double getTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static long getPeakRss(void) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+/* Сумма i^-theta для i = 1..n: первые ZIPF_EXACT_TERMS слагаемых точно, хвост - интегралом */
+static double zeta(LSQ_IntegerIndexT n, double theta) {
+    LSQ_IntegerIndexT exact = (n < ZIPF_EXACT_TERMS) ? n : ZIPF_EXACT_TERMS;
+    double sum = 0;
+    for (LSQ_IntegerIndexT i = 1; i <= exact; i++)
+        sum += pow(i, -theta);
+    if (n > exact)
+        sum += (pow(n + 0.5, 1 - theta) - pow(exact + 0.5, 1 - theta)) / (1 - theta);
+    return sum;
+}
+
+/* Заполняет indices номерами из [0, size). Распределение Ципфа строится по Грею и др. (SIGMOD 1994), *
+ * а ранги перемешиваются умножением на нечетное простое, чтобы горячие элементы не шли подряд.      */
+static void fillIndices(LSQ_IntegerIndexT *indices, LSQ_IntegerIndexT count, LSQ_IntegerIndexT size,
+                        Pattern pattern) {
+    seed = 88172645463325252ULL + (unsigned long long) size * PATTERN_COUNT + pattern;
+    if (pattern == PATTERN_SEQUENTIAL) {
+        for (LSQ_IntegerIndexT i = 0; i < count; i++)
+            indices[i] = i % size;
+        return;
+    }
+    if (pattern == PATTERN_RANDOM) {
+        for (LSQ_IntegerIndexT i = 0; i < count; i++)
+            indices[i] = (LSQ_IntegerIndexT) (nextRandom() % (unsigned int) size);
+        return;
+    }
+    double zetaN = zeta(size, ZIPF_THETA);
+    double alpha = 1 / (1 - ZIPF_THETA);
+    double eta = (1 - pow(2.0 / size, 1 - ZIPF_THETA)) / (1 - (1 + pow(0.5, ZIPF_THETA)) / zetaN);
+    for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+        double u = nextUniform();
+        double uz = u * zetaN;
+        unsigned long long rank;
+        if (uz < 1)
+            rank = 0;
+        else if (uz < 1 + pow(0.5, ZIPF_THETA))
+            rank = 1;
+        else
+            rank = (unsigned long long) (size * pow(eta * u - eta + 1, alpha));
+        if (rank >= (unsigned long long) size)
+            rank = size - 1;
+        indices[i] = (LSQ_IntegerIndexT) (rank * SCRAMBLE_MULTIPLIER % (unsigned long long) size);
+    }
+}
+
+static void report(const char *operation, Pattern pattern, LSQ_IntegerIndexT size, LSQ_IntegerIndexT operations,
+                   double seconds) {
+    double nsPerOperation = (operations > 0) ? seconds * 1e9 / operations : 0;
+    double throughput = (seconds > 0) ? operations / seconds : 0;
+    if (bench.format == FORMAT_JSON)
+        fprintf(bench.output, "{\"container\": \"%s\", \"operation\": \"%s\", \"pattern\": \"%s\", \"size\": %d, "
+                "\"operations\": %d, \"ns_per_op\": %.3f, \"ops_per_sec\": %.1f, \"peak_rss_kb\": %ld}\n",
+                BENCH_CONTAINER, operation, patternNames[pattern], size, operations, nsPerOperation, throughput,
+                getPeakRss());
+    else
+        fprintf(bench.output, "%s,%s,%s,%d,%d,%.3f,%.1f,%ld\n", BENCH_CONTAINER, operation, patternNames[pattern],
+                size, operations, nsPerOperation, throughput, getPeakRss());
+    fflush(bench.output);
+}
+
+/* Цикл замера останавливается, когда исчерпан бюджет времени: так O(n) операции на больших размерах *
+ * тоже укладываются в разумное время, а в отчет попадает фактическое число выполненных операций.   *
+ * Время проверяется на степенях двойки и далее каждые TIME_CHECK_MASK + 1 операций.                */
+static int outOfBudget(LSQ_IntegerIndexT done, double start) {
+    return done > 0 && ((done & (done - 1)) == 0 || (done & TIME_CHECK_MASK) == 0) && getTime() - start > bench.budget;
+}
+
+static void readIterator(LSQ_IteratorT iterator) {
+    if (LSQ_IsIteratorDereferencable(iterator))
+        bench.checksum += *LSQ_DereferenceIterator(iterator);
+}
+
+#ifndef BENCH_BASIC_INTERFACE
+static int addToChecksum(LSQ_IntegerIndexT index, LSQ_BaseTypeT *value, void *context) {
+    (void) index;
+    (void) context;
+    bench.checksum += *value;
+    return 0;
+}
+#endif
+
+static LSQ_HandleT createFilled(LSQ_IntegerIndexT size) {
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+#ifdef BENCH_ASSOCIATIVE
+        LSQ_InsertElement(handle, i, i);
+#else
+        LSQ_InsertRearElement(handle, i);
+#endif
+    return handle;
+}
+
+/* Операции, не зависящие от шаблона доступа: построение, обходы, удаление с концов, уничтожение */
+static void benchStructure(LSQ_IntegerIndexT size) {
+    LSQ_IntegerIndexT done;
+    double start = getTime();
+    LSQ_HandleT handle = createFilled(size);
+#ifdef BENCH_ASSOCIATIVE
+    report("insert_ascending", PATTERN_SEQUENTIAL, size, size, getTime() - start);
+#else
+    report("insert_rear", PATTERN_SEQUENTIAL, size, size, getTime() - start);
+#endif
+
+    start = getTime();
+    for (done = 0; done < size && !outOfBudget(done, start); done++)
+        bench.checksum += LSQ_GetSize(handle);
+    report("get_size", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+
+    start = getTime();
+    for (done = 0; done < size && !outOfBudget(done, start); done++) {
+        LSQ_IteratorT iterator = (done & 1) ? LSQ_GetPastRearElement(handle) : LSQ_GetFrontElement(handle);
+        bench.checksum += LSQ_IsIteratorPastRear(iterator);
+        LSQ_DestroyIterator(iterator);
+    }
+    report("get_front_past_rear", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+
+    LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+    start = getTime();
+    for (done = 0; !LSQ_IsIteratorPastRear(iterator) && !outOfBudget(done, start); done++) {
+        bench.checksum += *LSQ_DereferenceIterator(iterator);
+        LSQ_AdvanceOneElement(iterator);
+    }
+    report("advance", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+    LSQ_DestroyIterator(iterator);
+
+#ifndef BENCH_BASIC_INTERFACE
+    start = getTime();
+    LSQ_ForEach(handle, addToChecksum, NULL);
+    report("for_each", PATTERN_SEQUENTIAL, size, size, getTime() - start);
+#endif
+
+    iterator = LSQ_GetPastRearElement(handle);
+    LSQ_RewindOneElement(iterator);
+    start = getTime();
+    for (done = 0; LSQ_IsIteratorDereferencable(iterator) && !outOfBudget(done, start); done++) {
+        bench.checksum += *LSQ_DereferenceIterator(iterator);
+        LSQ_RewindOneElement(iterator);
+    }
+    report("rewind", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+    LSQ_DestroyIterator(iterator);
+
+    start = getTime();
+    for (done = 0; LSQ_GetSize(handle) > 0 && !outOfBudget(done, start); done++)
+        LSQ_DeleteFrontElement(handle);
+    report("delete_front", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+    LSQ_DestroySequence(handle);
+
+    handle = createFilled(size);
+    start = getTime();
+    for (done = 0; LSQ_GetSize(handle) > 0 && !outOfBudget(done, start); done++)
+        LSQ_DeleteRearElement(handle);
+    report("delete_rear", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+    LSQ_DestroySequence(handle);
+
+    handle = createFilled(size);
+    start = getTime();
+    LSQ_DestroySequence(handle);
+    report("destroy", PATTERN_SEQUENTIAL, size, size, getTime() - start);
+
+#ifndef BENCH_BASIC_INTERFACE
+    // замеряется только время вызывающего потока; освобождение завершается вне замера
+    handle = createFilled(size);
+    start = getTime();
+    LSQ_DestroySequenceAsync(handle);
+    report("destroy_async", PATTERN_SEQUENTIAL, size, size, getTime() - start);
+    LSQ_WaitForAsyncDestroy();
+#endif
+
+#ifndef BENCH_ASSOCIATIVE
+    handle = LSQ_CreateSequence();
+    start = getTime();
+    for (done = 0; done < size && !outOfBudget(done, start); done++)
+        LSQ_InsertFrontElement(handle, done);
+    report("insert_front", PATTERN_SEQUENTIAL, size, done, getTime() - start);
+    LSQ_DestroySequence(handle);
+#endif
+}
+
+/* Операции над элементами, выбранными по шаблону: номера (для ассоциативных контейнеров - ключи) из indices */
+static void benchPattern(LSQ_IntegerIndexT size, Pattern pattern, const LSQ_IntegerIndexT *indices,
+                         LSQ_IntegerIndexT count) {
+    LSQ_IntegerIndexT done;
+    LSQ_HandleT handle = createFilled(size);
+
+    double start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++) {
+        LSQ_IteratorT iterator = LSQ_GetElementByIndex(handle, indices[done]);
+        readIterator(iterator);
+        LSQ_DestroyIterator(iterator);
+    }
+    report("get_by_index", pattern, size, done, getTime() - start);
+
+#ifdef BENCH_ASSOCIATIVE
+    // ключи контейнера - 0..size-1, так что сдвинутые на size ключи гарантированно отсутствуют
+    start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++) {
+        LSQ_IteratorT iterator = LSQ_GetElementByIndex(handle, indices[done] + size);
+        readIterator(iterator);
+        LSQ_DestroyIterator(iterator);
+    }
+    report("get_missing", pattern, size, done, getTime() - start);
+#endif
+
+    LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+    start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++) {
+        LSQ_SetPosition(iterator, indices[done]);
+        readIterator(iterator);
+    }
+    report("set_position", pattern, size, done, getTime() - start);
+
+    LSQ_SetPosition(iterator, 0);
+    LSQ_IntegerIndexT position = 0;
+    start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++) {
+        LSQ_ShiftPosition(iterator, indices[done] - position);
+        position = indices[done];
+        readIterator(iterator);
+    }
+    report("shift_position", pattern, size, done, getTime() - start);
+    LSQ_DestroyIterator(iterator);
+
+#ifdef BENCH_ASSOCIATIVE
+    start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++)
+        LSQ_DeleteElement(handle, indices[done]);
+    report("delete", pattern, size, done, getTime() - start);
+    LSQ_DestroySequence(handle);
+
+    handle = LSQ_CreateSequence();
+    start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++)
+        LSQ_InsertElement(handle, indices[done], done);
+    report("insert", pattern, size, done, getTime() - start);
+#else
+    // позиционирование итератора входит в замер: для списка оно и есть основная стоимость
+    iterator = LSQ_GetFrontElement(handle);
+    start = getTime();
+    for (done = 0; done < count && !outOfBudget(done, start); done++) {
+        LSQ_SetPosition(iterator, indices[done]);
+        LSQ_InsertElementBeforeGiven(iterator, done);
+    }
+    report("insert_before_given", pattern, size, done, getTime() - start);
+
+    start = getTime();
+    for (done = 0; done < count && LSQ_GetSize(handle) > 0 && !outOfBudget(done, start); done++) {
+        LSQ_SetPosition(iterator, indices[done] % LSQ_GetSize(handle));
+        LSQ_DeleteGivenElement(iterator);
+    }
+    report("delete_given", pattern, size, done, getTime() - start);
+    LSQ_DestroyIterator(iterator);
+#endif
+    LSQ_DestroySequence(handle);
+}
+
+static void usage(const char *program) {
+    fprintf(stderr, "usage: %s [--max-size N] [--max-ops N] [--budget SECONDS] [--format csv|json] "
+            "[--output FILE]\n", program);
+    exit(1);
+}
+
+/* Результаты дописываются в конец файла, так что запуски с разными контейнерами собираются в один отчет. *
+ * JSON выводится построчно (JSON Lines), заголовок CSV - только в пустой файл.                          */
+int main(int argc, char **argv) {
+    const char *outputPath = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (i + 1 == argc)
+            usage(argv[0]);
+        if (strcmp(argv[i], "--max-size") == 0)
+            bench.maxSize = (LSQ_IntegerIndexT) atof(argv[++i]);
+        else if (strcmp(argv[i], "--max-ops") == 0)
+            bench.maxOperations = (LSQ_IntegerIndexT) atof(argv[++i]);
+        else if (strcmp(argv[i], "--budget") == 0)
+            bench.budget = atof(argv[++i]);
+        else if (strcmp(argv[i], "--format") == 0)
+            bench.format = (strcmp(argv[++i], "json") == 0) ? FORMAT_JSON : FORMAT_CSV;
+        else if (strcmp(argv[i], "--output") == 0)
+            outputPath = argv[++i];
+        else
+            usage(argv[0]);
+    }
+    bench.output = stdout;
+    if (outputPath != NULL && (bench.output = fopen(outputPath, "a")) == NULL) {
+        perror(outputPath);
+        return 1;
+    }
+    if (bench.format == FORMAT_CSV && ftell(bench.output) <= 0)
+        fprintf(bench.output, "container,operation,pattern,size,operations,ns_per_op,ops_per_sec,peak_rss_kb\n");
+
+    LSQ_IntegerIndexT count = (bench.maxOperations < bench.maxSize) ? bench.maxOperations : bench.maxSize;
+    LSQ_IntegerIndexT *indices = (LSQ_IntegerIndexT *) malloc(count * sizeof(LSQ_IntegerIndexT));
+    if (indices == NULL)
+        return 1;
+    for (LSQ_IntegerIndexT size = MIN_SIZE; size <= bench.maxSize; size *= 10) {
+        benchStructure(size);
+        LSQ_IntegerIndexT sizeCount = (count < size) ? count : size;
+        for (int pattern = 0; pattern < PATTERN_COUNT; pattern++) {
+            fillIndices(indices, sizeCount, size, (Pattern) pattern);
+            benchPattern(size, (Pattern) pattern, indices, sizeCount);
+        }
+        if (size > bench.maxSize / 10)
+            break;
+    }
+    free(indices);
+    fprintf(stderr, "%s: checksum %lld\n", BENCH_CONTAINER, bench.checksum);
+    if (bench.output != stdout)
+        fclose(bench.output);
+    return 0;
+}
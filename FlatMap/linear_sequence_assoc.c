@@ -0,0 +1,329 @@
+#include <stdlib.h>
+#include <limits.h>
+#include <string.h>
+#include "linear_sequence_assoc.h"
+#include "../Instrumentation/instrumentation.h"
+ 
+
+#define MIN_CAPACITY 16
+#define GROWTH_FACTOR 2
+#define PERCENT_LOW_LINE 0.25
+#define INDEX_PAST_REAR INT_MAX
+ 
+/* Ключи и значения лежат в отдельных упорядоченных по ключу массивах: поиск читает только keys, *
+ * и в строку кэша попадает шестнадцать ключей. version меняется при каждом сдвиге элементов.      */
+typedef struct FlatMap_ {
+    LSQ_IntegerIndexT *keys;
+    LSQ_BaseTypeT *values;
+    LSQ_IntegerIndexT size;
+    LSQ_IntegerIndexT capacity;
+    unsigned long version;
+    /* Соседи в списке живых контейнеров */
+    struct FlatMap_ *nextLive;
+    struct FlatMap_ *prevLive;
+} FlatMap;
+ 
+/* index == -1 - перед первым элементом, INDEX_PAST_REAR - за последним. Если контейнер с тех пор *
+ * менялся, index ищется заново по key; удаленный элемент заменяется следующим за ним.            */
+typedef struct {
+    FlatMap *map;
+    LSQ_IntegerIndexT index;
+    LSQ_IntegerIndexT key;
+    unsigned long version;
+} Iterator;
+ 
+LIVE_CONTAINERS(FlatMap)
+ 
+static Iterator *createIterator(FlatMap *, LSQ_IntegerIndexT );
+static void setIndex(Iterator *, LSQ_IntegerIndexT );
+static void validateIterator(Iterator *);
+static LSQ_IntegerIndexT lowerBound(FlatMap *, LSQ_IntegerIndexT );
+static int setCapacity(FlatMap *, LSQ_IntegerIndexT );
+static void deleteAt(FlatMap *, LSQ_IntegerIndexT );
+ 
+LSQ_HandleT LSQ_CreateSequence(void) {
+    FlatMap *newMap = (FlatMap *) malloc(sizeof(FlatMap));
+    if (newMap == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    registerContainer(newMap);
+    newMap->keys = LSQ_HandleInvalid;
+    newMap->values = LSQ_HandleInvalid;
+    newMap->size = 0;
+    newMap->capacity = 0;
+    newMap->version = 0;
+    if (!setCapacity(newMap, MIN_CAPACITY)) {
+        LSQ_DestroySequence(newMap);
+        return LSQ_HandleInvalid;
+    }
+    return newMap;
+}
+ 
+void LSQ_DestroySequence(LSQ_HandleT handle) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    unregisterContainer(tmpMap);
+    free(tmpMap->keys);
+    free(tmpMap->values);
+    free(tmpMap);
+}
+ 
+LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle){
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid) {
+        return 0;
+    }
+    return tmpMap->size;
+}
+ 
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    size_t elementBytes = sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT);
+    usage->payload = tmpMap->size * elementBytes;
+    usage->overhead = sizeof(FlatMap);
+    usage->slack = (tmpMap->capacity - tmpMap->size) * elementBytes;
+}
+ 
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (FlatMap *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+ 
+
+int LSQ_IsIteratorDereferencable(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->index >= 0 && tmpIterator->index != INDEX_PAST_REAR;
+}
+ 
+extern int LSQ_IsIteratorPastRear(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->index == INDEX_PAST_REAR;
+}
+ 
+extern int LSQ_IsIteratorBeforeFirst(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return (tmpIterator != LSQ_HandleInvalid && tmpIterator->index < 0);
+}
+ 
+extern LSQ_BaseTypeT* LSQ_DereferenceIterator(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return &tmpIterator->map->values[tmpIterator->index];
+}
+ 
+extern LSQ_IntegerIndexT LSQ_GetIteratorKey(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)){
+        return -1;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return tmpIterator->map->keys[tmpIterator->index];
+}
+ 
+extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid) {
+        return LSQ_HandleInvalid;
+    }
+    LSQ_IntegerIndexT position = lowerBound(tmpMap, index);
+    if (position < tmpMap->size && tmpMap->keys[position] != index)
+        position = INDEX_PAST_REAR;
+    return createIterator(tmpMap, position);
+}
+ 
+extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpMap, 0);
+}
+ 
+extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpMap, INDEX_PAST_REAR);
+}
+ 
+extern void LSQ_DestroyIterator(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    free(tmpIterator);
+}
+ 
+
+extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
+    LSQ_ShiftPosition(iterator, 1);
+}
+ 
+extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
+    LSQ_ShiftPosition(iterator, -1);
+}
+ 
+/* Итератор не выходит за фиктивные элементы: после любого сдвига он на элементе, BeforeFirst или PastRear */
+extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return;
+    validateIterator(tmpIterator);
+    LSQ_IntegerIndexT size = tmpIterator->map->size;
+    LSQ_IntegerIndexT index = (tmpIterator->index > size) ? size : tmpIterator->index;
+    if (shift > 0)
+        index = (shift >= size - index) ? size : index + shift;
+    else
+        index = (shift <= -1 - index) ? -1 : index + shift;
+    setIndex(tmpIterator, index);
+}
+ 
+extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid) {
+        return;
+    }
+    FlatMap *tmpMap = tmpIterator->map;
+    LSQ_IntegerIndexT position = lowerBound(tmpMap, pos);
+    setIndex(tmpIterator, (position < tmpMap->size && tmpMap->keys[position] == pos) ? position : INDEX_PAST_REAR);
+}
+ 
+extern void LSQ_SetRank(LSQ_IteratorT iterator, LSQ_IntegerIndexT rank) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid) {
+        return;
+    }
+    setIndex(tmpIterator, (rank < 0) ? -1 : rank);
+}
+ 
+extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    LSQ_IntegerIndexT position = lowerBound(tmpMap, key);
+    if (position < tmpMap->size && tmpMap->keys[position] == key) {
+        tmpMap->values[position] = value;
+        return;
+    }
+    if (tmpMap->size == tmpMap->capacity && !setCapacity(tmpMap, tmpMap->capacity * GROWTH_FACTOR))
+        return;
+    LSQ_IntegerIndexT tail = tmpMap->size - position;
+    memmove(tmpMap->keys + position + 1, tmpMap->keys + position, tail * sizeof(LSQ_IntegerIndexT));
+    memmove(tmpMap->values + position + 1, tmpMap->values + position, tail * sizeof(LSQ_BaseTypeT));
+    tmpMap->keys[position] = key;
+    tmpMap->values[position] = value;
+    tmpMap->size++;
+    tmpMap->version++;
+}
+ 
+extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid || tmpMap->size == 0)
+        return;
+    deleteAt(tmpMap, 0);
+}
+ 
+extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid || tmpMap->size == 0)
+        return;
+    deleteAt(tmpMap, tmpMap->size - 1);
+}
+ 
+extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
+    FlatMap *tmpMap = (FlatMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    LSQ_IntegerIndexT position = lowerBound(tmpMap, key);
+    if (position < tmpMap->size && tmpMap->keys[position] == key)
+        deleteAt(tmpMap, position);
+}
+ 
+static Iterator *createIterator(FlatMap *map, LSQ_IntegerIndexT index) {
+    Iterator *newIterator = (Iterator *) malloc(sizeof(Iterator));
+    if (newIterator == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newIterator->map = map;
+    setIndex(newIterator, index);
+    return newIterator;
+}
+ 
+/* index за последним элементом превращается в INDEX_PAST_REAR, у элемента запоминается ключ */
+static void setIndex(Iterator *iterator, LSQ_IntegerIndexT index) {
+    FlatMap *map = iterator->map;
+    iterator->version = map->version;
+    iterator->index = (index >= map->size) ? INDEX_PAST_REAR : index;
+    if (iterator->index >= 0 && iterator->index != INDEX_PAST_REAR)
+        iterator->key = map->keys[iterator->index];
+}
+ 
+static void validateIterator(Iterator *iterator) {
+    FlatMap *map = iterator->map;
+    if (iterator->version == map->version)
+        return;
+    if (iterator->index < 0 || iterator->index == INDEX_PAST_REAR)
+        iterator->version = map->version;
+    else
+        setIndex(iterator, lowerBound(map, iterator->key));
+}
+ 
+/* Номер первого ключа, не меньшего key. Поиск без ветвлений: интервал всегда делится пополам,  *
+ * а выбор половины компилируется в условную пересылку, так что ошибок предсказания переходов нет. */
+static LSQ_IntegerIndexT lowerBound(FlatMap *map, LSQ_IntegerIndexT key) {
+    const LSQ_IntegerIndexT *base = map->keys;
+    LSQ_IntegerIndexT length = map->size;
+    if (length == 0)
+        return 0;
+    while (length > 1) {
+        LSQ_IntegerIndexT half = length / 2;
+        base = (base[half] < key) ? base + half : base;
+        length -= half;
+    }
+    return (LSQ_IntegerIndexT) (base - map->keys) + (*base < key);
+}
+ 
+/* Возвращает 0, если память выделить не удалось. capacity не превышает длины ни одного из массивов */
+static int setCapacity(FlatMap *map, LSQ_IntegerIndexT capacity) {
+    LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) realloc(map->keys, capacity * sizeof(LSQ_IntegerIndexT));
+    if (keys == LSQ_HandleInvalid)
+        return 0;
+    map->keys = keys;
+    if (capacity < map->capacity)
+        map->capacity = capacity;
+    LSQ_BaseTypeT *values = (LSQ_BaseTypeT *) realloc(map->values, capacity * sizeof(LSQ_BaseTypeT));
+    if (values == LSQ_HandleInvalid)
+        return 0;
+    map->values = values;
+    map->capacity = capacity;
+    return 1;
+}
+ 
+/* Массивы сжимаются вдвое, только когда заполнены меньше чем на четверть, чтобы чередование *
+ * вставок и удалений на границе не перевыделяло память каждый раз.                         */
+static void deleteAt(FlatMap *map, LSQ_IntegerIndexT position) {
+    LSQ_IntegerIndexT tail = map->size - position - 1;
+    memmove(map->keys + position, map->keys + position + 1, tail * sizeof(LSQ_IntegerIndexT));
+    memmove(map->values + position, map->values + position + 1, tail * sizeof(LSQ_BaseTypeT));
+    map->size--;
+    map->version++;
+    if (map->capacity > MIN_CAPACITY && map->size < map->capacity * PERCENT_LOW_LINE)
+        setCapacity(map, map->capacity / GROWTH_FACTOR);
+}
@@ -0,0 +1,402 @@
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "linear_sequence_assoc.h"
+#include "../Instrumentation/instrumentation.h"
+ 
+ 
+#define GROUP_SIZE 16
+#define MIN_CAPACITY 16
+#define MAX_LOAD_NUMERATOR 7
+#define MAX_LOAD_DENOMINATOR 8
+#define HASH_MULTIPLIER 0x9E3779B97F4A7C15ULL
+#define CONTROL_EMPTY ((signed char) -128)
+#define POSITION_BEFORE_FIRST (-1)
+#define POSITION_PAST_REAR (-2)
+ 
+typedef struct {
+    LSQ_IntegerIndexT key;
+    LSQ_BaseTypeT value;
+} Slot;
+ 
+/* Открытая адресация с линейным пробированием. Для каждого слота хранится управляющий байт: CONTROL_EMPTY *
+ * или 7 бит хеша ключа. Байты просматриваются группами по 16 за одно сравнение SSE2. За последним байтом  *
+ * лежит копия первых GROUP_SIZE байтов, чтобы группа, начатая в конце таблицы, читалась одной загрузкой.  *
+ * Удаление без надгробий: следующие элементы цепочки сдвигаются назад.                                    */
+typedef struct HashMap_ {
+    signed char *control;
+    Slot *slots;
+    size_t mask;
+    int shift;
+    LSQ_IntegerIndexT size;
+    /* Соседи в списке живых контейнеров */
+    struct HashMap_ *nextLive;
+    struct HashMap_ *prevLive;
+} HashMap;
+ 
+/* slot - номер слота таблицы или POSITION_BEFORE_FIRST, POSITION_PAST_REAR */
+typedef struct {
+    HashMap *map;
+    long slot;
+} Iterator;
+ 
+LIVE_CONTAINERS(HashMap)
+ 
+static Iterator *createIterator(HashMap *, long );
+static int allocateTable(HashMap *, size_t );
+static size_t getHome(HashMap *, LSQ_IntegerIndexT );
+static signed char getFingerprint(HashMap *, LSQ_IntegerIndexT );
+static void setControl(HashMap *, size_t , signed char );
+static unsigned int matchGroup(const signed char *, signed char );
+static long findSlot(HashMap *, LSQ_IntegerIndexT );
+static size_t findEmptySlot(HashMap *, LSQ_IntegerIndexT );
+static long nextOccupied(HashMap *, long );
+static long previousOccupied(HashMap *, long );
+static int grow(HashMap *);
+static void deleteSlot(HashMap *, size_t );
+ 
+LSQ_HandleT LSQ_CreateSequence(void) {
+    HashMap *newMap = (HashMap *) malloc(sizeof(HashMap));
+    if (newMap == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    if (!allocateTable(newMap, MIN_CAPACITY)) {
+        free(newMap);
+        return LSQ_HandleInvalid;
+    }
+    newMap->size = 0;
+    registerContainer(newMap);
+    return newMap;
+}
+ 
+void LSQ_DestroySequence(LSQ_HandleT handle) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    unregisterContainer(tmpMap);
+    free(tmpMap->control);
+    free(tmpMap->slots);
+    free(tmpMap);
+}
+ 
+LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle){
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid) {
+        return 0;
+    }
+    return tmpMap->size;
+}
+ 
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    size_t capacity = tmpMap->mask + 1;
+    usage->payload = tmpMap->size * sizeof(Slot);
+    usage->overhead = sizeof(HashMap) + capacity + GROUP_SIZE;
+    usage->slack = (capacity - tmpMap->size) * sizeof(Slot);
+}
+ 
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (HashMap *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+ 
+ 
+int LSQ_IsIteratorDereferencable(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return (tmpIterator != LSQ_HandleInvalid && tmpIterator->map != LSQ_HandleInvalid && tmpIterator->slot >= 0);
+}
+ 
+extern int LSQ_IsIteratorPastRear(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return (tmpIterator != LSQ_HandleInvalid && tmpIterator->slot == POSITION_PAST_REAR);
+}
+ 
+extern int LSQ_IsIteratorBeforeFirst(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return (tmpIterator != LSQ_HandleInvalid && tmpIterator->slot == POSITION_BEFORE_FIRST);
+}
+ 
+extern LSQ_BaseTypeT* LSQ_DereferenceIterator(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return &tmpIterator->map->slots[tmpIterator->slot].value;
+}
+ 
+extern LSQ_IntegerIndexT LSQ_GetIteratorKey(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)){
+        return -1;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return tmpIterator->map->slots[tmpIterator->slot].key;
+}
+ 
+extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid) {
+        return LSQ_HandleInvalid;
+    }
+    long slot = findSlot(tmpMap, index);
+    return createIterator(tmpMap, (slot >= 0) ? slot : POSITION_PAST_REAR);
+}
+ 
+extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpMap, nextOccupied(tmpMap, 0));
+}
+ 
+extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpMap, POSITION_PAST_REAR);
+}
+ 
+extern void LSQ_DestroyIterator(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    free(tmpIterator);
+}
+ 
+ 
+extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *)iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->map == LSQ_HandleInvalid || LSQ_IsIteratorPastRear(tmpIterator))
+        return;
+    tmpIterator->slot = nextOccupied(tmpIterator->map, tmpIterator->slot + 1);
+}
+ 
+extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->map == LSQ_HandleInvalid || LSQ_IsIteratorBeforeFirst(tmpIterator))
+        return;
+    long from = LSQ_IsIteratorPastRear(tmpIterator) ? (long) tmpIterator->map->mask : tmpIterator->slot - 1;
+    tmpIterator->slot = previousOccupied(tmpIterator->map, from);
+}
+ 
+ 
+extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || shift == 0)
+        return;
+    if (shift > 0) {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorPastRear(tmpIterator); i--) {
+            LSQ_AdvanceOneElement(tmpIterator);
+        }
+    }
+    else {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorBeforeFirst(tmpIterator); i++) {
+            LSQ_RewindOneElement(tmpIterator);
+        }
+    }
+}
+ 
+/* Как и в LSQ_GetElementByIndex, номер элемента ассоциативного контейнера - его ключ */
+extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid) {
+        return;
+    }
+    long slot = findSlot(tmpIterator->map, pos);
+    tmpIterator->slot = (slot >= 0) ? slot : POSITION_PAST_REAR;
+}
+ 
+extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    long slot = findSlot(tmpMap, key);
+    if (slot >= 0) {
+        tmpMap->slots[slot].value = value;
+        return;
+    }
+    if ((size_t) (tmpMap->size + 1) * MAX_LOAD_DENOMINATOR > (tmpMap->mask + 1) * MAX_LOAD_NUMERATOR
+        && !grow(tmpMap))
+        return;
+ 
+    size_t emptySlot = findEmptySlot(tmpMap, key);
+    setControl(tmpMap, emptySlot, getFingerprint(tmpMap, key));
+    tmpMap->slots[emptySlot].key = key;
+    tmpMap->slots[emptySlot].value = value;
+    tmpMap->size++;
+}
+ 
+extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid || tmpMap->size == 0)
+        return;
+    deleteSlot(tmpMap, nextOccupied(tmpMap, 0));
+}
+ 
+extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid || tmpMap->size == 0)
+        return;
+    deleteSlot(tmpMap, previousOccupied(tmpMap, tmpMap->mask));
+}
+ 
+extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
+    HashMap *tmpMap = (HashMap *) handle;
+    if (tmpMap == LSQ_HandleInvalid)
+        return;
+    long slot = findSlot(tmpMap, key);
+    if (slot >= 0)
+        deleteSlot(tmpMap, slot);
+}
+ 
+static Iterator *createIterator(HashMap *map, long slot) {
+    Iterator *newIterator = (Iterator *) malloc(sizeof(Iterator));
+    if (newIterator == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newIterator->map = map;
+    newIterator->slot = slot;
+    return newIterator;
+}
+ 
+static int allocateTable(HashMap *map, size_t capacity) {
+    signed char *control = (signed char *) malloc(capacity + GROUP_SIZE);
+    Slot *slots = (Slot *) malloc(capacity * sizeof(Slot));
+    if (control == LSQ_HandleInvalid || slots == LSQ_HandleInvalid) {
+        free(control);
+        free(slots);
+        return 0;
+    }
+    memset(control, CONTROL_EMPTY, capacity + GROUP_SIZE);
+    map->control = control;
+    map->slots = slots;
+    map->mask = capacity - 1;
+    map->shift = 64 - __builtin_ctzll(capacity);
+    return 1;
+}
+ 
+/* Номер начального слота - старшие биты мультипликативного хеша, отпечаток - 7 бит под ними */
+static size_t getHome(HashMap *map, LSQ_IntegerIndexT key) {
+    return (size_t) (((unsigned long long) (unsigned int) key * HASH_MULTIPLIER) >> map->shift);
+}
+ 
+static signed char getFingerprint(HashMap *map, LSQ_IntegerIndexT key) {
+    return (signed char) ((((unsigned long long) (unsigned int) key * HASH_MULTIPLIER) >> (map->shift - 7)) & 0x7F);
+}
+ 
+static void setControl(HashMap *map, size_t slot, signed char control) {
+    map->control[slot] = control;
+    if (slot < GROUP_SIZE)
+        map->control[map->mask + 1 + slot] = control;
+}
+ 
+/* Маска слотов группы, начатой с group, чей управляющий байт равен control: бит i - слот group + i. *
+ * Без SSE2 байты группы сравниваются по одному.                                                   */
+static unsigned int matchGroup(const signed char *group, signed char control) {
+#ifdef __SSE2__
+    __m128i bytes = _mm_loadu_si128((const __m128i *) group);
+    return (unsigned int) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(control)));
+#else
+    unsigned int mask = 0;
+    for (int i = 0; i < GROUP_SIZE; i++)
+        mask |= (unsigned int) (group[i] == control) << i;
+    return mask;
+#endif
+}
+ 
+/* Совпадения отпечатка проверяются только до первого пустого слота группы: дальше цепочка не идет */
+static long findSlot(HashMap *map, LSQ_IntegerIndexT key) {
+    size_t position = getHome(map, key);
+    signed char fingerprint = getFingerprint(map, key);
+    for (;;) {
+        unsigned int matches = matchGroup(map->control + position, fingerprint);
+        unsigned int empties = matchGroup(map->control + position, CONTROL_EMPTY);
+        if (empties != 0)
+            matches &= (empties & -empties) - 1;
+        while (matches != 0) {
+            size_t slot = (position + __builtin_ctz(matches)) & map->mask;
+            if (map->slots[slot].key == key)
+                return (long) slot;
+            matches &= matches - 1;
+        }
+        if (empties != 0)
+            return -1;
+        position = (position + GROUP_SIZE) & map->mask;
+    }
+}
+ 
+static size_t findEmptySlot(HashMap *map, LSQ_IntegerIndexT key) {
+    size_t position = getHome(map, key);
+    for (;;) {
+        unsigned int empties = matchGroup(map->control + position, CONTROL_EMPTY);
+        if (empties != 0)
+            return (position + __builtin_ctz(empties)) & map->mask;
+        position = (position + GROUP_SIZE) & map->mask;
+    }
+}
+ 
+/* Первый занятый слот, начиная с from, или POSITION_PAST_REAR. Копия в хвосте управляющих байтов *
+ * может дать номер за концом таблицы - он тоже означает конец обхода.                            */
+static long nextOccupied(HashMap *map, long from) {
+    size_t capacity = map->mask + 1;
+    for (size_t position = (size_t) from; position < capacity; position += GROUP_SIZE) {
+        unsigned int occupied = ~matchGroup(map->control + position, CONTROL_EMPTY) & 0xFFFF;
+        if (occupied != 0) {
+            size_t slot = position + __builtin_ctz(occupied);
+            return (slot < capacity) ? (long) slot : POSITION_PAST_REAR;
+        }
+    }
+    return POSITION_PAST_REAR;
+}
+ 
+static long previousOccupied(HashMap *map, long from) {
+    for (long slot = from; slot >= 0; slot--)
+        if (map->control[slot] != CONTROL_EMPTY)
+            return slot;
+    return POSITION_BEFORE_FIRST;
+}
+ 
+static int grow(HashMap *map) {
+    HashMap oldMap = *map;
+    if (!allocateTable(map, 2 * (oldMap.mask + 1)))
+        return 0;
+    for (size_t slot = 0; slot <= oldMap.mask; slot++) {
+        if (oldMap.control[slot] == CONTROL_EMPTY)
+            continue;
+        LSQ_IntegerIndexT key = oldMap.slots[slot].key;
+        size_t emptySlot = findEmptySlot(map, key);
+        setControl(map, emptySlot, getFingerprint(map, key));
+        map->slots[emptySlot] = oldMap.slots[slot];
+    }
+    free(oldMap.control);
+    free(oldMap.slots);
+    return 1;
+}
+ 
+/* Обратный сдвиг: элемент за дыркой переносится в нее, если дырка не раньше его начального слота */
+static void deleteSlot(HashMap *map, size_t hole) {
+    size_t next = (hole + 1) & map->mask;
+    while (map->control[next] != CONTROL_EMPTY) {
+        size_t home = getHome(map, map->slots[next].key);
+        if (((next - home) & map->mask) >= ((next - hole) & map->mask)) {
+            map->slots[hole] = map->slots[next];
+            setControl(map, hole, map->control[next]);
+            hole = next;
+        }
+        next = (next + 1) & map->mask;
+    }
+    setControl(map, hole, CONTROL_EMPTY);
+    map->size--;
+}
@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <string.h>
+#include <ctype.h>
+//#include <conio.h>
+//#include <Windows.h>
+#include "linear_sequence_assoc.h"
+
+#define TEST { test_line = __LINE__; test_init(); } {
+#define ENDTEST } { test_teardown(); test_line = 0; }
+
+#define test_assert(expr) { test_line = __LINE__; test_assert_impl(expr); }
+#define test_assert_seq { test_line = __LINE__; } test_assert_seq_impl
+#define ITER_VAL(iter) (*LSQ_DereferenceIterator(iter))
+
+unsigned long R=0;
+#define Random(Max) ((R=(R*9301L+49267L)%233280L)%(long)Max)
+
+int test_line, depth;
+
+LSQ_HandleT seq;
+LSQ_IteratorT iter;
+
+void test_init()
+{
+    seq = LSQ_CreateSequence();
+}
+
+void test_teardown()
+{
+    LSQ_DestroySequence(seq);
+}
+
+void test_fail(){
+    char s;
+    printf("Test failed! Line %d\n", test_line);
+    scanf("%c",&s);
+    exit(0);
+}
+
+void test_assert_impl(int value){
+    if (!value) test_fail();
+}
+
+/* Порядок обхода не определен, поэтому проверяется совпадение множеств значений */
+void test_assert_seq_impl(LSQ_HandleT seq, int count, ...){
+    va_list vl;
+    LSQ_IteratorT it;
+    int i, expected[64], found[64] = {0};
+    if (LSQ_GetSize(seq) != count || count > 64) test_fail();
+    va_start(vl, count);
+    for (i = 0; i < count; i++)
+        expected[i] = va_arg(vl, int);
+    va_end(vl);
+    for (it = LSQ_GetFrontElement(seq); !LSQ_IsIteratorPastRear(it); LSQ_AdvanceOneElement(it)){
+        for (i = 0; i < count && (found[i] || expected[i] != *LSQ_DereferenceIterator(it)); i++)
+            ;
+        if (i == count) test_fail();
+        found[i] = 1;
+    }
+    LSQ_DestroyIterator(it);
+}
+
+void seq_push(LSQ_HandleT seq, int count, ...){
+    int i;
+    int k;
+    va_list vl;
+    va_start(vl, count);
+
+    for (i = 0; i < count; i++){
+        k = va_arg(vl, int);
+        LSQ_InsertElement(seq, k, k);
+    }
+
+    va_end(vl);
+}
+
+void dump(LSQ_HandleT seq)
+{
+    LSQ_IteratorT it;
+    for (it = LSQ_GetFrontElement(seq); !LSQ_IsIteratorPastRear(it); LSQ_AdvanceOneElement(it)){
+        printf("%d\n", *LSQ_DereferenceIterator(it));
+    }
+    LSQ_DestroyIterator(it);
+}
+
+
+int main()
+{
+    int i, count;
+
+    TEST
+        test_assert(LSQ_GetSize(seq) == 0);
+        LSQ_InsertElement(seq, 2, 2);
+        test_assert_seq(seq, 1, 2);
+
+        LSQ_InsertElement(seq, 1, 1);
+        LSQ_InsertElement(seq, 3, 3);
+        test_assert_seq(seq, 3, 1, 2, 3);
+
+        LSQ_InsertElement(seq, 3, 30);
+        test_assert_seq(seq, 3, 1, 2, 30);
+    ENDTEST
+
+    TEST
+        seq_push(seq, 7, 7, 8, 3, 5, 4, 2, 9);
+        LSQ_DeleteElement(seq, 4);
+        LSQ_DeleteElement(seq, 100);
+        test_assert_seq(seq, 6, 7, 8, 3, 5, 2, 9);
+
+        iter = LSQ_GetFrontElement(seq);
+        i = LSQ_GetIteratorKey(iter);
+        LSQ_DestroyIterator(iter);
+        LSQ_DeleteFrontElement(seq);
+        iter = LSQ_GetElementByIndex(seq, i);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+
+        iter = LSQ_GetPastRearElement(seq);
+        LSQ_RewindOneElement(iter);
+        i = LSQ_GetIteratorKey(iter);
+        LSQ_DestroyIterator(iter);
+        LSQ_DeleteRearElement(seq);
+        iter = LSQ_GetElementByIndex(seq, i);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        test_assert(LSQ_GetSize(seq) == 4);
+
+        while (LSQ_GetSize(seq) > 0)
+            LSQ_DeleteFrontElement(seq);
+        iter = LSQ_GetFrontElement(seq);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+    ENDTEST
+
+    TEST
+        seq_push(seq, 4, 0, 1, 2, 3);
+        iter = LSQ_GetFrontElement(seq);
+        for (count = 0; !LSQ_IsIteratorPastRear(iter); count++)
+            LSQ_AdvanceOneElement(iter);
+        test_assert(count == 4);
+        test_assert(LSQ_DereferenceIterator(iter) == NULL);
+
+        LSQ_ShiftPosition(iter, -4);
+        test_assert(LSQ_IsIteratorDereferencable(iter));
+        LSQ_RewindOneElement(iter);
+        test_assert(LSQ_IsIteratorBeforeFirst(iter));
+        LSQ_ShiftPosition(iter, -10);
+        test_assert(LSQ_IsIteratorBeforeFirst(iter));
+
+        LSQ_SetPosition(iter, 2);
+        test_assert(ITER_VAL(iter) == 2);
+        ITER_VAL(iter) = 20;
+        LSQ_SetPosition(iter, 5);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        test_assert_seq(seq, 4, 0, 1, 20, 3);
+    ENDTEST
+
+    TEST
+        for(i = 0; i < 10000; i++)
+            LSQ_InsertElement(seq, i * 64, i);
+        for(i = 0; i < 10000; i += 2)
+            LSQ_DeleteElement(seq, i * 64);
+        test_assert(LSQ_GetSize(seq) == 5000);
+        for(i = 0; i < 10000; i++) {
+            iter = LSQ_GetElementByIndex(seq, i * 64);
+            test_assert(i % 2 ? ITER_VAL(iter) == i : LSQ_IsIteratorPastRear(iter));
+            LSQ_DestroyIterator(iter);
+        }
+        for(iter = LSQ_GetFrontElement(seq), count = 0; !LSQ_IsIteratorPastRear(iter); LSQ_AdvanceOneElement(iter))
+            count++;
+        test_assert(count == 5000);
+        LSQ_DestroyIterator(iter);
+    ENDTEST
+
+    TEST
+        LSQ_DestroySequence(LSQ_HandleInvalid);
+        LSQ_GetSize(LSQ_HandleInvalid);
+        LSQ_IsIteratorDereferencable(LSQ_HandleInvalid);
+        LSQ_IsIteratorPastRear(LSQ_HandleInvalid);
+        LSQ_IsIteratorBeforeFirst(LSQ_HandleInvalid);
+        LSQ_DereferenceIterator(LSQ_HandleInvalid);
+        test_assert(LSQ_GetElementByIndex(LSQ_HandleInvalid, 0) == LSQ_HandleInvalid);
+        test_assert(LSQ_GetFrontElement(LSQ_HandleInvalid) == LSQ_HandleInvalid);
+        test_assert(LSQ_GetPastRearElement(LSQ_HandleInvalid) == LSQ_HandleInvalid);
+        LSQ_InsertElement(LSQ_HandleInvalid, 0, 0);
+        LSQ_DeleteFrontElement(LSQ_HandleInvalid);
+        LSQ_DeleteRearElement(LSQ_HandleInvalid);
+        LSQ_DeleteElement(LSQ_HandleInvalid, 0);
+    ENDTEST
+
+    TEST
+        LSQ_MemoryUsageT usage, total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 100; i++)
+            LSQ_InsertElement(other, i, i);
+        LSQ_GetMemoryUsage(other, &usage);
+        test_assert(usage.payload == 100 * (sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT)));
+        test_assert(usage.slack == 28 * (sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT)) && usage.overhead >= 128);
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequence(other);
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == usage.payload && total.overhead - reduced.overhead == usage.overhead);
+        test_assert(total.slack - reduced.slack == usage.slack);
+    ENDTEST
+
+    printf("All tests passed!\n");
+}
@@ -0,0 +1,63 @@
+#ifndef INSTRUMENTATION_H
+#define INSTRUMENTATION_H
+
+#include <stdatomic.h>
+
+/* Общие для всех контейнеров макросы счетчиков, замеров и списка живых контейнеров. Подключается *
+ * из исходного файла контейнера после заголовка с интерфейсом и описания структуры контейнера.   */
+
+/* Счетчики ведутся только при сборке с LSQ_STATS: иначе поля stats нет, а STATS_ADD не порождает кода */
+#ifdef LSQ_STATS
+#define STATS_ADD(container, counter, amount) ((container)->stats.counter += (amount))
+#else
+#define STATS_ADD(container, counter, amount) ((void) 0)
+#endif
+
+/* Замеры ведутся только при сборке с LSQ_LATENCY и только для контейнеров, которым назначен профиль: *
+ * LATENCY открывает замер до конца функции, без LSQ_LATENCY он не порождает кода.                    */
+#ifdef LSQ_LATENCY
+#include "latency.h"
+#define LATENCY(container, operation) LATENCY_SCOPE((container)->latency, operation)
+#else
+#define LATENCY(container, operation) ((void) 0)
+#endif
+
+/* Живые контейнеры процесса для LSQ_GetTotalMemoryUsage. Список защищен спин-блокировкой, так как   *
+ * контейнеры разных потоков создаются и уничтожаются независимо. LIVE_CONTAINERS(Type) определяет    *
+ * в файле контейнера список liveContainers и функции lockLiveContainers, unlockLiveContainers,       *
+ * registerContainer и unregisterContainer; соседи в списке хранятся в полях nextLive и prevLive Type. */
+#define LIVE_CONTAINERS(Type)                                                          \
+    static Type *liveContainers = LSQ_HandleInvalid;                                   \
+    static atomic_flag liveContainersLock = ATOMIC_FLAG_INIT;                          \
+                                                                                       \
+    static void lockLiveContainers(void) {                                             \
+        while (atomic_flag_test_and_set_explicit(&liveContainersLock, memory_order_acquire)) \
+            ;                                                                          \
+    }                                                                                  \
+                                                                                       \
+    static void unlockLiveContainers(void) {                                           \
+        atomic_flag_clear_explicit(&liveContainersLock, memory_order_release);         \
+    }                                                                                  \
+                                                                                       \
+    static void registerContainer(Type *container) {                                   \
+        lockLiveContainers();                                                          \
+        container->prevLive = LSQ_HandleInvalid;                                       \
+        container->nextLive = liveContainers;                                          \
+        if (liveContainers != LSQ_HandleInvalid)                                       \
+            liveContainers->prevLive = container;                                      \
+        liveContainers = container;                                                    \
+        unlockLiveContainers();                                                        \
+    }                                                                                  \
+                                                                                       \
+    static void unregisterContainer(Type *container) {                                 \
+        lockLiveContainers();                                                          \
+        if (container->prevLive != LSQ_HandleInvalid)                                  \
+            container->prevLive->nextLive = container->nextLive;                       \
+        else                                                                           \
+            liveContainers = container->nextLive;                                      \
+        if (container->nextLive != LSQ_HandleInvalid)                                  \
+            container->nextLive->prevLive = container->prevLive;                       \
+        unlockLiveContainers();                                                        \
+    }
+
+#endif
@@ -0,0 +1,115 @@
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "latency.h"
+
+#define CALIBRATION_NANOSECONDS 20000000LL
+
+static const char *operationNames[LATENCY_OPERATION_COUNT] = {
+    "DestroySequence",
+    "GetElementByIndex",
+    "GetFrontElement",
+    "GetPastRearElement",
+    "AdvanceOneElement",
+    "RewindOneElement",
+    "ShiftPosition",
+    "SetPosition",
+    "InsertFrontElement",
+    "InsertRearElement",
+    "InsertElementBeforeGiven",
+    "InsertElement",
+    "DeleteFrontElement",
+    "DeleteRearElement",
+    "DeleteGivenElement",
+    "DeleteElement"
+};
+
+static double nanosecondsPerTick = 0;
+
+static long long monotonicNanoseconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long) now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+/* Последнее значение корзины: корзина index покрывает [lower, lower + width) */
+static unsigned long long bucketUpperBound(int index) {
+    if (index < 2 * LATENCY_SUB_BUCKETS)
+        return (unsigned long long) index;
+    int shift = index / LATENCY_SUB_BUCKETS - 1;
+    unsigned long long lower = (unsigned long long) (index % LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS) << shift;
+    return lower + ((1ULL << shift) - 1);
+}
+
+LatencyProfile *latencyCreateProfile(void) {
+    return (LatencyProfile *) calloc(1, sizeof(LatencyProfile));
+}
+
+void latencyDestroyProfile(LatencyProfile *profile) {
+    free(profile);
+}
+
+void latencyReset(LatencyProfile *profile) {
+    if (profile != NULL)
+        memset(profile, 0, sizeof(LatencyProfile));
+}
+
+unsigned long long latencyPercentile(const LatencyHistogram *histogram, double quantile) {
+    if (histogram == NULL || histogram->count == 0)
+        return 0;
+    unsigned long long rank = (unsigned long long) (quantile * (double) histogram->count);
+    if ((double) rank < quantile * (double) histogram->count)
+        rank++;
+    if (rank == 0)
+        rank = 1;
+    if (rank >= histogram->count)
+        return histogram->max;
+    unsigned long long seen = 0;
+    for (int i = 0; i < LATENCY_BUCKET_COUNT; i++) {
+        seen += histogram->counts[i];
+        if (seen >= rank) {
+            unsigned long long upper = bucketUpperBound(i);
+            return (upper < histogram->max) ? upper : histogram->max;
+        }
+    }
+    return histogram->max;
+}
+
+/* Частота счетчика тактов измеряется по монотонным часам на отрезке в 20 мс */
+double latencyNanosecondsPerTick(void) {
+    if (nanosecondsPerTick != 0)
+        return nanosecondsPerTick;
+#if defined(__x86_64__) || defined(__i386__)
+    long long startTime = monotonicNanoseconds();
+    unsigned long long startTicks = latencyNow();
+    long long elapsed;
+    while ((elapsed = monotonicNanoseconds() - startTime) < CALIBRATION_NANOSECONDS)
+        ;
+    unsigned long long ticks = latencyNow() - startTicks;
+    nanosecondsPerTick = (ticks != 0) ? (double) elapsed / (double) ticks : 1;
+#else
+    nanosecondsPerTick = 1;
+#endif
+    return nanosecondsPerTick;
+}
+
+const char *latencyOperationName(LatencyOperation operation) {
+    if (operation < 0 || operation >= LATENCY_OPERATION_COUNT)
+        return "unknown";
+    return operationNames[operation];
+}
+
+void latencyDump(const LatencyProfile *profile, FILE *out) {
+    if (profile == NULL || out == NULL)
+        return;
+    double scale = latencyNanosecondsPerTick();
+    fprintf(out, "%-26s %12s %12s %12s %12s %12s\n", "operation", "count", "p50 ns", "p99 ns", "p99.9 ns", "max ns");
+    for (int i = 0; i < LATENCY_OPERATION_COUNT; i++) {
+        const LatencyHistogram *histogram = &profile->histograms[i];
+        if (histogram->count == 0)
+            continue;
+        fprintf(out, "%-26s %12llu %12.1f %12.1f %12.1f %12.1f\n", operationNames[i], histogram->count,
+                (double) latencyPercentile(histogram, 0.5) * scale, (double) latencyPercentile(histogram, 0.99) * scale,
+                (double) latencyPercentile(histogram, 0.999) * scale, (double) histogram->max * scale);
+    }
+}
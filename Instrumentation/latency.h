@@ -0,0 +1,124 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <stdio.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+/* Гистограмма с логарифмическими корзинами, как в HDR Histogram: каждая степень двойки делится на          *
+ * LATENCY_SUB_BUCKETS равных корзин, так что значение хранится с относительной ошибкой не больше 1/16,   *
+ * а значения меньше 2 * LATENCY_SUB_BUCKETS - точно. Весь 64-битный диапазон занимает 976 корзин.        */
+#define LATENCY_SUB_BITS 4
+#define LATENCY_SUB_BUCKETS (1 << LATENCY_SUB_BITS)
+#define LATENCY_BUCKET_COUNT ((64 - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS + LATENCY_SUB_BUCKETS)
+
+/* Замеряемые точки входа всех контейнеров. Тривиальные проверки итератора и разыменование не замеряются: *
+ * их стоимость сравнима с самим замером.                                                                */
+typedef enum {
+    LATENCY_DESTROY_SEQUENCE,
+    LATENCY_GET_ELEMENT_BY_INDEX,
+    LATENCY_GET_FRONT_ELEMENT,
+    LATENCY_GET_PAST_REAR_ELEMENT,
+    LATENCY_ADVANCE_ONE_ELEMENT,
+    LATENCY_REWIND_ONE_ELEMENT,
+    LATENCY_SHIFT_POSITION,
+    LATENCY_SET_POSITION,
+    LATENCY_INSERT_FRONT_ELEMENT,
+    LATENCY_INSERT_REAR_ELEMENT,
+    LATENCY_INSERT_ELEMENT_BEFORE_GIVEN,
+    LATENCY_INSERT_ELEMENT,
+    LATENCY_DELETE_FRONT_ELEMENT,
+    LATENCY_DELETE_REAR_ELEMENT,
+    LATENCY_DELETE_GIVEN_ELEMENT,
+    LATENCY_DELETE_ELEMENT,
+    LATENCY_OPERATION_COUNT
+} LatencyOperation;
+
+/* Значения - в тактах счетчика latencyNow */
+typedef struct {
+    unsigned long long counts[LATENCY_BUCKET_COUNT];
+    unsigned long long count;
+    unsigned long long max;
+} LatencyHistogram;
+
+/* Профиль принадлежит вызывающему и может быть общим для нескольких контейнеров одного потока. Он живет  *
+ * дольше контейнера, поэтому в него попадает и время LSQ_DestroySequence. nesting отсекает вложенные     *
+ * вызовы: время операции, вызвавшей другую точку входа, записывается один раз - во внешнюю операцию.     */
+typedef struct LatencyProfile_ {
+    LatencyHistogram histograms[LATENCY_OPERATION_COUNT];
+    int nesting;
+} LatencyProfile;
+
+/* Открытый замер. profile равен NULL, если замер не ведется */
+typedef struct {
+    LatencyProfile *profile;
+    LatencyHistogram *histogram;
+    unsigned long long start;
+} LatencyScope;
+
+/* Функция, создающая пустой профиль. Возвращает NULL, если не хватило памяти */
+extern LatencyProfile *latencyCreateProfile(void);
+/* Функция, уничтожающая профиль */
+extern void latencyDestroyProfile(LatencyProfile *profile);
+/* Функция, обнуляющая все гистограммы профиля */
+extern void latencyReset(LatencyProfile *profile);
+/* Функция, возвращающая значение заданного квантиля (0 < quantile <= 1) в тактах: верхнюю границу     *
+ * корзины, в которую он попал, но не больше максимума. Для пустой гистограммы - 0.                     */
+extern unsigned long long latencyPercentile(const LatencyHistogram *histogram, double quantile);
+/* Функция, возвращающая число наносекунд в одном такте latencyNow. Первый вызов калибрует счетчик */
+extern double latencyNanosecondsPerTick(void);
+/* Функция, возвращающая имя операции */
+extern const char *latencyOperationName(LatencyOperation operation);
+/* Функция, печатающая p50, p99, p99.9 и максимум в наносекундах для каждой замеренной операции */
+extern void latencyDump(const LatencyProfile *profile, FILE *out);
+
+/* Счетчик тактов процессора; там, где его нет, - монотонные часы в наносекундах */
+static inline unsigned long long latencyNow(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned long long) now.tv_sec * 1000000000ULL + (unsigned long long) now.tv_nsec;
+#endif
+}
+
+static inline int latencyBucket(unsigned long long value) {
+    if (value < 2 * LATENCY_SUB_BUCKETS)
+        return (int) value;
+    int exponent = 63 - __builtin_clzll(value);
+    return (exponent - LATENCY_SUB_BITS) * LATENCY_SUB_BUCKETS + (int) (value >> (exponent - LATENCY_SUB_BITS));
+}
+
+static inline void latencyRecord(LatencyHistogram *histogram, unsigned long long ticks) {
+    histogram->counts[latencyBucket(ticks)]++;
+    histogram->count++;
+    if (ticks > histogram->max)
+        histogram->max = ticks;
+}
+
+static inline LatencyScope latencyBegin(LatencyProfile *profile, LatencyOperation operation) {
+    LatencyScope scope = {NULL, NULL, 0};
+    if (profile != NULL && profile->nesting == 0) {
+        profile->nesting = 1;
+        scope.profile = profile;
+        scope.histogram = &profile->histograms[operation];
+        scope.start = latencyNow();
+    }
+    return scope;
+}
+
+static inline void latencyEnd(LatencyScope *scope) {
+    if (scope->profile == NULL)
+        return;
+    latencyRecord(scope->histogram, latencyNow() - scope->start);
+    scope->profile->nesting = 0;
+}
+
+/* Замер до конца охватывающего блока: latencyEnd вызывается при любом выходе из него, включая return */
+#define LATENCY_SCOPE(profile, operation) \
+    LatencyScope latencyScope __attribute__((cleanup(latencyEnd))) = latencyBegin((profile), (operation))
+
+#endif
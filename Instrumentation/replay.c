@@ -0,0 +1,389 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "latency.h"
+#include "trace.h"
+
+/* Воспроизведение трассы, снятой trace_record.c. Собирается с каждым контейнером (см. makefile),    *
+ * контейнеры с интерфейсом linear_sequence_assoc.h - с REPLAY_ASSOCIATIVE. Трасса сначала целиком    *
+ * разбирается в память, так что в замер попадают только вызовы контейнера.                           *
+ * Совпадение контрольных сумм говорит об одинаковом поведении, только если у контейнеров одинаков     *
+ * смысл всех вызовов трассы. LSQ_SetPosition у Tree сдвигает итератор на pos шагов от BeforeFirst,    *
+ * а остальные ассоциативные контейнеры ищут ключ pos, так что трассы с SetPosition дают у Tree        *
+ * другую сумму.                                                                                      */
+#ifdef REPLAY_ASSOCIATIVE
+#include "linear_sequence_assoc.h"
+#else
+#include "linear_sequence.h"
+#endif
+
+#ifndef REPLAY_CONTAINER
+#define REPLAY_CONTAINER "unknown"
+#endif
+
+#define DEFAULT_REPEAT 5
+#define OBJECT_NONE 0
+#define OBJECT_HANDLE 1
+#define OBJECT_ITERATOR 2
+
+/* Аргументы операций: o - номер объекта, i - знаковое число, n - номер созданного объекта */
+static const char *operationArguments[TRACE_OPERATION_COUNT] = {
+    "n", "o", "o", "o", "o", "o", "o", "o", "oin", "on", "on", "o",
+    "o", "o", "oi", "oi", "oi", "oi", "oi", "oii", "o", "o", "o", "oi"
+};
+
+static const char *operationNames[TRACE_OPERATION_COUNT] = {
+    "CreateSequence", "DestroySequence", "GetSize", "IsIteratorDereferencable", "IsIteratorPastRear",
+    "IsIteratorBeforeFirst", "DereferenceIterator", "GetIteratorKey", "GetElementByIndex", "GetFrontElement",
+    "GetPastRearElement", "DestroyIterator", "AdvanceOneElement", "RewindOneElement", "ShiftPosition",
+    "SetPosition", "InsertFrontElement", "InsertRearElement", "InsertElementBeforeGiven", "InsertElement",
+    "DeleteFrontElement", "DeleteRearElement", "DeleteGivenElement", "DeleteElement"
+};
+
+/* object - номер аргумента-объекта, для CreateSequence - номер созданного контейнера */
+typedef struct {
+    unsigned char operation;
+    unsigned int object;
+    unsigned int result;
+    LSQ_IntegerIndexT first;
+    LSQ_IntegerIndexT second;
+} Record;
+
+typedef struct {
+    Record *records;
+    size_t count;
+    unsigned int objectCount;
+} Trace;
+
+typedef struct {
+    const unsigned char *data;
+    size_t size;
+    size_t position;
+} Reader;
+
+/* Сумма всех результатов, прочитанных трассой: у правильных контейнеров она совпадает */
+static volatile long long sink;
+
+static int readUnsigned(Reader *reader, unsigned int *value) {
+    unsigned int result = 0;
+    for (int shift = 0; shift < 35; shift += 7) {
+        if (reader->position == reader->size)
+            return 0;
+        unsigned char byte = reader->data[reader->position++];
+        result |= (unsigned int) (byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+static int readSigned(Reader *reader, LSQ_IntegerIndexT *value) {
+    unsigned int encoded;
+    if (!readUnsigned(reader, &encoded))
+        return 0;
+    *value = (LSQ_IntegerIndexT) ((encoded >> 1) ^ -(encoded & 1));
+    return 1;
+}
+
+/* Операции, которых нет в интерфейсе этой сборки */
+static int isSupported(TraceOperation operation) {
+#ifdef REPLAY_ASSOCIATIVE
+    return operation != TRACE_INSERT_FRONT_ELEMENT && operation != TRACE_INSERT_REAR_ELEMENT
+           && operation != TRACE_INSERT_ELEMENT_BEFORE_GIVEN && operation != TRACE_DELETE_GIVEN_ELEMENT;
+#else
+    return operation != TRACE_GET_ITERATOR_KEY && operation != TRACE_INSERT_ELEMENT
+           && operation != TRACE_DELETE_ELEMENT;
+#endif
+}
+
+static unsigned char *readFile(const char *path, size_t *size) {
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+    size_t capacity = 1 << 16;
+    unsigned char *data = (unsigned char *) malloc(capacity);
+    *size = 0;
+    while (data != NULL) {
+        *size += fread(data + *size, 1, capacity - *size, file);
+        if (*size < capacity)
+            break;
+        unsigned char *grown = (unsigned char *) realloc(data, capacity * 2);
+        if (grown == NULL) {
+            free(data);
+            data = NULL;
+            break;
+        }
+        data = grown;
+        capacity *= 2;
+    }
+    fclose(file);
+    return data;
+}
+
+/* Возвращает сообщение об ошибке или NULL */
+static const char *parseTrace(const unsigned char *data, size_t size, Trace *trace) {
+    if (size < TRACE_MAGIC_SIZE + 2 || memcmp(data, TRACE_MAGIC, TRACE_MAGIC_SIZE) != 0)
+        return "not a trace file";
+    if (data[TRACE_MAGIC_SIZE] != TRACE_VERSION)
+        return "unsupported trace version";
+#ifdef REPLAY_ASSOCIATIVE
+    if ((data[TRACE_MAGIC_SIZE + 1] & TRACE_FLAG_ASSOCIATIVE) == 0)
+        return "trace was recorded from linear_sequence.h, this replay is built for linear_sequence_assoc.h";
+#else
+    if ((data[TRACE_MAGIC_SIZE + 1] & TRACE_FLAG_ASSOCIATIVE) != 0)
+        return "trace was recorded from linear_sequence_assoc.h, this replay is built for linear_sequence.h";
+#endif
+    Reader reader = {data, size, TRACE_MAGIC_SIZE + 2};
+    size_t capacity = 1024;
+    trace->records = (Record *) malloc(capacity * sizeof(Record));
+    trace->count = 0;
+    trace->objectCount = 1;
+    while (reader.position < reader.size) {
+        if (trace->records == NULL)
+            return "out of memory";
+        if (trace->count == capacity) {
+            Record *grown = (Record *) realloc(trace->records, capacity * 2 * sizeof(Record));
+            if (grown == NULL)
+                return "out of memory";
+            trace->records = grown;
+            capacity *= 2;
+        }
+        Record *record = &trace->records[trace->count];
+        memset(record, 0, sizeof(Record));
+        record->operation = reader.data[reader.position++];
+        if (record->operation >= TRACE_OPERATION_COUNT)
+            return "unknown operation code";
+        if (!isSupported((TraceOperation) record->operation))
+            return "operation is not part of this interface";
+        int signedCount = 0;
+        for (const char *argument = operationArguments[record->operation]; *argument != '\0'; argument++) {
+            int ok;
+            if (*argument == 'i')
+                ok = readSigned(&reader, (signedCount++ == 0) ? &record->first : &record->second);
+            else
+                ok = readUnsigned(&reader, (*argument == 'o' || record->operation == TRACE_CREATE_SEQUENCE)
+                                           ? &record->object : &record->result);
+            if (!ok)
+                return "truncated record";
+        }
+        if (record->object >= trace->objectCount)
+            trace->objectCount = record->object + 1;
+        if (record->result >= trace->objectCount)
+            trace->objectCount = record->result + 1;
+        trace->count++;
+    }
+    return NULL;
+}
+
+/* Объект, который при записи не создался (номер 0), уничтожается сразу: 0 должен остаться LSQ_HandleInvalid */
+static void storeObject(void **objects, unsigned char *kinds, unsigned int id, void *object, unsigned char kind) {
+    if (id != 0) {
+        objects[id] = object;
+        kinds[id] = kind;
+    }
+    else if (object != LSQ_HandleInvalid && kind == OBJECT_ITERATOR)
+        LSQ_DestroyIterator(object);
+    else if (object != LSQ_HandleInvalid)
+        LSQ_DestroySequence(object);
+}
+
+static void replayRecord(const Record *record, void **objects, unsigned char *kinds) {
+    void *object = objects[record->object];
+    switch ((TraceOperation) record->operation) {
+    case TRACE_CREATE_SEQUENCE:
+        storeObject(objects, kinds, record->object, LSQ_CreateSequence(), OBJECT_HANDLE);
+        return;
+    case TRACE_DESTROY_SEQUENCE:
+        LSQ_DestroySequence(object);
+        kinds[record->object] = OBJECT_NONE;
+        objects[record->object] = LSQ_HandleInvalid;
+        return;
+    case TRACE_GET_SIZE:
+        sink += LSQ_GetSize(object);
+        return;
+    case TRACE_IS_ITERATOR_DEREFERENCABLE:
+        sink += LSQ_IsIteratorDereferencable(object);
+        return;
+    case TRACE_IS_ITERATOR_PAST_REAR:
+        sink += LSQ_IsIteratorPastRear(object);
+        return;
+    case TRACE_IS_ITERATOR_BEFORE_FIRST:
+        sink += LSQ_IsIteratorBeforeFirst(object);
+        return;
+    case TRACE_DEREFERENCE_ITERATOR: {
+        LSQ_BaseTypeT *value = LSQ_DereferenceIterator(object);
+        if (value != LSQ_HandleInvalid)
+            sink += *value;
+        return;
+    }
+    case TRACE_GET_ELEMENT_BY_INDEX:
+        storeObject(objects, kinds, record->result, LSQ_GetElementByIndex(object, record->first), OBJECT_ITERATOR);
+        return;
+    case TRACE_GET_FRONT_ELEMENT:
+        storeObject(objects, kinds, record->result, LSQ_GetFrontElement(object), OBJECT_ITERATOR);
+        return;
+    case TRACE_GET_PAST_REAR_ELEMENT:
+        storeObject(objects, kinds, record->result, LSQ_GetPastRearElement(object), OBJECT_ITERATOR);
+        return;
+    case TRACE_DESTROY_ITERATOR:
+        LSQ_DestroyIterator(object);
+        kinds[record->object] = OBJECT_NONE;
+        objects[record->object] = LSQ_HandleInvalid;
+        return;
+    case TRACE_ADVANCE_ONE_ELEMENT:
+        LSQ_AdvanceOneElement(object);
+        return;
+    case TRACE_REWIND_ONE_ELEMENT:
+        LSQ_RewindOneElement(object);
+        return;
+    case TRACE_SHIFT_POSITION:
+        LSQ_ShiftPosition(object, record->first);
+        return;
+    case TRACE_SET_POSITION:
+        LSQ_SetPosition(object, record->first);
+        return;
+    case TRACE_DELETE_FRONT_ELEMENT:
+        LSQ_DeleteFrontElement(object);
+        return;
+    case TRACE_DELETE_REAR_ELEMENT:
+        LSQ_DeleteRearElement(object);
+        return;
+#ifdef REPLAY_ASSOCIATIVE
+    case TRACE_GET_ITERATOR_KEY:
+        sink += LSQ_GetIteratorKey(object);
+        return;
+    case TRACE_INSERT_ELEMENT:
+        LSQ_InsertElement(object, record->first, record->second);
+        return;
+    case TRACE_DELETE_ELEMENT:
+        LSQ_DeleteElement(object, record->first);
+        return;
+#else
+    case TRACE_INSERT_FRONT_ELEMENT:
+        LSQ_InsertFrontElement(object, record->first);
+        return;
+    case TRACE_INSERT_REAR_ELEMENT:
+        LSQ_InsertRearElement(object, record->first);
+        return;
+    case TRACE_INSERT_ELEMENT_BEFORE_GIVEN:
+        LSQ_InsertElementBeforeGiven(object, record->first);
+        return;
+    case TRACE_DELETE_GIVEN_ELEMENT:
+        LSQ_DeleteGivenElement(object);
+        return;
+#endif
+    default:
+        return;
+    }
+}
+
+/* Объекты, которые программа не уничтожила до конца трассы, освобождаются вне замера: сначала итераторы */
+static void releaseObjects(const Trace *trace, void **objects, unsigned char *kinds) {
+    for (unsigned int i = 0; i < trace->objectCount; i++)
+        if (kinds[i] == OBJECT_ITERATOR)
+            LSQ_DestroyIterator(objects[i]);
+    for (unsigned int i = 0; i < trace->objectCount; i++)
+        if (kinds[i] == OBJECT_HANDLE)
+            LSQ_DestroySequence(objects[i]);
+    memset(objects, 0, trace->objectCount * sizeof(void *));
+    memset(kinds, 0, trace->objectCount);
+}
+
+static double seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+static int compareDoubles(const void *first, const void *second) {
+    double a = *(const double *) first, b = *(const double *) second;
+    return (a > b) - (a < b);
+}
+
+/* Отдельный прогон с замером каждой операции: счетчик тактов добавляет свою стоимость, поэтому общее *
+ * время берется только из прогонов без разбивки.                                                      */
+static void printBreakdown(const Trace *trace, void **objects, unsigned char *kinds) {
+    unsigned long long ticks[TRACE_OPERATION_COUNT] = {0};
+    size_t counts[TRACE_OPERATION_COUNT] = {0};
+    for (size_t i = 0; i < trace->count; i++) {
+        const Record *record = &trace->records[i];
+        unsigned long long start = latencyNow();
+        replayRecord(record, objects, kinds);
+        ticks[record->operation] += latencyNow() - start;
+        counts[record->operation]++;
+    }
+    releaseObjects(trace, objects, kinds);
+    double scale = latencyNanosecondsPerTick();
+    printf("%-26s %12s %12s %10s\n", "operation", "count", "total ms", "ns/op");
+    for (int i = 0; i < TRACE_OPERATION_COUNT; i++)
+        if (counts[i] > 0)
+            printf("%-26s %12zu %12.3f %10.1f\n", operationNames[i], counts[i], (double) ticks[i] * scale * 1e-6,
+                   (double) ticks[i] * scale / (double) counts[i]);
+}
+
+int main(int argc, char *argv[]) {
+    int repeat = DEFAULT_REPEAT, breakdown = 0;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--breakdown") == 0)
+            breakdown = 1;
+        else if (argv[i][0] != '-' && path == NULL)
+            path = argv[i];
+        else
+            path = NULL, i = argc;
+    }
+    if (path == NULL || repeat < 1) {
+        fprintf(stderr, "usage: %s [--repeat N] [--breakdown] trace\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    size_t size;
+    unsigned char *data = readFile(path, &size);
+    if (data == NULL) {
+        fprintf(stderr, "%s: cannot read %s\n", argv[0], path);
+        return EXIT_FAILURE;
+    }
+    Trace trace;
+    const char *error = parseTrace(data, size, &trace);
+    free(data);
+    if (error != NULL) {
+        fprintf(stderr, "%s: %s: %s\n", argv[0], path, error);
+        return EXIT_FAILURE;
+    }
+    void **objects = (void **) calloc(trace.objectCount, sizeof(void *));
+    unsigned char *kinds = (unsigned char *) calloc(trace.objectCount, 1);
+    double *times = (double *) malloc(repeat * sizeof(double));
+    if (objects == NULL || kinds == NULL || times == NULL) {
+        fprintf(stderr, "%s: out of memory\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    long long checksum = 0;
+    for (int run = 0; run < repeat; run++) {
+        sink = 0;
+        double start = seconds();
+        for (size_t i = 0; i < trace.count; i++)
+            replayRecord(&trace.records[i], objects, kinds);
+        times[run] = seconds() - start;
+        checksum = sink;
+        releaseObjects(&trace, objects, kinds);
+    }
+    qsort(times, repeat, sizeof(double), compareDoubles);
+    printf("%s: %s, %zu operations, %d runs\n", REPLAY_CONTAINER, path, trace.count, repeat);
+    printf("total ms: min %.3f, median %.3f, max %.3f; %.1f ns per operation\n", times[0] * 1e3,
+           times[repeat / 2] * 1e3, times[repeat - 1] * 1e3, times[0] * 1e9 / (double) (trace.count ? trace.count : 1));
+    printf("checksum %lld\n", checksum);
+    if (breakdown)
+        printBreakdown(&trace, objects, kinds);
+
+    free(times);
+    free(kinds);
+    free(objects);
+    free(trace.records);
+    return EXIT_SUCCESS;
+}
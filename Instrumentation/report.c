@@ -0,0 +1,113 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include "latency.h"
+
+/* Отчет о хвостовых задержках: типичная нагрузка прогоняется на контейнере, собранном с LSQ_LATENCY, *
+ * и печатаются квантили по каждой точке входа. Контейнеры с интерфейсом linear_sequence_assoc.h     *
+ * собираются с REPORT_ASSOCIATIVE (см. makefile).                                                    */
+#ifdef REPORT_ASSOCIATIVE
+#include "linear_sequence_assoc.h"
+#else
+#include "linear_sequence.h"
+#endif
+
+#ifndef REPORT_CONTAINER
+#define REPORT_CONTAINER "unknown"
+#endif
+
+#define DEFAULT_SIZE 100000
+#define DESTROY_ROUNDS 16
+#define OVERHEAD_OPERATIONS 1000000
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int nextRandom(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int) (seed >> 32);
+}
+
+static double seconds(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (double) now.tv_sec + (double) now.tv_nsec * 1e-9;
+}
+
+static void fill(LSQ_HandleT handle, LSQ_IntegerIndexT size) {
+    for (LSQ_IntegerIndexT i = 0; i < size; i++) {
+#ifdef REPORT_ASSOCIATIVE
+        LSQ_InsertElement(handle, (LSQ_IntegerIndexT) (nextRandom() % (4u * (unsigned int) size)), i);
+#else
+        LSQ_InsertRearElement(handle, i);
+#endif
+    }
+}
+
+/* Стоимость одного замера: разность времени одних и тех же дешевых вставок в конец с профилем и без него */
+static double recordingOverhead(LatencyProfile *profile) {
+    double elapsed[2];
+    for (int pass = 0; pass < 2; pass++) {
+        LSQ_HandleT handle = LSQ_CreateSequence();
+        LSQ_SetLatencyProfile(handle, pass ? profile : NULL);
+        double start = seconds();
+        for (LSQ_IntegerIndexT i = 0; i < OVERHEAD_OPERATIONS; i++) {
+#ifdef REPORT_ASSOCIATIVE
+            LSQ_InsertElement(handle, i, i);
+#else
+            LSQ_InsertRearElement(handle, i);
+#endif
+        }
+        elapsed[pass] = seconds() - start;
+        LSQ_SetLatencyProfile(handle, NULL);
+        LSQ_DestroySequence(handle);
+    }
+    return (elapsed[1] - elapsed[0]) / OVERHEAD_OPERATIONS * 1e9;
+}
+
+static void runWorkload(LatencyProfile *profile, LSQ_IntegerIndexT size) {
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    LSQ_SetLatencyProfile(handle, profile);
+    fill(handle, size);
+    for (LSQ_IntegerIndexT i = 0; i < size; i++) {
+        LSQ_IteratorT iterator = LSQ_GetElementByIndex(handle, (LSQ_IntegerIndexT) (nextRandom() % (unsigned int) size));
+        LSQ_AdvanceOneElement(iterator);
+        LSQ_DestroyIterator(iterator);
+    }
+#ifdef REPORT_ASSOCIATIVE
+    for (LSQ_IntegerIndexT i = 0; i < size / 2; i++)
+        LSQ_DeleteElement(handle, (LSQ_IntegerIndexT) (nextRandom() % (4u * (unsigned int) size)));
+#else
+    for (LSQ_IntegerIndexT i = 0; i < size / 100; i++)
+        LSQ_InsertFrontElement(handle, i);
+    for (LSQ_IntegerIndexT i = 0; i < size / 100; i++)
+        LSQ_DeleteFrontElement(handle);
+#endif
+    LSQ_DestroySequence(handle);
+
+    for (int round = 1; round < DESTROY_ROUNDS; round++) {
+        handle = LSQ_CreateSequence();
+        fill(handle, size / DESTROY_ROUNDS * round);
+        LSQ_SetLatencyProfile(handle, profile);
+        LSQ_DestroySequence(handle);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    LSQ_IntegerIndexT size = (argc > 1) ? atoi(argv[1]) : DEFAULT_SIZE;
+    if (size < DESTROY_ROUNDS) {
+        fprintf(stderr, "usage: %s [size >= %d]\n", argv[0], DESTROY_ROUNDS);
+        return EXIT_FAILURE;
+    }
+    LatencyProfile *profile = latencyCreateProfile();
+    if (profile == NULL)
+        return EXIT_FAILURE;
+    double overhead = recordingOverhead(profile);
+    latencyReset(profile);
+    runWorkload(profile, size);
+    printf("%s, size %d, %.1f ns per recording\n", REPORT_CONTAINER, size, overhead);
+    latencyDump(profile, stdout);
+    latencyDestroyProfile(profile);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,46 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+/* Формат трассы: TRACE_MAGIC, байт версии, байт флагов, затем записи - байт кода операции и ее аргументы  *
+ * в порядке объявления функции. Числа пишутся как varint (по 7 бит в байте, младшие вперед), знаковые -  *
+ * после zigzag-преобразования. Контейнеры и итераторы заменяются номерами из общего пространства, 0      *
+ * означает LSQ_HandleInvalid. Функция, создающая объект, записывает после аргументов номер результата;   *
+ * номера уничтоженных объектов используются повторно, так что массив объектов при воспроизведении мал.   */
+#define TRACE_MAGIC "LSQTRACE"
+#define TRACE_MAGIC_SIZE 8
+#define TRACE_VERSION 1
+/* Трасса снята с интерфейса linear_sequence_assoc.h, иначе - с linear_sequence.h */
+#define TRACE_FLAG_ASSOCIATIVE 1
+/* Наибольшая длина записи: код операции и три varint по 5 байт */
+#define TRACE_MAX_RECORD_SIZE 16
+
+/* В комментарии - аргументы записи; new - номер созданного объекта */
+typedef enum {
+    TRACE_CREATE_SEQUENCE,              /* new */
+    TRACE_DESTROY_SEQUENCE,             /* handle */
+    TRACE_GET_SIZE,                     /* handle */
+    TRACE_IS_ITERATOR_DEREFERENCABLE,   /* iterator */
+    TRACE_IS_ITERATOR_PAST_REAR,        /* iterator */
+    TRACE_IS_ITERATOR_BEFORE_FIRST,     /* iterator */
+    TRACE_DEREFERENCE_ITERATOR,         /* iterator */
+    TRACE_GET_ITERATOR_KEY,             /* iterator */
+    TRACE_GET_ELEMENT_BY_INDEX,         /* handle, index, new */
+    TRACE_GET_FRONT_ELEMENT,            /* handle, new */
+    TRACE_GET_PAST_REAR_ELEMENT,        /* handle, new */
+    TRACE_DESTROY_ITERATOR,             /* iterator */
+    TRACE_ADVANCE_ONE_ELEMENT,          /* iterator */
+    TRACE_REWIND_ONE_ELEMENT,           /* iterator */
+    TRACE_SHIFT_POSITION,               /* iterator, shift */
+    TRACE_SET_POSITION,                 /* iterator, pos */
+    TRACE_INSERT_FRONT_ELEMENT,         /* handle, element */
+    TRACE_INSERT_REAR_ELEMENT,          /* handle, element */
+    TRACE_INSERT_ELEMENT_BEFORE_GIVEN,  /* iterator, element */
+    TRACE_INSERT_ELEMENT,               /* handle, key, value */
+    TRACE_DELETE_FRONT_ELEMENT,         /* handle */
+    TRACE_DELETE_REAR_ELEMENT,          /* handle */
+    TRACE_DELETE_GIVEN_ELEMENT,         /* iterator */
+    TRACE_DELETE_ELEMENT,               /* handle, key */
+    TRACE_OPERATION_COUNT
+} TraceOperation;
+
+#endif
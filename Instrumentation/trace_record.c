@@ -0,0 +1,368 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#define TRACE_RECORD_IMPLEMENTATION
+#ifdef TRACE_ASSOCIATIVE
+#include "linear_sequence_assoc.h"
+#else
+#include "linear_sequence.h"
+#endif
+#include "trace.h"
+#include "trace_record.h"
+
+#define BUFFER_SIZE 65536
+#define OBJECT_TABLE_MIN_CAPACITY 64
+#define POINTER_MULTIPLIER 0x9E3779B97F4A7C15ULL
+#define TRACE_ENVIRONMENT "LSQ_TRACE"
+
+typedef struct {
+    void *pointer;
+    unsigned int id;
+} ObjectSlot;
+
+/* Номера живых объектов: таблица указатель -> номер с открытой адресацией и стек освобожденных номеров */
+static struct {
+    FILE *file;
+    unsigned char buffer[BUFFER_SIZE];
+    size_t used;
+    ObjectSlot *slots;
+    size_t mask;
+    size_t count;
+    unsigned int *freeIds;
+    size_t freeCount;
+    size_t freeCapacity;
+    unsigned int nextId;
+    int exitRegistered;
+    int environmentChecked;
+} recorder;
+
+static void flushBuffer(void);
+static void beginRecord(TraceOperation );
+static void putUnsigned(unsigned int );
+static void putSigned(int );
+static void recordObject(TraceOperation , void *);
+static void recordObjectValue(TraceOperation , void *, int );
+static size_t objectHome(void *);
+static unsigned int findObject(void *);
+static unsigned int addObject(void *);
+static void removeObject(void *);
+static int growObjectTable(void);
+
+int traceOpen(const char *path) {
+    traceClose();
+    recorder.file = fopen(path, "wb");
+    if (recorder.file == NULL)
+        return 0;
+    if (!recorder.exitRegistered && atexit(traceClose) == 0)
+        recorder.exitRegistered = 1;
+    memcpy(recorder.buffer, TRACE_MAGIC, TRACE_MAGIC_SIZE);
+    recorder.buffer[TRACE_MAGIC_SIZE] = TRACE_VERSION;
+#ifdef TRACE_ASSOCIATIVE
+    recorder.buffer[TRACE_MAGIC_SIZE + 1] = TRACE_FLAG_ASSOCIATIVE;
+#else
+    recorder.buffer[TRACE_MAGIC_SIZE + 1] = 0;
+#endif
+    recorder.used = TRACE_MAGIC_SIZE + 2;
+    recorder.nextId = 1;
+    return 1;
+}
+
+void traceClose(void) {
+    if (recorder.file != NULL) {
+        flushBuffer();
+        fclose(recorder.file);
+        recorder.file = NULL;
+    }
+    free(recorder.slots);
+    free(recorder.freeIds);
+    recorder.slots = NULL;
+    recorder.freeIds = NULL;
+    recorder.mask = recorder.count = recorder.freeCount = recorder.freeCapacity = 0;
+}
+
+/* Трассу можно включить без изменения программы: путь к файлу берется из LSQ_TRACE при первом создании */
+LSQ_HandleT traceCreateSequence(void) {
+    if (!recorder.environmentChecked) {
+        recorder.environmentChecked = 1;
+        const char *path = getenv(TRACE_ENVIRONMENT);
+        if (recorder.file == NULL && path != NULL && *path != '\0')
+            traceOpen(path);
+    }
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    if (recorder.file != NULL) {
+        unsigned int id = addObject(handle);
+        if (recorder.file != NULL) {
+            beginRecord(TRACE_CREATE_SEQUENCE);
+            putUnsigned(id);
+        }
+    }
+    return handle;
+}
+
+void traceDestroySequence(LSQ_HandleT handle) {
+    recordObject(TRACE_DESTROY_SEQUENCE, handle);
+    removeObject(handle);
+    LSQ_DestroySequence(handle);
+}
+
+LSQ_IntegerIndexT traceGetSize(LSQ_HandleT handle) {
+    recordObject(TRACE_GET_SIZE, handle);
+    return LSQ_GetSize(handle);
+}
+
+int traceIsIteratorDereferencable(LSQ_IteratorT iterator) {
+    recordObject(TRACE_IS_ITERATOR_DEREFERENCABLE, iterator);
+    return LSQ_IsIteratorDereferencable(iterator);
+}
+
+int traceIsIteratorPastRear(LSQ_IteratorT iterator) {
+    recordObject(TRACE_IS_ITERATOR_PAST_REAR, iterator);
+    return LSQ_IsIteratorPastRear(iterator);
+}
+
+int traceIsIteratorBeforeFirst(LSQ_IteratorT iterator) {
+    recordObject(TRACE_IS_ITERATOR_BEFORE_FIRST, iterator);
+    return LSQ_IsIteratorBeforeFirst(iterator);
+}
+
+LSQ_BaseTypeT* traceDereferenceIterator(LSQ_IteratorT iterator) {
+    recordObject(TRACE_DEREFERENCE_ITERATOR, iterator);
+    return LSQ_DereferenceIterator(iterator);
+}
+
+LSQ_IteratorT traceGetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index) {
+    LSQ_IteratorT iterator = LSQ_GetElementByIndex(handle, index);
+    if (recorder.file != NULL) {
+        unsigned int id = addObject(iterator);
+        if (recorder.file != NULL) {
+            recordObjectValue(TRACE_GET_ELEMENT_BY_INDEX, handle, index);
+            putUnsigned(id);
+        }
+    }
+    return iterator;
+}
+
+LSQ_IteratorT traceGetFrontElement(LSQ_HandleT handle) {
+    LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+    if (recorder.file != NULL) {
+        unsigned int id = addObject(iterator);
+        if (recorder.file != NULL) {
+            recordObject(TRACE_GET_FRONT_ELEMENT, handle);
+            putUnsigned(id);
+        }
+    }
+    return iterator;
+}
+
+LSQ_IteratorT traceGetPastRearElement(LSQ_HandleT handle) {
+    LSQ_IteratorT iterator = LSQ_GetPastRearElement(handle);
+    if (recorder.file != NULL) {
+        unsigned int id = addObject(iterator);
+        if (recorder.file != NULL) {
+            recordObject(TRACE_GET_PAST_REAR_ELEMENT, handle);
+            putUnsigned(id);
+        }
+    }
+    return iterator;
+}
+
+void traceDestroyIterator(LSQ_IteratorT iterator) {
+    recordObject(TRACE_DESTROY_ITERATOR, iterator);
+    removeObject(iterator);
+    LSQ_DestroyIterator(iterator);
+}
+
+void traceAdvanceOneElement(LSQ_IteratorT iterator) {
+    recordObject(TRACE_ADVANCE_ONE_ELEMENT, iterator);
+    LSQ_AdvanceOneElement(iterator);
+}
+
+void traceRewindOneElement(LSQ_IteratorT iterator) {
+    recordObject(TRACE_REWIND_ONE_ELEMENT, iterator);
+    LSQ_RewindOneElement(iterator);
+}
+
+void traceShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
+    recordObjectValue(TRACE_SHIFT_POSITION, iterator, shift);
+    LSQ_ShiftPosition(iterator, shift);
+}
+
+void traceSetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos) {
+    recordObjectValue(TRACE_SET_POSITION, iterator, pos);
+    LSQ_SetPosition(iterator, pos);
+}
+
+void traceDeleteFrontElement(LSQ_HandleT handle) {
+    recordObject(TRACE_DELETE_FRONT_ELEMENT, handle);
+    LSQ_DeleteFrontElement(handle);
+}
+
+void traceDeleteRearElement(LSQ_HandleT handle) {
+    recordObject(TRACE_DELETE_REAR_ELEMENT, handle);
+    LSQ_DeleteRearElement(handle);
+}
+
+#ifdef TRACE_ASSOCIATIVE
+LSQ_IntegerIndexT traceGetIteratorKey(LSQ_IteratorT iterator) {
+    recordObject(TRACE_GET_ITERATOR_KEY, iterator);
+    return LSQ_GetIteratorKey(iterator);
+}
+
+void traceInsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    recordObjectValue(TRACE_INSERT_ELEMENT, handle, key);
+    if (recorder.file != NULL)
+        putSigned(value);
+    LSQ_InsertElement(handle, key, value);
+}
+
+void traceDeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
+    recordObjectValue(TRACE_DELETE_ELEMENT, handle, key);
+    LSQ_DeleteElement(handle, key);
+}
+#else
+void traceInsertFrontElement(LSQ_HandleT handle, LSQ_BaseTypeT element) {
+    recordObjectValue(TRACE_INSERT_FRONT_ELEMENT, handle, element);
+    LSQ_InsertFrontElement(handle, element);
+}
+
+void traceInsertRearElement(LSQ_HandleT handle, LSQ_BaseTypeT element) {
+    recordObjectValue(TRACE_INSERT_REAR_ELEMENT, handle, element);
+    LSQ_InsertRearElement(handle, element);
+}
+
+void traceInsertElementBeforeGiven(LSQ_IteratorT iterator, LSQ_BaseTypeT newElement) {
+    recordObjectValue(TRACE_INSERT_ELEMENT_BEFORE_GIVEN, iterator, newElement);
+    LSQ_InsertElementBeforeGiven(iterator, newElement);
+}
+
+void traceDeleteGivenElement(LSQ_IteratorT iterator) {
+    recordObject(TRACE_DELETE_GIVEN_ELEMENT, iterator);
+    LSQ_DeleteGivenElement(iterator);
+}
+#endif
+
+static void flushBuffer(void) {
+    if (recorder.used > 0)
+        fwrite(recorder.buffer, 1, recorder.used, recorder.file);
+    recorder.used = 0;
+}
+
+static void beginRecord(TraceOperation operation) {
+    if (recorder.used + TRACE_MAX_RECORD_SIZE > BUFFER_SIZE)
+        flushBuffer();
+    recorder.buffer[recorder.used++] = (unsigned char) operation;
+}
+
+static void putUnsigned(unsigned int value) {
+    while (value >= 0x80) {
+        recorder.buffer[recorder.used++] = (unsigned char) (value | 0x80);
+        value >>= 7;
+    }
+    recorder.buffer[recorder.used++] = (unsigned char) value;
+}
+
+/* zigzag: малые по модулю отрицательные числа тоже занимают один байт */
+static void putSigned(int value) {
+    putUnsigned(((unsigned int) value << 1) ^ (unsigned int) -(int) ((unsigned int) value >> 31));
+}
+
+static void recordObject(TraceOperation operation, void *object) {
+    if (recorder.file == NULL)
+        return;
+    beginRecord(operation);
+    putUnsigned(findObject(object));
+}
+
+static void recordObjectValue(TraceOperation operation, void *object, int value) {
+    if (recorder.file == NULL)
+        return;
+    beginRecord(operation);
+    putUnsigned(findObject(object));
+    putSigned(value);
+}
+
+static size_t objectHome(void *pointer) {
+    return (size_t) (((unsigned long long) (uintptr_t) pointer * POINTER_MULTIPLIER) >> 32) & recorder.mask;
+}
+
+static unsigned int findObject(void *pointer) {
+    if (pointer == NULL || recorder.slots == NULL)
+        return 0;
+    for (size_t i = objectHome(pointer); recorder.slots[i].pointer != NULL; i = (i + 1) & recorder.mask)
+        if (recorder.slots[i].pointer == pointer)
+            return recorder.slots[i].id;
+    return 0;
+}
+
+/* Если памяти под таблицу не хватило, запись прекращается: трасса с неизвестными объектами бесполезна */
+static unsigned int addObject(void *pointer) {
+    if (pointer == NULL)
+        return 0;
+    if ((recorder.count + 1) * 2 > recorder.mask + 1 && !growObjectTable()) {
+        traceClose();
+        return 0;
+    }
+    unsigned int id = (recorder.freeCount > 0) ? recorder.freeIds[--recorder.freeCount] : recorder.nextId++;
+    size_t i = objectHome(pointer);
+    while (recorder.slots[i].pointer != NULL && recorder.slots[i].pointer != pointer)
+        i = (i + 1) & recorder.mask;
+    if (recorder.slots[i].pointer == NULL)
+        recorder.count++;
+    recorder.slots[i].pointer = pointer;
+    recorder.slots[i].id = id;
+    return id;
+}
+
+/* Удаление со сдвигом назад: следующие элементы цепочки подтягиваются на освободившееся место */
+static void removeObject(void *pointer) {
+    if (pointer == NULL || recorder.slots == NULL)
+        return;
+    size_t i = objectHome(pointer);
+    while (recorder.slots[i].pointer != pointer) {
+        if (recorder.slots[i].pointer == NULL)
+            return;
+        i = (i + 1) & recorder.mask;
+    }
+    if (recorder.freeCount == recorder.freeCapacity) {
+        size_t capacity = (recorder.freeCapacity == 0) ? OBJECT_TABLE_MIN_CAPACITY : recorder.freeCapacity * 2;
+        unsigned int *freeIds = (unsigned int *) realloc(recorder.freeIds, capacity * sizeof(unsigned int));
+        if (freeIds != NULL) {
+            recorder.freeIds = freeIds;
+            recorder.freeCapacity = capacity;
+        }
+    }
+    if (recorder.freeCount < recorder.freeCapacity)
+        recorder.freeIds[recorder.freeCount++] = recorder.slots[i].id;
+    size_t hole = i;
+    for (size_t j = (i + 1) & recorder.mask; recorder.slots[j].pointer != NULL; j = (j + 1) & recorder.mask) {
+        size_t home = objectHome(recorder.slots[j].pointer);
+        if (((j - home) & recorder.mask) >= ((j - hole) & recorder.mask)) {
+            recorder.slots[hole] = recorder.slots[j];
+            hole = j;
+        }
+    }
+    recorder.slots[hole].pointer = NULL;
+    recorder.count--;
+}
+
+static int growObjectTable(void) {
+    size_t capacity = (recorder.slots == NULL) ? OBJECT_TABLE_MIN_CAPACITY : (recorder.mask + 1) * 2;
+    ObjectSlot *slots = (ObjectSlot *) calloc(capacity, sizeof(ObjectSlot));
+    if (slots == NULL)
+        return 0;
+    ObjectSlot *oldSlots = recorder.slots;
+    size_t oldCapacity = (oldSlots == NULL) ? 0 : recorder.mask + 1;
+    recorder.slots = slots;
+    recorder.mask = capacity - 1;
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].pointer == NULL)
+            continue;
+        size_t j = objectHome(oldSlots[i].pointer);
+        while (slots[j].pointer != NULL)
+            j = (j + 1) & recorder.mask;
+        slots[j] = oldSlots[i];
+    }
+    free(oldSlots);
+    return 1;
+}
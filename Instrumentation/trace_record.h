@@ -0,0 +1,82 @@
+#ifndef TRACE_RECORD_H
+#define TRACE_RECORD_H
+
+/* Записывающая прослойка. Подключается после заголовка контейнера и подменяет функции общего интерфейса  *
+ * обертками, которые дописывают операцию в трассу и вызывают сам контейнер. trace_record.c собирается     *
+ * с тем же заголовком, с TRACE_ASSOCIATIVE для linear_sequence_assoc.h. Пока трасса не открыта, обертки    *
+ * только передают вызов. Прослойка не потокобезопасна, как и сами контейнеры.                              */
+
+/* Ассоциативный контейнер узнается по стражу linear_sequence_assoc.h, иначе без TRACE_ASSOCIATIVE его  *
+ * InsertElement, DeleteElement и GetIteratorKey молча не попадали бы в трассу. Имя traceCreateSequence *
+ * зависит от флага: если trace_record.c собран с другим, программа не слинкуется.                      */
+#if defined(LINEAR_SEQUENCE_H) && !defined(TRACE_ASSOCIATIVE)
+#define TRACE_ASSOCIATIVE
+#endif
+#ifdef TRACE_ASSOCIATIVE
+#define traceCreateSequence traceCreateAssociativeSequence
+#endif
+
+/* Функция, начинающая запись трассы в файл path. Возвращает 0, если файл открыть не удалось */
+extern int traceOpen(const char *path);
+/* Функция, дописывающая буфер и закрывающая трассу. Вызывается и при завершении программы */
+extern void traceClose(void);
+
+extern LSQ_HandleT traceCreateSequence(void);
+extern void traceDestroySequence(LSQ_HandleT handle);
+extern LSQ_IntegerIndexT traceGetSize(LSQ_HandleT handle);
+extern int traceIsIteratorDereferencable(LSQ_IteratorT iterator);
+extern int traceIsIteratorPastRear(LSQ_IteratorT iterator);
+extern int traceIsIteratorBeforeFirst(LSQ_IteratorT iterator);
+extern LSQ_BaseTypeT* traceDereferenceIterator(LSQ_IteratorT iterator);
+extern LSQ_IteratorT traceGetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index);
+extern LSQ_IteratorT traceGetFrontElement(LSQ_HandleT handle);
+extern LSQ_IteratorT traceGetPastRearElement(LSQ_HandleT handle);
+extern void traceDestroyIterator(LSQ_IteratorT iterator);
+extern void traceAdvanceOneElement(LSQ_IteratorT iterator);
+extern void traceRewindOneElement(LSQ_IteratorT iterator);
+extern void traceShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift);
+extern void traceSetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos);
+extern void traceDeleteFrontElement(LSQ_HandleT handle);
+extern void traceDeleteRearElement(LSQ_HandleT handle);
+#ifdef TRACE_ASSOCIATIVE
+extern LSQ_IntegerIndexT traceGetIteratorKey(LSQ_IteratorT iterator);
+extern void traceInsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value);
+extern void traceDeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key);
+#else
+extern void traceInsertFrontElement(LSQ_HandleT handle, LSQ_BaseTypeT element);
+extern void traceInsertRearElement(LSQ_HandleT handle, LSQ_BaseTypeT element);
+extern void traceInsertElementBeforeGiven(LSQ_IteratorT iterator, LSQ_BaseTypeT newElement);
+extern void traceDeleteGivenElement(LSQ_IteratorT iterator);
+#endif
+
+#ifndef TRACE_RECORD_IMPLEMENTATION
+#define LSQ_CreateSequence traceCreateSequence
+#define LSQ_DestroySequence traceDestroySequence
+#define LSQ_GetSize traceGetSize
+#define LSQ_IsIteratorDereferencable traceIsIteratorDereferencable
+#define LSQ_IsIteratorPastRear traceIsIteratorPastRear
+#define LSQ_IsIteratorBeforeFirst traceIsIteratorBeforeFirst
+#define LSQ_DereferenceIterator traceDereferenceIterator
+#define LSQ_GetElementByIndex traceGetElementByIndex
+#define LSQ_GetFrontElement traceGetFrontElement
+#define LSQ_GetPastRearElement traceGetPastRearElement
+#define LSQ_DestroyIterator traceDestroyIterator
+#define LSQ_AdvanceOneElement traceAdvanceOneElement
+#define LSQ_RewindOneElement traceRewindOneElement
+#define LSQ_ShiftPosition traceShiftPosition
+#define LSQ_SetPosition traceSetPosition
+#define LSQ_DeleteFrontElement traceDeleteFrontElement
+#define LSQ_DeleteRearElement traceDeleteRearElement
+#ifdef TRACE_ASSOCIATIVE
+#define LSQ_GetIteratorKey traceGetIteratorKey
+#define LSQ_InsertElement traceInsertElement
+#define LSQ_DeleteElement traceDeleteElement
+#else
+#define LSQ_InsertFrontElement traceInsertFrontElement
+#define LSQ_InsertRearElement traceInsertRearElement
+#define LSQ_InsertElementBeforeGiven traceInsertElementBeforeGiven
+#define LSQ_DeleteGivenElement traceDeleteGivenElement
+#endif
+#endif
+
+#endif
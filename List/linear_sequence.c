@@ -1,5 +1,18 @@
 #include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <pthread.h>
 #include "linear_sequence.h"
+#include "../Instrumentation/instrumentation.h"
+
+/* Меньшие списки LSQ_DestroySequenceAsync освобождает на месте: передача потоку обойдется дороже */
+#define ASYNC_DESTROY_MIN_SIZE 4096
+
+#define LIST_FILE_MAGIC "LSQLIST"
+#define LIST_FILE_MAGIC_SIZE 8
+#define LIST_FILE_VERSION 1
+/* Значения пишутся и читаются через буфер из стольких элементов */
+#define FILE_BLOCK_SIZE 4096
 
 typedef struct Node_ {
     LSQ_BaseTypeT value;
@@ -7,10 +20,19 @@ typedef struct Node_ {
     struct Node_ *prev;
 } Node;
 
-typedef struct {
+typedef struct DblList_ {
     Node *nodeBeforFirst;
     Node *nodePastReer;
     LSQ_IntegerIndexT size;
+#ifdef LSQ_STATS
+    LSQ_StatsT stats;
+#endif
+#ifdef LSQ_LATENCY
+    LatencyProfile *latency;
+#endif
+    /* Соседи в списке живых контейнеров */
+    struct DblList_ *nextLive;
+    struct DblList_ *prevLive;
 } DblList;
 
 typedef struct {
@@ -18,11 +40,39 @@ typedef struct {
     Node *node;
 } Iterator;
 
+/* Заголовок файла LSQ_Save, за ним size значений от первого к последнему в порядке байтов машины */
+typedef struct {
+    char magic[LIST_FILE_MAGIC_SIZE];
+    LSQ_IntegerIndexT version;
+    LSQ_IntegerIndexT size;
+} ListFileHeader;
+
+LIVE_CONTAINERS(DblList)
+
+/* Очередь списков, переданных LSQ_DestroySequenceAsync. Список уже исключен из живых, *
+ * поэтому очередь связана через nextLive. Фоновый поток запускается при первой передаче. */
+static DblList *reclaimQueue = LSQ_HandleInvalid;
+static LSQ_IntegerIndexT reclaimPending = 0;
+static int reclaimerStarted = 0;
+static pthread_mutex_t reclaimMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reclaimAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t reclaimDone = PTHREAD_COND_INITIALIZER;
+
+static void freeList(DblList *);
+static int enqueueReclaim(DblList *);
+static void *reclaimLoop(void *);
+
 extern LSQ_HandleT LSQ_CreateSequence(void) {
     DblList *tmpList = (DblList *) malloc(sizeof(DblList));
     if (tmpList == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
     tmpList->size = 0;
+#ifdef LSQ_STATS
+    tmpList->stats = (LSQ_StatsT) {0, 0};
+#endif
+#ifdef LSQ_LATENCY
+    tmpList->latency = LSQ_HandleInvalid;
+#endif
     tmpList->nodeBeforFirst = (Node *) malloc(sizeof(Node));
     if (tmpList->nodeBeforFirst == LSQ_HandleInvalid) {
         free(tmpList);
@@ -38,6 +88,7 @@ extern LSQ_HandleT LSQ_CreateSequence(void) {
     tmpList->nodeBeforFirst->next = tmpList->nodePastReer;
     tmpList->nodePastReer->next = LSQ_HandleInvalid;
     tmpList->nodePastReer->prev = tmpList->nodeBeforFirst;
+    registerContainer(tmpList);
     return tmpList;
 }
 
@@ -45,14 +96,99 @@ extern void LSQ_DestroySequence(LSQ_HandleT handle) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid)
         return;
-    Node *tmpNode = tmpList->nodeBeforFirst;
-    while (tmpNode != LSQ_HandleInvalid) {
-        Node *nextNode = tmpNode->next;
-        free(tmpNode);
-        tmpNode = nextNode;
+    LATENCY(tmpList, LATENCY_DESTROY_SEQUENCE);
+    unregisterContainer(tmpList);
+    freeList(tmpList);
+}
+
+extern void LSQ_DestroySequenceAsync(LSQ_HandleT handle) {
+    DblList *tmpList = (DblList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    LATENCY(tmpList, LATENCY_DESTROY_SEQUENCE);
+    unregisterContainer(tmpList);
+    if (tmpList->size < ASYNC_DESTROY_MIN_SIZE || !enqueueReclaim(tmpList))
+        freeList(tmpList);
+}
+
+extern void LSQ_WaitForAsyncDestroy(void) {
+    pthread_mutex_lock(&reclaimMutex);
+    while (reclaimPending > 0)
+        pthread_cond_wait(&reclaimDone, &reclaimMutex);
+    pthread_mutex_unlock(&reclaimMutex);
+}
+
+extern int LSQ_Save(LSQ_HandleT handle, const char *path) {
+    DblList *tmpList = (DblList *) handle;
+    if (tmpList == LSQ_HandleInvalid || path == LSQ_HandleInvalid)
+        return 0;
+    size_t length = strlen(path);
+    char *temporary = (char *) malloc(length + sizeof(".tmp"));
+    if (temporary == LSQ_HandleInvalid)
+        return 0;
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+    FILE *stream = fopen(temporary, "wb");
+    if (stream == LSQ_HandleInvalid) {
+        free(temporary);
+        return 0;
     }
-    free(handle);
-    handle = LSQ_HandleInvalid;
+    ListFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LIST_FILE_MAGIC, LIST_FILE_MAGIC_SIZE);
+    header.version = LIST_FILE_VERSION;
+    header.size = tmpList->size;
+    int written = fwrite(&header, sizeof(header), 1, stream) == 1;
+    LSQ_BaseTypeT block[FILE_BLOCK_SIZE];
+    size_t count = 0;
+    for (Node *tmpNode = tmpList->nodeBeforFirst->next; written && tmpNode != tmpList->nodePastReer; tmpNode = tmpNode->next) {
+        block[count++] = tmpNode->value;
+        if (count == FILE_BLOCK_SIZE) {
+            written = fwrite(block, sizeof(LSQ_BaseTypeT), count, stream) == count;
+            count = 0;
+        }
+    }
+    if (written && count > 0)
+        written = fwrite(block, sizeof(LSQ_BaseTypeT), count, stream) == count;
+    int saved = (fclose(stream) == 0) && written && rename(temporary, path) == 0;
+    if (!saved)
+        remove(temporary);
+    free(temporary);
+    return saved;
+}
+
+extern LSQ_HandleT LSQ_Load(const char *path) {
+    if (path == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    FILE *stream = fopen(path, "rb");
+    if (stream == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    ListFileHeader header;
+    if (fread(&header, sizeof(header), 1, stream) != 1 || memcmp(header.magic, LIST_FILE_MAGIC, LIST_FILE_MAGIC_SIZE) != 0
+        || header.version != LIST_FILE_VERSION || header.size < 0) {
+        fclose(stream);
+        return LSQ_HandleInvalid;
+    }
+    LSQ_HandleT newList = LSQ_CreateSequence();
+    LSQ_BaseTypeT block[FILE_BLOCK_SIZE];
+    for (LSQ_IntegerIndexT rest = header.size; newList != LSQ_HandleInvalid && rest > 0; ) {
+        size_t count = (rest < FILE_BLOCK_SIZE) ? (size_t) rest : FILE_BLOCK_SIZE;
+        if (fread(block, sizeof(LSQ_BaseTypeT), count, stream) != count) {
+            LSQ_DestroySequence(newList);
+            newList = LSQ_HandleInvalid;
+            break;
+        }
+        for (size_t i = 0; i < count; i++)
+            LSQ_InsertRearElement(newList, block[i]);
+        rest -= (LSQ_IntegerIndexT) count;
+    }
+    fclose(stream);
+    // вставка без памяти молча ничего не добавляет, поэтому короткий список - ошибка загрузки
+    if (newList != LSQ_HandleInvalid && LSQ_GetSize(newList) != header.size) {
+        LSQ_DestroySequence(newList);
+        newList = LSQ_HandleInvalid;
+    }
+    return newList;
 }
 
 extern LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle) {
@@ -90,11 +226,14 @@ extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpList, LATENCY_GET_ELEMENT_BY_INDEX);
 
     Node *tmpNode = tmpList->nodeBeforFirst->next;
-    for (LSQ_IntegerIndexT i = 0; tmpNode->next != LSQ_HandleInvalid && i < index; i++) {
+    LSQ_IntegerIndexT i;
+    for (i = 0; tmpNode->next != LSQ_HandleInvalid && i < index; i++) {
         tmpNode = tmpNode->next;
     }
+    STATS_ADD(tmpList, nodesWalked, i);
 
     Iterator *tmpIterator = (Iterator *) malloc(sizeof(Iterator));
     if (tmpIterator == LSQ_HandleInvalid)
@@ -108,6 +247,7 @@ extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpList, LATENCY_GET_FRONT_ELEMENT);
 
     Node *tmpNode = tmpList->nodeBeforFirst->next;
     Iterator *tmpIterator = (Iterator *) malloc(sizeof(Iterator));
@@ -122,6 +262,7 @@ extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpList, LATENCY_GET_PAST_REAR_ELEMENT);
 
     Node *tmpNode = tmpList->nodePastReer;
     Iterator *tmpIterator = (Iterator *) malloc(sizeof(Iterator));
@@ -143,6 +284,7 @@ extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *) iterator;
     if (tmpIterator == LSQ_HandleInvalid || tmpIterator->node->next == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->list, LATENCY_ADVANCE_ONE_ELEMENT);
     tmpIterator->node = tmpIterator->node->next;
 }
 
@@ -150,6 +292,7 @@ extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *) iterator;
     if (tmpIterator == LSQ_HandleInvalid || tmpIterator->node->prev == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->list, LATENCY_REWIND_ONE_ELEMENT);
     tmpIterator->node = tmpIterator->node->prev;
 }
 
@@ -157,6 +300,7 @@ extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
     Iterator *tmpIterator = (Iterator *) iterator;
     if (tmpIterator == LSQ_HandleInvalid || shift == 0)
         return;
+    LATENCY(tmpIterator->list, LATENCY_SHIFT_POSITION);
     LSQ_IntegerIndexT i = shift;
     if (shift > 0){
         while (i != 0 && tmpIterator->node->next != LSQ_HandleInvalid) {
@@ -170,6 +314,7 @@ extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
             i++;
         }
     }
+    STATS_ADD(tmpIterator->list, nodesWalked, (shift > 0) ? shift - i : i - shift);
 }
 
 extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos) {
@@ -177,20 +322,80 @@ extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos) {
     if (tmpIterator == LSQ_HandleInvalid || tmpIterator->node == LSQ_HandleInvalid ||
         tmpIterator->list == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->list, LATENCY_SET_POSITION);
 
     tmpIterator->node = tmpIterator->list->nodeBeforFirst;
-    for (LSQ_IntegerIndexT i = 0; i <= pos && tmpIterator->node->next != LSQ_HandleInvalid; i++) {
+    LSQ_IntegerIndexT i;
+    for (i = 0; i <= pos && tmpIterator->node->next != LSQ_HandleInvalid; i++) {
         tmpIterator->node = tmpIterator->node->next;
     }
+    STATS_ADD(tmpIterator->list, nodesWalked, i);
+}
+
+extern void LSQ_ForEach(LSQ_HandleT handle, LSQ_VisitorT visitor, void *context) {
+    DblList *tmpList = (DblList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    LSQ_ForEachRange(handle, 0, tmpList->size, visitor, context);
+}
+
+extern void LSQ_ForEachRange(LSQ_HandleT handle, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last,
+                             LSQ_VisitorT visitor, void *context) {
+    DblList *tmpList = (DblList *) handle;
+    if (tmpList == LSQ_HandleInvalid || visitor == LSQ_HandleInvalid)
+        return;
+    if (first < 0)
+        first = 0;
+    if (last > tmpList->size)
+        last = tmpList->size;
+    if (first >= last)
+        return;
+
+    Node *tmpNode = tmpList->nodeBeforFirst->next;
+    LSQ_IntegerIndexT index;
+    for (index = 0; index < first; index++)
+        tmpNode = tmpNode->next;
+    STATS_ADD(tmpList, nodesWalked, index);
+    for (; index < last; index++, tmpNode = tmpNode->next)
+        if (visitor(index, &tmpNode->value, context))
+            return;
+}
+
+extern LSQ_IntegerIndexT LSQ_ReadBlock(LSQ_IteratorT iterator, LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (buffer == LSQ_HandleInvalid || !LSQ_IsIteratorDereferencable(iterator))
+        return 0;
+    Node *tmpNode = tmpIterator->node;
+    Node *pastRear = tmpIterator->list->nodePastReer;
+    LSQ_IntegerIndexT i;
+    for (i = 0; i < count && tmpNode != pastRear; i++, tmpNode = tmpNode->next)
+        buffer[i] = tmpNode->value;
+    tmpIterator->node = tmpNode;
+    return i;
+}
+
+extern LSQ_IntegerIndexT LSQ_WriteBlock(LSQ_IteratorT iterator, const LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (buffer == LSQ_HandleInvalid || !LSQ_IsIteratorDereferencable(iterator))
+        return 0;
+    Node *tmpNode = tmpIterator->node;
+    Node *pastRear = tmpIterator->list->nodePastReer;
+    LSQ_IntegerIndexT i;
+    for (i = 0; i < count && tmpNode != pastRear; i++, tmpNode = tmpNode->next)
+        tmpNode->value = buffer[i];
+    tmpIterator->node = tmpNode;
+    return i;
 }
 
 extern void LSQ_InsertFrontElement(LSQ_HandleT handle, LSQ_BaseTypeT element) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpList, LATENCY_INSERT_FRONT_ELEMENT);
     Node *newNode = (Node *) malloc(sizeof(Node));
     if (newNode == LSQ_HandleInvalid)
         return;
+    STATS_ADD(tmpList, nodeAllocations, 1);
     newNode->value = element;
     newNode->prev = tmpList->nodeBeforFirst;
     newNode->next = tmpList->nodeBeforFirst->next;
@@ -204,9 +409,11 @@ extern void LSQ_InsertRearElement(LSQ_HandleT handle, LSQ_BaseTypeT element) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpList, LATENCY_INSERT_REAR_ELEMENT);
     Node *newNode = (Node *) malloc(sizeof(Node));
     if (newNode == LSQ_HandleInvalid)
         return;
+    STATS_ADD(tmpList, nodeAllocations, 1);
     newNode->value = element;
     newNode->next = tmpList->nodePastReer;
     newNode->prev = tmpList->nodePastReer->prev;
@@ -220,9 +427,11 @@ extern void LSQ_InsertElementBeforeGiven(LSQ_IteratorT iterator, LSQ_BaseTypeT n
     Iterator *tmpIterator = (Iterator *) iterator;
     if (tmpIterator == LSQ_HandleInvalid)
         return;
+    LATENCY(tmpIterator->list, LATENCY_INSERT_ELEMENT_BEFORE_GIVEN);
     Node *newNode = (Node *) malloc(sizeof(Node));
     if (newNode == LSQ_HandleInvalid)
         return;
+    STATS_ADD(tmpIterator->list, nodeAllocations, 1);
     newNode->value = newElement;
     newNode->prev = tmpIterator->node->prev;
     newNode->next = tmpIterator->node;
@@ -237,6 +446,7 @@ extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid || tmpList->nodeBeforFirst->next == tmpList->nodePastReer)
         return;
+    LATENCY(tmpList, LATENCY_DELETE_FRONT_ELEMENT);
 
     Node *tmpNode = tmpList->nodeBeforFirst->next;
     tmpNode->next->prev = tmpList->nodeBeforFirst;
@@ -250,6 +460,7 @@ extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
     DblList *tmpList = (DblList *) handle;
     if (tmpList == LSQ_HandleInvalid || tmpList->nodePastReer->prev == tmpList->nodeBeforFirst)
         return;
+    LATENCY(tmpList, LATENCY_DELETE_REAR_ELEMENT);
 
     Node *tmpNode = tmpList->nodePastReer->prev;
     tmpNode->prev->next = tmpList->nodePastReer;
@@ -263,6 +474,7 @@ extern void LSQ_DeleteGivenElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (!LSQ_IsIteratorDereferencable(iterator))
         return;
+    LATENCY(tmpIterator->list, LATENCY_DELETE_GIVEN_ELEMENT);
 
     Node *tmpNode = tmpIterator->node;
     tmpNode->next->prev = tmpNode->prev;
@@ -271,4 +483,102 @@ extern void LSQ_DeleteGivenElement(LSQ_IteratorT iterator) {
 
     tmpIterator->list->size--;
     free(tmpNode);
+}
+
+extern void LSQ_GetStats(LSQ_HandleT handle, LSQ_StatsT *stats) {
+    if (stats == LSQ_HandleInvalid)
+        return;
+#ifdef LSQ_STATS
+    DblList *tmpList = (DblList *) handle;
+    if (tmpList != LSQ_HandleInvalid) {
+        *stats = tmpList->stats;
+        return;
+    }
+#else
+    (void) handle;
+#endif
+    *stats = (LSQ_StatsT) {0, 0};
+}
+extern void LSQ_SetLatencyProfile(LSQ_HandleT handle, struct LatencyProfile_ *profile) {
+#ifdef LSQ_LATENCY
+    DblList *tmpList = (DblList *) handle;
+    if (tmpList != LSQ_HandleInvalid)
+        tmpList->latency = profile;
+#else
+    (void) handle;
+    (void) profile;
+#endif
+}
+
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    DblList *tmpList = (DblList *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    usage->payload = tmpList->size * sizeof(LSQ_BaseTypeT);
+    usage->overhead = sizeof(DblList) + 2 * sizeof(Node) + tmpList->size * (sizeof(Node) - sizeof(LSQ_BaseTypeT));
+}
+
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (DblList *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+
+static void freeList(DblList *list) {
+    Node *tmpNode = list->nodeBeforFirst;
+    while (tmpNode != LSQ_HandleInvalid) {
+        Node *nextNode = tmpNode->next;
+        free(tmpNode);
+        tmpNode = nextNode;
+    }
+    free(list);
+}
+
+/* Возвращает 0, если фоновый поток запустить не удалось: тогда список освобождает вызывающий */
+static int enqueueReclaim(DblList *list) {
+    pthread_mutex_lock(&reclaimMutex);
+    if (!reclaimerStarted) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, reclaimLoop, NULL) == 0) {
+            pthread_detach(thread);
+            reclaimerStarted = 1;
+        }
+    }
+    if (reclaimerStarted) {
+        list->nextLive = reclaimQueue;
+        reclaimQueue = list;
+        reclaimPending++;
+        pthread_cond_signal(&reclaimAvailable);
+    }
+    pthread_mutex_unlock(&reclaimMutex);
+    return reclaimerStarted;
+}
+
+static void *reclaimLoop(void *argument) {
+    (void) argument;
+    pthread_mutex_lock(&reclaimMutex);
+    while (1) {
+        while (reclaimQueue == LSQ_HandleInvalid)
+            pthread_cond_wait(&reclaimAvailable, &reclaimMutex);
+        DblList *list = reclaimQueue;
+        reclaimQueue = list->nextLive;
+        pthread_mutex_unlock(&reclaimMutex);
+        freeList(list);
+        pthread_mutex_lock(&reclaimMutex);
+        if (--reclaimPending == 0)
+            pthread_cond_broadcast(&reclaimDone);
+    }
+    return NULL;
 }
\ No newline at end of file
@@ -1,7 +1,12 @@
 #include <stdlib.h>
 #include <stdio.h>
+#include <unistd.h>
 #include <stdarg.h>
+#include <sys/stat.h>
 #include "linear_sequence.h"
+#ifdef LSQ_LATENCY
+#include "../Instrumentation/latency.h"
+#endif
 
 #define TEST { test_line = __LINE__; test_init(); } {
 #define ENDTEST } { test_teardown(); test_line = 0; }
@@ -80,6 +85,22 @@ void dump(LSQ_HandleT seq)
     LSQ_DestroyIterator(it);
 }
 
+/* Запоминает номера и значения посещенных элементов, увеличивает значения на 1 и останавливает обход после limit */
+typedef struct {
+    int indices[16];
+    int values[16];
+    int count;
+    int limit;
+} Visited;
+
+int visit(LSQ_IntegerIndexT index, LSQ_BaseTypeT *value, void *context)
+{
+    Visited *visited = (Visited *) context;
+    visited->indices[visited->count] = index;
+    visited->values[visited->count] = (*value)++;
+    return ++visited->count == visited->limit;
+}
+
 int main()
 {
     int i, count;
@@ -362,6 +383,162 @@ int main()
         test_assert(LSQ_IsIteratorBeforeFirst(LSQ_HandleInvalid) == 0);
     ENDTEST
 
+    TEST
+        LSQ_StatsT stats;
+        seq_push(seq, 10, 0,1,2,3,4,5,6,7,8,9);
+        iter = LSQ_GetElementByIndex(seq, 3);
+        LSQ_SetPosition(iter, 5);
+        LSQ_ShiftPosition(iter, -2);
+        LSQ_DestroyIterator(iter);
+        LSQ_GetStats(seq, &stats);
+#ifdef LSQ_STATS
+        test_assert(stats.nodeAllocations == 10 && stats.nodesWalked == 3 + 6 + 2);
+#else
+        test_assert(stats.nodeAllocations == 0 && stats.nodesWalked == 0);
+#endif
+    ENDTEST
+
+    TEST
+#ifdef LSQ_LATENCY
+        LatencyProfile *profile = latencyCreateProfile();
+        LSQ_SetLatencyProfile(seq, profile);
+        seq_push(seq, 10, 0,1,2,3,4,5,6,7,8,9);
+        iter = LSQ_GetElementByIndex(seq, 3);
+        LSQ_SetPosition(iter, 5);
+        LSQ_DeleteGivenElement(iter);
+        LSQ_DestroyIterator(iter);
+        LSQ_DestroySequence(seq);
+        seq = LSQ_CreateSequence();
+        test_assert(profile->histograms[LATENCY_INSERT_REAR_ELEMENT].count == 10);
+        test_assert(profile->histograms[LATENCY_SET_POSITION].count == 1);
+        test_assert(profile->histograms[LATENCY_DELETE_GIVEN_ELEMENT].count == 1);
+        test_assert(profile->histograms[LATENCY_DESTROY_SEQUENCE].count == 1);
+        latencyDestroyProfile(profile);
+#else
+        LSQ_SetLatencyProfile(seq, LSQ_HandleInvalid);
+        seq_push(seq, 2, 0,1);
+        test_assert(LSQ_GetSize(seq) == 2);
+#endif
+    ENDTEST
+
+    TEST
+        Visited visited = {{0}, {0}, 0, 16};
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 0);
+        seq_push(seq, 5, 10, 20, 30, 40, 50);
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 5 && visited.indices[4] == 4 && visited.values[4] == 50);
+        test_assert_seq(seq, 5, 11, 21, 31, 41, 51);
+        visited.count = 0;
+        visited.limit = 2;
+        LSQ_ForEachRange(seq, 1, 10, visit, &visited);
+        test_assert(visited.count == 2 && visited.indices[0] == 1 && visited.values[1] == 31);
+        visited.count = 0;
+        visited.limit = 16;
+        LSQ_ForEachRange(seq, 3, 3, visit, &visited);
+        test_assert(visited.count == 0);
+        LSQ_ForEachRange(seq, -2, 2, visit, &visited);
+        test_assert(visited.count == 2 && visited.indices[1] == 1);
+        LSQ_ForEachRange(seq, 4, 100, visit, &visited);
+        test_assert(visited.count == 3 && visited.indices[2] == 4 && visited.values[2] == 51);
+        LSQ_ForEachRange(seq, 10, 20, visit, &visited);
+        test_assert(visited.count == 3);
+        test_assert_seq(seq, 5, 12, 23, 32, 41, 52);
+    ENDTEST
+
+    TEST
+        LSQ_BaseTypeT block[8] = {0};
+        LSQ_BaseTypeT values[3] = {-1, -2, -3};
+        seq_push(seq, 10, 0,1,2,3,4,5,6,7,8,9);
+        iter = LSQ_GetElementByIndex(seq, 2);
+        test_assert(LSQ_ReadBlock(iter, block, 5) == 5);
+        test_assert(block[0] == 2 && block[4] == 6 && ITER_VAL(iter) == 7);
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 3 && block[2] == 9 && LSQ_IsIteratorPastRear(iter));
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 0 && LSQ_WriteBlock(iter, values, 3) == 0);
+        LSQ_SetPosition(iter, 8);
+        test_assert(LSQ_WriteBlock(iter, values, 3) == 2 && LSQ_IsIteratorPastRear(iter));
+        LSQ_SetPosition(iter, 0);
+        test_assert(LSQ_WriteBlock(iter, values, 1) == 1 && ITER_VAL(iter) == 1);
+        test_assert(LSQ_GetSize(seq) == 10);
+        test_assert_seq(seq, 10, -1,1,2,3,4,5,6,7,-1,-2);
+        LSQ_DestroyIterator(iter);
+    ENDTEST
+
+    TEST
+        LSQ_MemoryUsageT usage, total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 100; i++)
+            LSQ_InsertRearElement(other, i);
+        LSQ_GetMemoryUsage(other, &usage);
+        test_assert(usage.payload == 100 * sizeof(LSQ_BaseTypeT));
+        test_assert(usage.slack == 0 && usage.overhead >= 100 * 2 * sizeof(void *));
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequence(other);
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == usage.payload && total.overhead - reduced.overhead == usage.overhead);
+        test_assert(total.slack - reduced.slack == usage.slack);
+    ENDTEST
+
+    TEST
+        LSQ_MemoryUsageT total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 10000; i++)
+            LSQ_InsertRearElement(other, i);
+        LSQ_HandleT small = LSQ_CreateSequence();
+        LSQ_InsertRearElement(small, 1);
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequenceAsync(other);
+        LSQ_DestroySequenceAsync(small);
+        LSQ_DestroySequenceAsync(LSQ_HandleInvalid);
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == 10001 * sizeof(LSQ_BaseTypeT));
+        LSQ_WaitForAsyncDestroy();
+        LSQ_GetTotalMemoryUsage(&total);
+        test_assert(total.payload == reduced.payload);
+    ENDTEST
+
+    TEST
+        char path[] = "/tmp/lsq_listXXXXXX";
+        int descriptor = mkstemp(path);
+        test_assert(descriptor >= 0);
+        close(descriptor);
+        for(i = 0; i < 10000; i++)
+            LSQ_InsertRearElement(seq, i);
+        test_assert(LSQ_Save(seq, path));
+        LSQ_HandleT other = LSQ_Load(path);
+        test_assert(LSQ_GetSize(other) == 10000);
+        iter = LSQ_GetElementByIndex(other, 4096);
+        test_assert(ITER_VAL(iter) == 4096);
+        LSQ_SetPosition(iter, 9999);
+        test_assert(ITER_VAL(iter) == 9999);
+        LSQ_DestroyIterator(iter);
+        LSQ_DestroySequence(other);
+
+        /* Временный файл занят каталогом: запись не удается, но прежний файл остается целым */
+        char temporary[sizeof(path) + 4];
+        snprintf(temporary, sizeof(temporary), "%s.tmp", path);
+        test_assert(mkdir(temporary, 0700) == 0);
+        test_assert(!LSQ_Save(seq, path));
+        rmdir(temporary);
+        other = LSQ_Load(path);
+        test_assert(LSQ_GetSize(other) == 10000);
+        LSQ_DestroySequence(other);
+
+        other = LSQ_CreateSequence();
+        test_assert(LSQ_Save(other, path));
+        LSQ_DestroySequence(other);
+        other = LSQ_Load(path);
+        test_assert(other != LSQ_HandleInvalid && LSQ_GetSize(other) == 0);
+        LSQ_DestroySequence(other);
+
+        FILE *stream = fopen(path, "w");
+        fputs("not a list", stream);
+        fclose(stream);
+        test_assert(LSQ_Load(path) == LSQ_HandleInvalid);
+        unlink(path);
+        test_assert(LSQ_Load(path) == LSQ_HandleInvalid);
+    ENDTEST
+
     printf("All tests passed!\n");
     return EXIT_SUCCESS;
 }
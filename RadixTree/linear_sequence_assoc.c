@@ -0,0 +1,885 @@
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#include "linear_sequence_assoc.h"
+#include "../Instrumentation/instrumentation.h"
+ 
+
+#define KEY_BYTES 4
+#define SIGN_BIT 0x80000000u
+#define NODE4_CAPACITY 4
+#define NODE16_CAPACITY 16
+#define NODE48_CAPACITY 48
+#define LEAF_BLOCK_SIZE 4096
+#define PATH_UNKNOWN -1
+#define IS_LEAF(child) (((uintptr_t) (child)) & 1)
+#define GET_LEAF(child) ((Leaf *) ((uintptr_t) (child) & ~(uintptr_t) 1))
+#define MAKE_LEAF(leaf) ((void *) ((uintptr_t) (leaf) | 1))
+ 
+/* Ключ хранится беззнаковым с инвертированным знаковым битом: тогда порядок байт от старшего *
+ * к младшему совпадает с порядком ключей LSQ_IntegerIndexT.                                  */
+typedef unsigned int RadixKey;
+ 
+typedef enum {
+    NODE4,
+    NODE16,
+    NODE48,
+    NODE256
+} NodeType;
+ 
+/* Общий заголовок внутренних узлов. Узел ветвится по байту номер level; старшие level байт у всех ключей  *
+ * поддерева совпадают и хранятся в prefix целиком, поэтому сжатие путей не требует отдельного сравнения *
+ * префиксов по байтам.                                                                                  */
+typedef struct {
+    RadixKey prefix;
+    unsigned char level;
+    unsigned char type;
+    unsigned short count;
+} Header;
+ 
+/* В Node4 и Node16 байты сыновей упорядочены по возрастанию */
+typedef struct {
+    Header header;
+    unsigned char keys[NODE4_CAPACITY];
+    void *children[NODE4_CAPACITY];
+} Node4;
+ 
+typedef struct {
+    Header header;
+    unsigned char keys[NODE16_CAPACITY];
+    void *children[NODE16_CAPACITY];
+} Node16;
+ 
+/* childIndex[b] - номер в children сына с байтом b, увеличенный на 1; 0 - такого сына нет. В Node48 и Node256 *
+ * битовая карта present отмечает занятые байты, по ней соседний сын находится без перебора пустых мест.      */
+typedef struct {
+    Header header;
+    uint64_t present[4];
+    unsigned char childIndex[256];
+    void *children[NODE48_CAPACITY];
+} Node48;
+ 
+typedef struct {
+    Header header;
+    uint64_t present[4];
+    void *children[256];
+} Node256;
+ 
+/* Лист хранит ключ целиком и висит там, где его ключ впервые отличается от остальных. *
+ * Указатель на лист помечается младшим битом. Свободные листья связаны через nextFree. */
+typedef union Leaf {
+    struct {
+        RadixKey key;
+        LSQ_BaseTypeT value;
+    };
+    union Leaf *nextFree;
+} Leaf;
+ 
+/* Листья выделяются блоками по LEAF_BLOCK_SIZE: отдельный malloc на восемь байт дороже самого листа, *
+ * а free листьев в порядке ключей промахивается по кэшу. Первый лист блока хранит ссылку на         *
+ * предыдущий блок. Память листьев возвращается только при уничтожении контейнера.                  */
+typedef struct Tree_ {
+    void *root;
+    LSQ_IntegerIndexT size;
+    unsigned long version;
+    Leaf *blocks;
+    int blockUsed;
+    Leaf *freeLeaves;
+    /* Соседи в списке живых контейнеров */
+    struct Tree_ *nextLive;
+    struct Tree_ *prevLive;
+} Tree;
+ 
+typedef enum {
+    POSITION_BEFORE_FIRST,
+    POSITION_ELEMENT,
+    POSITION_PAST_REAR
+} Position;
+ 
+typedef struct {
+    Header *node;
+    int byte;
+} PathEntry;
+ 
+/* Итератор хранит путь по внутренним узлам (их не больше KEY_BYTES) и байт сына на каждом из них. Поиск     *
+ * по ключу путь не строит (depth == PATH_UNKNOWN), он восстанавливается при первом сдвиге. Если дерево     *
+ * менялось, путь строится заново по key; удаленный элемент заменяется следующим за ним.                    */
+typedef struct {
+    Tree *tree;
+    Position position;
+    RadixKey key;
+    Leaf *leaf;
+    unsigned long version;
+    int depth;
+    PathEntry path[KEY_BYTES];
+} Iterator;
+ 
+LIVE_CONTAINERS(Tree)
+ 
+static const size_t nodeSizes[] = {sizeof(Node4), sizeof(Node16), sizeof(Node48), sizeof(Node256)};
+ 
+static Iterator *createIterator(Tree *, Position );
+static RadixKey toRadixKey(LSQ_IntegerIndexT );
+static int keyByte(RadixKey , int );
+static RadixKey prefixMask(int );
+static Leaf *allocateLeaf(Tree *);
+static void releaseLeaf(Tree *, Leaf *);
+static Header *createNode(NodeType , int , RadixKey );
+static void destroyChild(void *);
+static int getSortedChildren(Header *, unsigned char **, void ***);
+static uint64_t *getPresentBits(Header *);
+static int nextPresent(const uint64_t *, int );
+static int previousPresent(const uint64_t *, int );
+static void **findChild(Header *, int );
+static void *nextChild(Header *, int , int *);
+static void *previousChild(Header *, int , int *);
+static Leaf *findLeaf(Tree *, RadixKey );
+static Leaf *descendMin(Iterator *, void *, int );
+static Leaf *descendMax(Iterator *, void *, int );
+static Leaf *seekFrom(Iterator *, void *, int , RadixKey );
+static void setLeaf(Iterator *, Leaf *);
+static void validateIterator(Iterator *);
+static void putChild(Header *, int , void *);
+static Header *resizeNode(Header *, NodeType );
+static void addChild(void **, int , void *);
+static void removeChild(void **, int );
+static void deleteByKey(Tree *, RadixKey );
+static void deleteExtreme(Tree *, int );
+static void removeLeaf(Tree *, void **, void **);
+static size_t innerNodeBytes(void *);
+ 
+LSQ_HandleT LSQ_CreateSequence(void) {
+    Tree *newTree = (Tree *) malloc(sizeof(Tree));
+    if (newTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newTree->root = LSQ_HandleInvalid;
+    newTree->size = 0;
+    newTree->version = 0;
+    newTree->blocks = LSQ_HandleInvalid;
+    newTree->blockUsed = LEAF_BLOCK_SIZE;
+    newTree->freeLeaves = LSQ_HandleInvalid;
+    registerContainer(newTree);
+    return newTree;
+}
+ 
+void LSQ_DestroySequence(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    unregisterContainer(tmpTree);
+    destroyChild(tmpTree->root);
+    while (tmpTree->blocks != LSQ_HandleInvalid) {
+        Leaf *block = tmpTree->blocks;
+        tmpTree->blocks = block->nextFree;
+        free(block);
+    }
+    free(tmpTree);
+}
+ 
+LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle){
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid) {
+        return 0;
+    }
+    return tmpTree->size;
+}
+ 
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    Tree *tmpTree = (Tree *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    size_t blocks = 0;
+    for (Leaf *block = tmpTree->blocks; block != LSQ_HandleInvalid; block = block->nextFree)
+        blocks++;
+    usage->payload = tmpTree->size * sizeof(Leaf);
+    usage->overhead = sizeof(Tree) + blocks * sizeof(Leaf) + innerNodeBytes(tmpTree->root);
+    usage->slack = (blocks * (LEAF_BLOCK_SIZE - 1) - tmpTree->size) * sizeof(Leaf);
+}
+ 
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (Tree *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+ 
+
+int LSQ_IsIteratorDereferencable(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_ELEMENT;
+}
+ 
+extern int LSQ_IsIteratorPastRear(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_PAST_REAR;
+}
+ 
+extern int LSQ_IsIteratorBeforeFirst(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_BEFORE_FIRST;
+}
+ 
+extern LSQ_BaseTypeT* LSQ_DereferenceIterator(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return &tmpIterator->leaf->value;
+}
+ 
+extern LSQ_IntegerIndexT LSQ_GetIteratorKey(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)){
+        return -1;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return (LSQ_IntegerIndexT) (tmpIterator->key ^ SIGN_BIT);
+}
+ 
+extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = createIterator(tmpTree, POSITION_PAST_REAR);
+    if (tmpIterator != LSQ_HandleInvalid) {
+        setLeaf(tmpIterator, findLeaf(tmpTree, toRadixKey(index)));
+        tmpIterator->depth = PATH_UNKNOWN;
+    }
+    return tmpIterator;
+}
+ 
+extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Iterator *tmpIterator = createIterator(tmpTree, POSITION_BEFORE_FIRST);
+    LSQ_AdvanceOneElement(tmpIterator);
+    return tmpIterator;
+}
+ 
+extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpTree, POSITION_PAST_REAR);
+}
+ 
+extern void LSQ_DestroyIterator(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    free(tmpIterator);
+}
+ 
+
+extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *)iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid || LSQ_IsIteratorPastRear(tmpIterator))
+        return;
+    Tree *tmpTree = tmpIterator->tree;
+ 
+    if (tmpIterator->position == POSITION_BEFORE_FIRST) {
+        setLeaf(tmpIterator, descendMin(tmpIterator, tmpTree->root, 0));
+        return;
+    }
+    if (tmpIterator->depth == PATH_UNKNOWN)
+        seekFrom(tmpIterator, tmpTree->root, 0, tmpIterator->key);
+    for (int depth = tmpIterator->depth - 1; depth >= 0; depth--) {
+        PathEntry *entry = &tmpIterator->path[depth];
+        void *child = nextChild(entry->node, entry->byte, &entry->byte);
+        if (child != LSQ_HandleInvalid) {
+            setLeaf(tmpIterator, descendMin(tmpIterator, child, depth + 1));
+            return;
+        }
+    }
+    setLeaf(tmpIterator, LSQ_HandleInvalid);
+}
+ 
+extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid || LSQ_IsIteratorBeforeFirst(tmpIterator))
+        return;
+    Tree *tmpTree = tmpIterator->tree;
+ 
+    if (tmpIterator->position == POSITION_PAST_REAR) {
+        setLeaf(tmpIterator, descendMax(tmpIterator, tmpTree->root, 0));
+        if (tmpIterator->leaf == LSQ_HandleInvalid)
+            tmpIterator->position = POSITION_BEFORE_FIRST;
+        return;
+    }
+    if (tmpIterator->depth == PATH_UNKNOWN)
+        seekFrom(tmpIterator, tmpTree->root, 0, tmpIterator->key);
+    for (int depth = tmpIterator->depth - 1; depth >= 0; depth--) {
+        PathEntry *entry = &tmpIterator->path[depth];
+        void *child = previousChild(entry->node, entry->byte, &entry->byte);
+        if (child != LSQ_HandleInvalid) {
+            setLeaf(tmpIterator, descendMax(tmpIterator, child, depth + 1));
+            return;
+        }
+    }
+    setLeaf(tmpIterator, LSQ_HandleInvalid);
+    tmpIterator->position = POSITION_BEFORE_FIRST;
+}
+ 
+
+extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || shift == 0)
+        return;
+    if (shift > 0) {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorPastRear(tmpIterator); i--) {
+            LSQ_AdvanceOneElement(tmpIterator);
+        }
+    }
+    else {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorBeforeFirst(tmpIterator); i++) {
+            LSQ_RewindOneElement(tmpIterator);
+        }
+    }
+}
+ 
+/* Как и в LSQ_GetElementByIndex, номер элемента ассоциативного контейнера - его ключ */
+extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid) {
+        return;
+    }
+    tmpIterator->version = tmpIterator->tree->version;
+    setLeaf(tmpIterator, findLeaf(tmpIterator->tree, toRadixKey(pos)));
+    tmpIterator->depth = PATH_UNKNOWN;
+}
+ 
+extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    RadixKey radixKey = toRadixKey(key);
+    void **slot = &tmpTree->root;
+    Header *node = LSQ_HandleInvalid;
+    Leaf *leaf = LSQ_HandleInvalid;
+    while (*slot != LSQ_HandleInvalid) {
+        void *child = *slot;
+        RadixKey childKey;
+        if (IS_LEAF(child)) {
+            if (GET_LEAF(child)->key == radixKey) {
+                GET_LEAF(child)->value = value;
+                return;
+            }
+            childKey = GET_LEAF(child)->key;
+        }
+        else {
+            node = (Header *) child;
+            if ((radixKey & prefixMask(node->level)) == node->prefix) {
+                void **next = findChild(node, keyByte(radixKey, node->level));
+                if (next == LSQ_HandleInvalid)
+                    break;
+                slot = next;
+                continue;
+            }
+            childKey = node->prefix;
+        }
+        /* Ключ расходится с поддеревом выше его узла: вставляется новый Node4 на байте расхождения */
+        int level = __builtin_clz(radixKey ^ childKey) / 8;
+        leaf = allocateLeaf(tmpTree);
+        node = createNode(NODE4, level, radixKey & prefixMask(level));
+        if (leaf == LSQ_HandleInvalid || node == LSQ_HandleInvalid) {
+            if (leaf != LSQ_HandleInvalid)
+                releaseLeaf(tmpTree, leaf);
+            free(node);
+            return;
+        }
+        putChild(node, keyByte(childKey, level), child);
+        *slot = node;
+        break;
+    }
+ 
+    if (leaf == LSQ_HandleInvalid)
+        leaf = allocateLeaf(tmpTree);
+    if (leaf == LSQ_HandleInvalid)
+        return;
+    leaf->key = radixKey;
+    leaf->value = value;
+    if (*slot == LSQ_HandleInvalid)
+        *slot = MAKE_LEAF(leaf);
+    else
+        addChild(slot, keyByte(radixKey, node->level), MAKE_LEAF(leaf));
+    tmpTree->size++;
+    tmpTree->version++;
+}
+ 
+extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->root == LSQ_HandleInvalid)
+        return;
+    deleteExtreme(tmpTree, 0);
+}
+ 
+extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->root == LSQ_HandleInvalid)
+        return;
+    deleteExtreme(tmpTree, 1);
+}
+ 
+extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    deleteByKey(tmpTree, toRadixKey(key));
+}
+ 
+static Iterator *createIterator(Tree *tree, Position position) {
+    Iterator *newIterator = (Iterator *) malloc(sizeof(Iterator));
+    if (newIterator == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newIterator->tree = tree;
+    newIterator->position = position;
+    newIterator->key = 0;
+    newIterator->leaf = LSQ_HandleInvalid;
+    newIterator->version = tree->version;
+    newIterator->depth = 0;
+    return newIterator;
+}
+ 
+static Leaf *allocateLeaf(Tree *tree) {
+    Leaf *leaf = tree->freeLeaves;
+    if (leaf != LSQ_HandleInvalid) {
+        tree->freeLeaves = leaf->nextFree;
+        return leaf;
+    }
+    if (tree->blockUsed == LEAF_BLOCK_SIZE) {
+        Leaf *block = (Leaf *) malloc(LEAF_BLOCK_SIZE * sizeof(Leaf));
+        if (block == LSQ_HandleInvalid)
+            return LSQ_HandleInvalid;
+        block->nextFree = tree->blocks;
+        tree->blocks = block;
+        tree->blockUsed = 1;
+    }
+    return &tree->blocks[tree->blockUsed++];
+}
+ 
+static void releaseLeaf(Tree *tree, Leaf *leaf) {
+    leaf->nextFree = tree->freeLeaves;
+    tree->freeLeaves = leaf;
+}
+ 
+static RadixKey toRadixKey(LSQ_IntegerIndexT key) {
+    return (RadixKey) key ^ SIGN_BIT;
+}
+ 
+static int keyByte(RadixKey key, int level) {
+    return (key >> (8 * (KEY_BYTES - 1 - level))) & 0xFF;
+}
+ 
+/* Маска старших level байт ключа */
+static RadixKey prefixMask(int level) {
+    return (level == 0) ? 0 : ~(RadixKey) 0 << (8 * (KEY_BYTES - level));
+}
+ 
+static Header *createNode(NodeType type, int level, RadixKey prefix) {
+    Header *node = (Header *) calloc(1, nodeSizes[type]);
+    if (node == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    node->prefix = prefix;
+    node->level = (unsigned char) level;
+    node->type = (unsigned char) type;
+    return node;
+}
+ 
+/* Освобождает внутренние узлы; листья лежат в блоках дерева. Глубина не больше KEY_BYTES узлов */
+static void destroyChild(void *child) {
+    if (child == LSQ_HandleInvalid || IS_LEAF(child))
+        return;
+    int byte = -1;
+    void *next;
+    while ((next = nextChild((Header *) child, byte, &byte)) != LSQ_HandleInvalid)
+        destroyChild(next);
+    free(child);
+}
+ 
+/* Для Node4 и Node16 возвращает их упорядоченные массивы байт и сыновей */
+static int getSortedChildren(Header *node, unsigned char **keys, void ***children) {
+    if (node->type == NODE4) {
+        *keys = ((Node4 *) node)->keys;
+        *children = ((Node4 *) node)->children;
+        return 1;
+    }
+    if (node->type == NODE16) {
+        *keys = ((Node16 *) node)->keys;
+        *children = ((Node16 *) node)->children;
+        return 1;
+    }
+    return 0;
+}
+ 
+static uint64_t *getPresentBits(Header *node) {
+    return (node->type == NODE48) ? ((Node48 *) node)->present : ((Node256 *) node)->present;
+}
+ 
+/* Наименьший отмеченный байт, больший byte, или -1 */
+static int nextPresent(const uint64_t *present, int byte) {
+    byte++;
+    if (byte > 255)
+        return -1;
+    int word = byte >> 6;
+    uint64_t bits = present[word] & (~(uint64_t) 0 << (byte & 63));
+    while (bits == 0) {
+        if (++word == 4)
+            return -1;
+        bits = present[word];
+    }
+    return (word << 6) + __builtin_ctzll(bits);
+}
+ 
+/* Наибольший отмеченный байт, меньший byte, или -1 */
+static int previousPresent(const uint64_t *present, int byte) {
+    byte--;
+    if (byte < 0)
+        return -1;
+    int word = byte >> 6;
+    uint64_t bits = present[word] & (~(uint64_t) 0 >> (63 - (byte & 63)));
+    while (bits == 0) {
+        if (--word < 0)
+            return -1;
+        bits = present[word];
+    }
+    return (word << 6) + 63 - __builtin_clzll(bits);
+}
+ 
+/* Возвращает адрес ссылки на сына с байтом byte или LSQ_HandleInvalid. В Node16 байт ищется *
+ * одним сравнением SSE2 со всеми шестнадцатью ключами, а без SSE2 - перебором, как в Node4. */
+static void **findChild(Header *node, int byte) {
+    switch (node->type) {
+        case NODE4: {
+            Node4 *tmpNode = (Node4 *) node;
+            for (int i = 0; i < node->count; i++)
+                if (tmpNode->keys[i] == byte)
+                    return &tmpNode->children[i];
+            return LSQ_HandleInvalid;
+        }
+        case NODE16: {
+            Node16 *tmpNode = (Node16 *) node;
+#ifdef __SSE2__
+            __m128i keys = _mm_loadu_si128((__m128i *) tmpNode->keys);
+            int matches = _mm_movemask_epi8(_mm_cmpeq_epi8(keys, _mm_set1_epi8((char) byte)));
+            matches &= (1 << node->count) - 1;
+            return (matches != 0) ? &tmpNode->children[__builtin_ctz(matches)] : LSQ_HandleInvalid;
+#else
+            for (int i = 0; i < node->count; i++)
+                if (tmpNode->keys[i] == byte)
+                    return &tmpNode->children[i];
+            return LSQ_HandleInvalid;
+#endif
+        }
+        case NODE48: {
+            Node48 *tmpNode = (Node48 *) node;
+            int index = tmpNode->childIndex[byte];
+            return (index != 0) ? &tmpNode->children[index - 1] : LSQ_HandleInvalid;
+        }
+        default: {
+            Node256 *tmpNode = (Node256 *) node;
+            return (tmpNode->children[byte] != LSQ_HandleInvalid) ? &tmpNode->children[byte] : LSQ_HandleInvalid;
+        }
+    }
+}
+ 
+/* Сын с наименьшим байтом, большим byte (byte == -1 - первый сын); его байт пишется в childByte */
+static void *nextChild(Header *node, int byte, int *childByte) {
+    unsigned char *keys;
+    void **children;
+    if (getSortedChildren(node, &keys, &children)) {
+        for (int i = 0; i < node->count; i++)
+            if (keys[i] > byte) {
+                *childByte = keys[i];
+                return children[i];
+            }
+        return LSQ_HandleInvalid;
+    }
+    byte = nextPresent(getPresentBits(node), byte);
+    if (byte < 0)
+        return LSQ_HandleInvalid;
+    *childByte = byte;
+    return *findChild(node, byte);
+}
+ 
+/* Сын с наибольшим байтом, меньшим byte (byte == 256 - последний сын) */
+static void *previousChild(Header *node, int byte, int *childByte) {
+    unsigned char *keys;
+    void **children;
+    if (getSortedChildren(node, &keys, &children)) {
+        for (int i = node->count - 1; i >= 0; i--)
+            if (keys[i] < byte) {
+                *childByte = keys[i];
+                return children[i];
+            }
+        return LSQ_HandleInvalid;
+    }
+    byte = previousPresent(getPresentBits(node), byte);
+    if (byte < 0)
+        return LSQ_HandleInvalid;
+    *childByte = byte;
+    return *findChild(node, byte);
+}
+ 
+static Leaf *findLeaf(Tree *tree, RadixKey key) {
+    void *child = tree->root;
+    while (child != LSQ_HandleInvalid && !IS_LEAF(child)) {
+        Header *node = (Header *) child;
+        if ((key & prefixMask(node->level)) != node->prefix)
+            return LSQ_HandleInvalid;
+        void **slot = findChild(node, keyByte(key, node->level));
+        if (slot == LSQ_HandleInvalid)
+            return LSQ_HandleInvalid;
+        child = *slot;
+    }
+    if (child == LSQ_HandleInvalid || GET_LEAF(child)->key != key)
+        return LSQ_HandleInvalid;
+    return GET_LEAF(child);
+}
+ 
+/* Спуск к наименьшему листу поддерева child с записью пути начиная с depth */
+static Leaf *descendMin(Iterator *iterator, void *child, int depth) {
+    if (child == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    while (!IS_LEAF(child)) {
+        Header *node = (Header *) child;
+        iterator->path[depth].node = node;
+        child = nextChild(node, -1, &iterator->path[depth].byte);
+        depth++;
+    }
+    iterator->depth = depth;
+    return GET_LEAF(child);
+}
+ 
+static Leaf *descendMax(Iterator *iterator, void *child, int depth) {
+    if (child == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    while (!IS_LEAF(child)) {
+        Header *node = (Header *) child;
+        iterator->path[depth].node = node;
+        child = previousChild(node, 256, &iterator->path[depth].byte);
+        depth++;
+    }
+    iterator->depth = depth;
+    return GET_LEAF(child);
+}
+ 
+/* Ищет в поддереве child наименьший ключ, не меньший key, и записывает путь к нему начиная с depth */
+static Leaf *seekFrom(Iterator *iterator, void *child, int depth, RadixKey key) {
+    if (child == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    if (IS_LEAF(child)) {
+        iterator->depth = depth;
+        return (GET_LEAF(child)->key >= key) ? GET_LEAF(child) : LSQ_HandleInvalid;
+    }
+    Header *node = (Header *) child;
+    RadixKey prefix = key & prefixMask(node->level);
+    if (prefix != node->prefix)
+        return (prefix < node->prefix) ? descendMin(iterator, child, depth) : LSQ_HandleInvalid;
+ 
+    int byte = keyByte(key, node->level);
+    iterator->path[depth].node = node;
+    iterator->path[depth].byte = byte;
+    void **slot = findChild(node, byte);
+    if (slot != LSQ_HandleInvalid) {
+        Leaf *leaf = seekFrom(iterator, *slot, depth + 1, key);
+        if (leaf != LSQ_HandleInvalid)
+            return leaf;
+    }
+    child = nextChild(node, byte, &iterator->path[depth].byte);
+    return descendMin(iterator, child, depth + 1);
+}
+ 
+static void setLeaf(Iterator *iterator, Leaf *leaf) {
+    iterator->leaf = leaf;
+    iterator->position = (leaf == LSQ_HandleInvalid) ? POSITION_PAST_REAR : POSITION_ELEMENT;
+    if (leaf != LSQ_HandleInvalid)
+        iterator->key = leaf->key;
+}
+ 
+static void validateIterator(Iterator *iterator) {
+    Tree *tree = iterator->tree;
+    if (iterator->version == tree->version)
+        return;
+    iterator->version = tree->version;
+    if (iterator->position != POSITION_ELEMENT)
+        return;
+    setLeaf(iterator, seekFrom(iterator, tree->root, 0, iterator->key));
+}
+ 
+/* Вставка сына в узел, в котором заведомо есть место и нет байта byte */
+static void putChild(Header *node, int byte, void *child) {
+    unsigned char *keys;
+    void **children;
+    if (getSortedChildren(node, &keys, &children)) {
+        int position = node->count;
+        while (position > 0 && keys[position - 1] > byte) {
+            keys[position] = keys[position - 1];
+            children[position] = children[position - 1];
+            position--;
+        }
+        keys[position] = (unsigned char) byte;
+        children[position] = child;
+    }
+    else if (node->type == NODE48) {
+        Node48 *tmpNode = (Node48 *) node;
+        int index = 0;
+        while (tmpNode->children[index] != LSQ_HandleInvalid)
+            index++;
+        tmpNode->children[index] = child;
+        tmpNode->childIndex[byte] = (unsigned char) (index + 1);
+        tmpNode->present[byte >> 6] |= (uint64_t) 1 << (byte & 63);
+    }
+    else {
+        ((Node256 *) node)->children[byte] = child;
+        ((Node256 *) node)->present[byte >> 6] |= (uint64_t) 1 << (byte & 63);
+    }
+    node->count++;
+}
+ 
+/* Переносит сыновей в новый узел другого типа; старый узел освобождается */
+static Header *resizeNode(Header *node, NodeType type) {
+    Header *newNode = createNode(type, node->level, node->prefix);
+    if (newNode == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    int byte = -1;
+    void *child;
+    while ((child = nextChild(node, byte, &byte)) != LSQ_HandleInvalid)
+        putChild(newNode, byte, child);
+    free(node);
+    return newNode;
+}
+ 
+/* Добавляет сына в узел *slot, при переполнении узел заменяется следующим по размеру */
+static void addChild(void **slot, int byte, void *child) {
+    static const int capacities[] = {NODE4_CAPACITY, NODE16_CAPACITY, NODE48_CAPACITY, 256};
+    Header *node = (Header *) *slot;
+    if (node->count == capacities[node->type]) {
+        Header *newNode = resizeNode(node, (NodeType) (node->type + 1));
+        if (newNode == LSQ_HandleInvalid)
+            return;
+        *slot = node = newNode;
+    }
+    putChild(node, byte, child);
+}
+ 
+/* Удаляет сына с байтом byte из узла *slot. Недозаполненный узел заменяется меньшим с запасом, *
+ * чтобы чередование вставок и удалений не перестраивало узел каждый раз. Node4 с одним сыном   *
+ * заменяется этим сыном: уровни в узлах абсолютные, и префикс сына уже верен.                  */
+static void removeChild(void **slot, int byte) {
+    Header *node = (Header *) *slot;
+    unsigned char *keys;
+    void **children;
+    if (getSortedChildren(node, &keys, &children)) {
+        int position = 0;
+        while (keys[position] != byte)
+            position++;
+        memmove(keys + position, keys + position + 1, node->count - position - 1);
+        memmove(children + position, children + position + 1, (node->count - position - 1) * sizeof(void *));
+    }
+    else if (node->type == NODE48) {
+        Node48 *tmpNode = (Node48 *) node;
+        tmpNode->children[tmpNode->childIndex[byte] - 1] = LSQ_HandleInvalid;
+        tmpNode->childIndex[byte] = 0;
+        tmpNode->present[byte >> 6] &= ~((uint64_t) 1 << (byte & 63));
+    }
+    else {
+        ((Node256 *) node)->children[byte] = LSQ_HandleInvalid;
+        ((Node256 *) node)->present[byte >> 6] &= ~((uint64_t) 1 << (byte & 63));
+    }
+    node->count--;
+ 
+    Header *newNode = node;
+    if (node->type == NODE4 && node->count == 1) {
+        *slot = ((Node4 *) node)->children[0];
+        free(node);
+        return;
+    }
+    if (node->type == NODE16 && node->count == NODE4_CAPACITY - 1)
+        newNode = resizeNode(node, NODE4);
+    else if (node->type == NODE48 && node->count == NODE16_CAPACITY - 4)
+        newNode = resizeNode(node, NODE16);
+    else if (node->type == NODE256 && node->count == NODE48_CAPACITY - 11)
+        newNode = resizeNode(node, NODE48);
+    if (newNode != LSQ_HandleInvalid)
+        *slot = newNode;
+}
+ 
+static void deleteByKey(Tree *tree, RadixKey key) {
+    void **slot = &tree->root;
+    void **parentSlot = LSQ_HandleInvalid;
+    while (*slot != LSQ_HandleInvalid && !IS_LEAF(*slot)) {
+        Header *node = (Header *) *slot;
+        if ((key & prefixMask(node->level)) != node->prefix)
+            return;
+        void **next = findChild(node, keyByte(key, node->level));
+        if (next == LSQ_HandleInvalid)
+            return;
+        parentSlot = slot;
+        slot = next;
+    }
+    if (*slot != LSQ_HandleInvalid && GET_LEAF(*slot)->key == key)
+        removeLeaf(tree, parentSlot, slot);
+}
+ 
+/* Удаление наименьшего (rear == 0) или наибольшего элемента за один спуск */
+static void deleteExtreme(Tree *tree, int rear) {
+    void **slot = &tree->root;
+    void **parentSlot = LSQ_HandleInvalid;
+    while (!IS_LEAF(*slot)) {
+        Header *node = (Header *) *slot;
+        int byte;
+        if (rear)
+            previousChild(node, 256, &byte);
+        else
+            nextChild(node, -1, &byte);
+        parentSlot = slot;
+        slot = findChild(node, byte);
+    }
+    removeLeaf(tree, parentSlot, slot);
+}
+ 
+/* Удаляет лист *slot; parentSlot - ссылка на его родителя или LSQ_HandleInvalid, если лист - корень */
+static void removeLeaf(Tree *tree, void **parentSlot, void **slot) {
+    RadixKey key = GET_LEAF(*slot)->key;
+    releaseLeaf(tree, GET_LEAF(*slot));
+    if (parentSlot == LSQ_HandleInvalid)
+        tree->root = LSQ_HandleInvalid;
+    else
+        removeChild(parentSlot, keyByte(key, ((Header *) *parentSlot)->level));
+    tree->size--;
+    tree->version++;
+}
+ 
+/* Память внутренних узлов поддерева child; листья лежат в блоках и считаются отдельно */
+static size_t innerNodeBytes(void *child) {
+    if (child == LSQ_HandleInvalid || IS_LEAF(child))
+        return 0;
+    size_t bytes = nodeSizes[((Header *) child)->type];
+    int byte = -1;
+    void *next;
+    while ((next = nextChild((Header *) child, byte, &byte)) != LSQ_HandleInvalid)
+        bytes += innerNodeBytes(next);
+    return bytes;
+}
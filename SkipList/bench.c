@@ -0,0 +1,108 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include "linear_sequence_assoc.h"
+
+/* Один и тот же тест собирается и со списком с пропусками, и с деревом из ../Tree под общим мьютексом *
+ * (см. makefile): дерево не рассчитано на одновременный доступ. Однопоточные замеры всех контейнеров  *
+ * собраны в ../Benchmark, здесь - только смесь чтений и записей из нескольких потоков.                */
+#ifndef BENCH_BACKEND
+#define BENCH_BACKEND "SkipList"
+#endif
+
+#ifdef BENCH_LOCKED
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+#define LOCK() pthread_mutex_lock(&lock)
+#define UNLOCK() pthread_mutex_unlock(&lock)
+#else
+#define LOCK()
+#define UNLOCK()
+#endif
+
+#define KEY_RANGE 1000000
+#define OPERATIONS 2000000
+
+typedef struct {
+    LSQ_HandleT handle;
+    unsigned long long seed;
+    int operations;
+    int writePercent;
+    long long checksum;
+} Worker;
+
+static unsigned int nextRandom(unsigned long long *seed) {
+    *seed ^= *seed << 13;
+    *seed ^= *seed >> 7;
+    *seed ^= *seed << 17;
+    return (unsigned int) (*seed >> 32);
+}
+
+static double getTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+/* Записи поровну делятся на вставки и удаления, поэтому размер контейнера остается около KEY_RANGE / 2. *
+ * Ключ и вид операции берутся из разных чисел, чтобы доля записей не зависела от ключа.                */
+static void *runWorker(void *arg) {
+    Worker *worker = (Worker *) arg;
+    for (int i = 0; i < worker->operations; i++) {
+        LSQ_IntegerIndexT key = (LSQ_IntegerIndexT) (nextRandom(&worker->seed) % KEY_RANGE);
+        unsigned int choice = nextRandom(&worker->seed);
+        if ((int) ((choice >> 1) % 100) < worker->writePercent) {
+            LOCK();
+            if (choice & 1)
+                LSQ_InsertElement(worker->handle, key, key);
+            else
+                LSQ_DeleteElement(worker->handle, key);
+            UNLOCK();
+        } else {
+            LOCK();
+            LSQ_IteratorT iterator = LSQ_GetElementByIndex(worker->handle, key);
+            if (LSQ_IsIteratorDereferencable(iterator))
+                worker->checksum += *LSQ_DereferenceIterator(iterator);
+            LSQ_DestroyIterator(iterator);
+            UNLOCK();
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    static const int writePercents[] = {10, 50};
+    int maxThreads = (argc > 1) ? atoi(argv[1]) : 8;
+
+    for (int w = 0; w < 2; w++) {
+        for (int threads = 1; threads <= maxThreads; threads *= 2) {
+            LSQ_HandleT handle = LSQ_CreateSequence();
+            for (LSQ_IntegerIndexT key = 0; key < KEY_RANGE; key += 2)
+                LSQ_InsertElement(handle, key, key);
+
+            pthread_t ids[threads];
+            Worker workers[threads];
+            double start = getTime();
+            for (int t = 0; t < threads; t++) {
+                workers[t].handle = handle;
+                workers[t].seed = 88172645463325252ULL + t;
+                workers[t].operations = OPERATIONS / threads;
+                workers[t].writePercent = writePercents[w];
+                workers[t].checksum = 0;
+                pthread_create(&ids[t], NULL, runWorker, &workers[t]);
+            }
+            long long checksum = 0;
+            for (int t = 0; t < threads; t++) {
+                pthread_join(ids[t], NULL);
+                checksum += workers[t].checksum;
+            }
+            double elapsed = getTime() - start;
+
+            printf("%s: %d/%d read/write, %d threads: %.2f Mops/s, size %d (checksum %lld)\n",
+                   BENCH_BACKEND, 100 - writePercents[w], writePercents[w], threads,
+                   OPERATIONS / elapsed * 1e-6, LSQ_GetSize(handle), checksum);
+            LSQ_DestroySequence(handle);
+        }
+    }
+    return 0;
+}
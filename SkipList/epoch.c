@@ -0,0 +1,126 @@
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "epoch.h"
+
+#define EPOCH_COUNT 3
+#define RETIRE_THRESHOLD 64
+#define ACTIVE 1UL
+
+/* Запись потока. epoch - эпоха, сдвинутая на бит, и флаг ACTIVE нахождения в критической секции.        *
+ * Записи не освобождаются: при завершении потока запись отпускается и достается следующему потоку      *
+ * вместе с еще не освобожденными узлами.                                                                */
+typedef struct Participant_ {
+    atomic_ulong epoch;
+    atomic_int claimed;
+    int nesting;
+    unsigned long localEpoch;
+    EpochNode *limbo[EPOCH_COUNT];
+    unsigned long limboEpoch[EPOCH_COUNT];
+    int limboCount[EPOCH_COUNT];
+    struct Participant_ *next;
+} Participant;
+
+static atomic_ulong globalEpoch = 0;
+static Participant *_Atomic participants = NULL;
+static pthread_key_t participantKey;
+static pthread_once_t participantOnce = PTHREAD_ONCE_INIT;
+static _Thread_local Participant *self = NULL;
+
+static void releaseParticipant(void *participant) {
+    atomic_store(&((Participant *) participant)->claimed, 0);
+}
+
+static void createKey(void) {
+    pthread_key_create(&participantKey, releaseParticipant);
+}
+
+static Participant *acquireParticipant(void) {
+    pthread_once(&participantOnce, createKey);
+    Participant *participant;
+    for (participant = atomic_load(&participants); participant != NULL; participant = participant->next) {
+        int expected = 0;
+        if (atomic_load(&participant->claimed) == 0
+            && atomic_compare_exchange_strong(&participant->claimed, &expected, 1))
+            break;
+    }
+    if (participant == NULL) {
+        participant = (Participant *) calloc(1, sizeof(Participant));
+        if (participant == NULL)
+            abort();
+        atomic_init(&participant->claimed, 1);
+        participant->next = atomic_load(&participants);
+        while (!atomic_compare_exchange_weak(&participants, &participant->next, participant))
+            ;
+    }
+    pthread_setspecific(participantKey, participant);
+    return participant;
+}
+
+static void freeBucket(Participant *participant, int bucket) {
+    EpochNode *node = participant->limbo[bucket];
+    while (node != NULL) {
+        EpochNode *next = node->next;
+        free(node);
+        node = next;
+    }
+    participant->limbo[bucket] = NULL;
+    participant->limboCount[bucket] = 0;
+}
+
+/* Освобождает узлы, удаленные не позже чем за две эпохи до epoch */
+static void reclaim(Participant *participant, unsigned long epoch) {
+    for (int i = 0; i < EPOCH_COUNT; i++)
+        if (participant->limbo[i] != NULL && participant->limboEpoch[i] + 2 <= epoch)
+            freeBucket(participant, i);
+}
+
+/* Эпоха продвигается, только если все потоки в критических секциях уже видели текущую */
+static void tryAdvance(void) {
+    unsigned long epoch = atomic_load(&globalEpoch);
+    for (Participant *participant = atomic_load(&participants); participant != NULL; participant = participant->next) {
+        unsigned long state = atomic_load(&participant->epoch);
+        if ((state & ACTIVE) && (state >> 1) != epoch)
+            return;
+    }
+    atomic_compare_exchange_strong(&globalEpoch, &epoch, epoch + 1);
+}
+
+void epochEnter(void) {
+    if (self == NULL)
+        self = acquireParticipant();
+    if (self->nesting++ > 0)
+        return;
+    // эпоха публикуется повторно, пока она не совпадет с глобальной после публикации
+    unsigned long epoch;
+    do {
+        epoch = atomic_load(&globalEpoch);
+        atomic_store(&self->epoch, (epoch << 1) | ACTIVE);
+    } while (atomic_load(&globalEpoch) != epoch);
+    if (epoch != self->localEpoch) {
+        self->localEpoch = epoch;
+        reclaim(self, epoch);
+    }
+}
+
+void epochExit(void) {
+    if (--self->nesting > 0)
+        return;
+    atomic_store(&self->epoch, self->localEpoch << 1);
+    if (self->limboCount[0] + self->limboCount[1] + self->limboCount[2] >= RETIRE_THRESHOLD)
+        tryAdvance();
+}
+
+/* Узел помечается глобальной эпохой, а не эпохой потока: она может быть на единицу больше, и поток, *
+ * вошедший в нее до вырезания узла, еще может его читать.                                           */
+void epochRetire(EpochNode *node) {
+    unsigned long epoch = atomic_load(&globalEpoch);
+    int bucket = (int) (epoch % EPOCH_COUNT);
+    // корзина могла остаться от эпохи на три и более назад: ее узлы уже можно освободить
+    if (self->limbo[bucket] != NULL && self->limboEpoch[bucket] != epoch)
+        freeBucket(self, bucket);
+    self->limboEpoch[bucket] = epoch;
+    node->next = self->limbo[bucket];
+    self->limbo[bucket] = node;
+    self->limboCount[bucket]++;
+}
@@ -0,0 +1,20 @@
+#ifndef EPOCH_H
+#define EPOCH_H
+
+/* Освобождение памяти по эпохам. Поток читает разделяемые узлы только внутри критической секции. Удаленный *
+ * из структуры узел передается в epochRetire и освобождается, когда глобальная эпоха продвинется на две    *
+ * вперед: к этому времени все потоки, которые могли его видеть, уже покинули свои критические секции.      */
+
+/* Заголовок освобождаемого блока. Должен быть первым полем блока, выделенного malloc */
+typedef struct EpochNode_ {
+    struct EpochNode_ *next;
+} EpochNode;
+
+/* Функция, входящая в критическую секцию текущего потока. Вложенные входы допускаются */
+extern void epochEnter(void);
+/* Функция, выходящая из критической секции. Память освобождается только после выхода из внешней секции */
+extern void epochExit(void);
+/* Функция, откладывающая free(node) до безопасного момента. Вызывается внутри критической секции */
+extern void epochRetire(EpochNode *node);
+
+#endif
@@ -0,0 +1,525 @@
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include "linear_sequence_assoc.h"
+#include "epoch.h"
+#include "../Instrumentation/instrumentation.h"
+ 
+
+#define MAX_LEVEL 16
+#define MARK ((uintptr_t) 1)
+#define STATE_LINKING 1
+#define STATE_REMOVED 2
+ 
+/* Узел списка. Младший бит ссылки next[level] - пометка удаления узла на этом уровне; помеченная ссылка *
+ * больше не меняется. Узел удален из контейнера, когда помечена next[0]. Уровни выше нулевого - только *
+ * индекс для поиска. state согласует вставляющий и удаляющий потоки: узел освобождается тем из них,  *
+ * кто закончит последним (см. finishRemoval).                                                          */
+typedef struct Node_ {
+    EpochNode retired;
+    LSQ_IntegerIndexT key;
+    LSQ_BaseTypeT value;
+    atomic_int state;
+    int height;
+    atomic_uintptr_t next[];
+} Node;
+ 
+typedef struct SkipList_ {
+    Node *head;
+    atomic_int size;
+    /* Соседи в списке живых контейнеров */
+    struct SkipList_ *nextLive;
+    struct SkipList_ *prevLive;
+} SkipList;
+ 
+typedef enum {
+    POSITION_BEFORE_FIRST,
+    POSITION_ELEMENT,
+    POSITION_PAST_REAR
+} Position;
+ 
+/* Итератор держит критическую секцию своего потока от создания до уничтожения, поэтому его узел не *
+ * освобождается, даже если удален. Удаленный узел при обращении заменяется следующим живым.          */
+typedef struct {
+    SkipList *list;
+    Position position;
+    Node *node;
+} Iterator;
+ 
+LIVE_CONTAINERS(SkipList)
+ 
+static Iterator *createIterator(SkipList *, Position );
+static Node *createNode(LSQ_IntegerIndexT , LSQ_BaseTypeT , int );
+static Node *getNode(uintptr_t );
+static int isMarked(uintptr_t );
+static int isRemoved(Node *);
+static int randomLevel(void);
+static int find(SkipList *, LSQ_IntegerIndexT , Node **, Node **);
+static Node *search(SkipList *, LSQ_IntegerIndexT , Node **);
+static Node *findLast(SkipList *);
+static Node *nextAlive(Node *);
+static void setNode(Iterator *, Node *);
+static void validateIterator(Iterator *);
+static int removeNode(SkipList *, Node *);
+static void finishRemoval(Node *, int );
+ 
+LSQ_HandleT LSQ_CreateSequence(void) {
+    SkipList *newList = (SkipList *) malloc(sizeof(SkipList));
+    if (newList == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newList->head = createNode(0, 0, MAX_LEVEL);
+    if (newList->head == LSQ_HandleInvalid) {
+        free(newList);
+        return LSQ_HandleInvalid;
+    }
+    atomic_init(&newList->size, 0);
+    registerContainer(newList);
+    return newList;
+}
+ 
+/* Вызывается, когда с контейнером больше никто не работает. Узлы, уже переданные в epochRetire, *
+ * освобождаются механизмом эпох.                                                                 */
+void LSQ_DestroySequence(LSQ_HandleT handle) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    unregisterContainer(tmpList);
+    Node *node = tmpList->head;
+    while (node != LSQ_HandleInvalid) {
+        Node *next = getNode(atomic_load(&node->next[0]));
+        free(node);
+        node = next;
+    }
+    free(tmpList);
+}
+ 
+LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle){
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid) {
+        return 0;
+    }
+    return atomic_load(&tmpList->size);
+}
+ 
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    size_t elements = 0;
+    size_t bytes = sizeof(SkipList);
+    epochEnter();
+    for (Node *node = tmpList->head; node != LSQ_HandleInvalid; node = getNode(atomic_load(&node->next[0]))) {
+        bytes += sizeof(Node) + node->height * sizeof(atomic_uintptr_t);
+        elements += (node != tmpList->head && !isRemoved(node));
+    }
+    epochExit();
+    usage->payload = elements * (sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT));
+    usage->overhead = bytes - usage->payload;
+}
+ 
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (SkipList *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+ 
+
+int LSQ_IsIteratorDereferencable(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_ELEMENT;
+}
+ 
+extern int LSQ_IsIteratorPastRear(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_PAST_REAR;
+}
+ 
+extern int LSQ_IsIteratorBeforeFirst(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_BEFORE_FIRST;
+}
+ 
+extern LSQ_BaseTypeT* LSQ_DereferenceIterator(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return &tmpIterator->node->value;
+}
+ 
+extern LSQ_IntegerIndexT LSQ_GetIteratorKey(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)){
+        return -1;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return tmpIterator->node->key;
+}
+ 
+extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = createIterator(tmpList, POSITION_PAST_REAR);
+    if (tmpIterator != LSQ_HandleInvalid)
+        LSQ_SetPosition(tmpIterator, index);
+    return tmpIterator;
+}
+ 
+extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Iterator *tmpIterator = createIterator(tmpList, POSITION_BEFORE_FIRST);
+    LSQ_AdvanceOneElement(tmpIterator);
+    return tmpIterator;
+}
+ 
+extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpList, POSITION_PAST_REAR);
+}
+ 
+extern void LSQ_DestroyIterator(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return;
+    free(tmpIterator);
+    epochExit();
+}
+ 
+
+extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *)iterator;
+    if (tmpIterator == LSQ_HandleInvalid || LSQ_IsIteratorPastRear(tmpIterator))
+        return;
+    if (tmpIterator->position == POSITION_BEFORE_FIRST)
+        setNode(tmpIterator, nextAlive(tmpIterator->list->head));
+    else
+        setNode(tmpIterator, nextAlive(tmpIterator->node));
+}
+ 
+/* Обратных ссылок в списке нет: предыдущий элемент ищется спуском от головы */
+extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || LSQ_IsIteratorBeforeFirst(tmpIterator))
+        return;
+    SkipList *tmpList = tmpIterator->list;
+    Node *previous;
+    if (tmpIterator->position == POSITION_PAST_REAR)
+        previous = findLast(tmpList);
+    else
+        search(tmpList, tmpIterator->node->key, &previous);
+    if (previous == tmpList->head) {
+        tmpIterator->node = LSQ_HandleInvalid;
+        tmpIterator->position = POSITION_BEFORE_FIRST;
+        return;
+    }
+    setNode(tmpIterator, previous);
+}
+ 
+
+extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || shift == 0)
+        return;
+    if (shift > 0) {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorPastRear(tmpIterator); i--) {
+            LSQ_AdvanceOneElement(tmpIterator);
+        }
+    }
+    else {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorBeforeFirst(tmpIterator); i++) {
+            LSQ_RewindOneElement(tmpIterator);
+        }
+    }
+}
+ 
+/* Как и в LSQ_GetElementByIndex, номер элемента ассоциативного контейнера - его ключ */
+extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid) {
+        return;
+    }
+    Node *node = search(tmpIterator->list, pos, LSQ_HandleInvalid);
+    setNode(tmpIterator, (node != LSQ_HandleInvalid && node->key == pos) ? node : LSQ_HandleInvalid);
+}
+ 
+/* Вставка по Herlihy-Shavit: элемент появляется в контейнере, когда его узел подвешен на нулевом уровне; *
+ * верхние уровни достраиваются после, пока узел не удален.                                               */
+extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    Node *preds[MAX_LEVEL];
+    Node *succs[MAX_LEVEL];
+    Node *node = LSQ_HandleInvalid;
+    epochEnter();
+    while (1) {
+        if (find(tmpList, key, preds, succs)) {
+            __atomic_store_n(&succs[0]->value, value, __ATOMIC_RELEASE);
+            free(node);
+            epochExit();
+            return;
+        }
+        if (node == LSQ_HandleInvalid) {
+            node = createNode(key, value, randomLevel());
+            if (node == LSQ_HandleInvalid) {
+                epochExit();
+                return;
+            }
+        }
+        for (int level = 0; level < node->height; level++)
+            atomic_store_explicit(&node->next[level], (uintptr_t) succs[level], memory_order_relaxed);
+        uintptr_t expected = (uintptr_t) succs[0];
+        if (atomic_compare_exchange_strong(&preds[0]->next[0], &expected, (uintptr_t) node))
+            break;
+    }
+    atomic_fetch_add(&tmpList->size, 1);
+ 
+    for (int level = 1; level < node->height; level++) {
+        while (1) {
+            uintptr_t link = atomic_load(&node->next[level]);
+            if (isMarked(link))
+                goto linked;
+            if (getNode(link) != succs[level] && !atomic_compare_exchange_strong(&node->next[level], &link,
+                                                                                (uintptr_t) succs[level]))
+                goto linked;
+            uintptr_t expected = (uintptr_t) succs[level];
+            if (atomic_compare_exchange_strong(&preds[level]->next[level], &expected, (uintptr_t) node))
+                break;
+            if (!find(tmpList, key, preds, succs) || succs[0] != node)
+                goto linked;
+        }
+    }
+linked:
+    // узел могли удалить, пока достраивались уровни: поздно подвешенные уровни снимает find
+    if (isRemoved(node))
+        find(tmpList, key, preds, succs);
+    finishRemoval(node, STATE_LINKING);
+    epochExit();
+}
+ 
+extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    epochEnter();
+    Node *node;
+    while ((node = nextAlive(tmpList->head)) != LSQ_HandleInvalid && !removeNode(tmpList, node))
+        ;
+    epochExit();
+}
+ 
+extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    epochEnter();
+    Node *node;
+    while ((node = findLast(tmpList)) != tmpList->head && !removeNode(tmpList, node))
+        ;
+    epochExit();
+}
+ 
+extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
+    SkipList *tmpList = (SkipList *) handle;
+    if (tmpList == LSQ_HandleInvalid)
+        return;
+    Node *preds[MAX_LEVEL];
+    Node *succs[MAX_LEVEL];
+    epochEnter();
+    while (find(tmpList, key, preds, succs) && !removeNode(tmpList, succs[0]))
+        ;
+    epochExit();
+}
+ 
+static Iterator *createIterator(SkipList *list, Position position) {
+    Iterator *newIterator = (Iterator *) malloc(sizeof(Iterator));
+    if (newIterator == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newIterator->list = list;
+    newIterator->position = position;
+    newIterator->node = LSQ_HandleInvalid;
+    epochEnter();
+    return newIterator;
+}
+ 
+static Node *createNode(LSQ_IntegerIndexT key, LSQ_BaseTypeT value, int height) {
+    Node *node = (Node *) malloc(sizeof(Node) + height * sizeof(atomic_uintptr_t));
+    if (node == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    node->key = key;
+    node->value = value;
+    atomic_init(&node->state, STATE_LINKING);
+    node->height = height;
+    for (int level = 0; level < height; level++)
+        atomic_init(&node->next[level], (uintptr_t) 0);
+    return node;
+}
+ 
+static Node *getNode(uintptr_t link) {
+    return (Node *) (link & ~MARK);
+}
+ 
+static int isMarked(uintptr_t link) {
+    return (int) (link & MARK);
+}
+ 
+static int isRemoved(Node *node) {
+    return isMarked(atomic_load(&node->next[0]));
+}
+ 
+/* Высота узла распределена геометрически с p = 1/4 */
+static int randomLevel(void) {
+    static _Thread_local unsigned long long seed = 0;
+    if (seed == 0)
+        seed = (unsigned long long) (uintptr_t) &seed | 1;
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return 1 + __builtin_ctzll(seed | (1ULL << (2 * (MAX_LEVEL - 1)))) / 2;
+}
+ 
+/* Заполняет на каждом уровне последний узел с ключом меньше key и следующий за ним, попутно вырезая *
+ * помеченные узлы. Если вырезать не удалось (сосед изменился), поиск начинается заново.              */
+static int find(SkipList *list, LSQ_IntegerIndexT key, Node **preds, Node **succs) {
+retry:;
+    Node *pred = list->head;
+    Node *curr = LSQ_HandleInvalid;
+    for (int level = MAX_LEVEL - 1; level >= 0; level--) {
+        curr = getNode(atomic_load(&pred->next[level]));
+        while (curr != LSQ_HandleInvalid) {
+            uintptr_t link = atomic_load(&curr->next[level]);
+            while (isMarked(link)) {
+                uintptr_t expected = (uintptr_t) curr;
+                if (!atomic_compare_exchange_strong(&pred->next[level], &expected, link & ~MARK))
+                    goto retry;
+                curr = getNode(link);
+                if (curr == LSQ_HandleInvalid)
+                    break;
+                link = atomic_load(&curr->next[level]);
+            }
+            if (curr == LSQ_HandleInvalid || curr->key >= key)
+                break;
+            pred = curr;
+            curr = getNode(link);
+        }
+        preds[level] = pred;
+        succs[level] = curr;
+    }
+    return curr != LSQ_HandleInvalid && curr->key == key;
+}
+ 
+/* Поиск без изменения списка: возвращает первый живой узел с ключом не меньше key, в *predecessor - *
+ * последний узел с меньшим ключом или голову.                                                      */
+static Node *search(SkipList *list, LSQ_IntegerIndexT key, Node **predecessor) {
+    Node *pred = list->head;
+    Node *curr = LSQ_HandleInvalid;
+    for (int level = MAX_LEVEL - 1; level >= 0; level--) {
+        curr = getNode(atomic_load(&pred->next[level]));
+        while (curr != LSQ_HandleInvalid) {
+            uintptr_t link = atomic_load(&curr->next[level]);
+            if (!isMarked(link)) {
+                if (curr->key >= key)
+                    break;
+                pred = curr;
+            }
+            curr = getNode(link);
+        }
+    }
+    if (predecessor != LSQ_HandleInvalid)
+        *predecessor = pred;
+    return curr;
+}
+ 
+/* Последний живой узел или голова, если список пуст */
+static Node *findLast(SkipList *list) {
+    Node *pred = list->head;
+    for (int level = MAX_LEVEL - 1; level >= 0; level--) {
+        Node *curr = getNode(atomic_load(&pred->next[level]));
+        while (curr != LSQ_HandleInvalid) {
+            uintptr_t link = atomic_load(&curr->next[level]);
+            if (!isMarked(link))
+                pred = curr;
+            curr = getNode(link);
+        }
+    }
+    return pred;
+}
+ 
+static Node *nextAlive(Node *node) {
+    node = getNode(atomic_load(&node->next[0]));
+    while (node != LSQ_HandleInvalid && isRemoved(node))
+        node = getNode(atomic_load(&node->next[0]));
+    return node;
+}
+ 
+static void setNode(Iterator *iterator, Node *node) {
+    iterator->node = node;
+    iterator->position = (node == LSQ_HandleInvalid) ? POSITION_PAST_REAR : POSITION_ELEMENT;
+}
+ 
+static void validateIterator(Iterator *iterator) {
+    if (iterator->position == POSITION_ELEMENT && isRemoved(iterator->node))
+        setNode(iterator, nextAlive(iterator->node));
+}
+ 
+/* Помечает уровни узла сверху вниз. Удаляет элемент тот поток, чья пометка нулевого уровня прошла; *
+ * он же вырезает узел повторным find. Возвращает 0, если узел уже удалил другой поток.            */
+static int removeNode(SkipList *list, Node *node) {
+    for (int level = node->height - 1; level >= 1; level--) {
+        uintptr_t link = atomic_load(&node->next[level]);
+        while (!isMarked(link))
+            atomic_compare_exchange_weak(&node->next[level], &link, link | MARK);
+    }
+    uintptr_t link = atomic_load(&node->next[0]);
+    while (1) {
+        if (isMarked(link))
+            return 0;
+        if (atomic_compare_exchange_weak(&node->next[0], &link, link | MARK))
+            break;
+    }
+    atomic_fetch_sub(&list->size, 1);
+    Node *preds[MAX_LEVEL];
+    Node *succs[MAX_LEVEL];
+    find(list, node->key, preds, succs);
+    finishRemoval(node, STATE_REMOVED);
+    return 1;
+}
+ 
+/* Вставляющий поток снимает STATE_LINKING, закончив подвешивать уровни, удаливший ставит STATE_REMOVED *
+ * после своего find. Каждый из них перед этим убедился, что его find прошел после последнего          *
+ * подвешенного уровня, поэтому второй из них передает узел на освобождение: узел вырезан отовсюду.   */
+static void finishRemoval(Node *node, int step) {
+    int state;
+    if (step == STATE_LINKING)
+        state = atomic_fetch_and(&node->state, ~STATE_LINKING) & STATE_REMOVED;
+    else
+        state = !(atomic_fetch_or(&node->state, STATE_REMOVED) & STATE_LINKING);
+    if (state)
+        epochRetire(&node->retired);
+}
@@ -0,0 +1,24 @@
+#ifndef AVL_TREE_KEYS_H
+#define AVL_TREE_KEYS_H
+
+#include <stdint.h>
+
+/* Составной 16-байтовый ключ, упорядочен лексикографически по (high, low) */
+typedef struct {
+    uint64_t high;
+    uint64_t low;
+} LSQ_Key128T;
+
+/* Дерево с 64-битными ключами: Key64Tree_CreateSequence, Key64Tree_InsertElement и т. д. */
+#define AVL_NAME Key64Tree
+#define AVL_KEY_TYPE int64_t
+#define AVL_KEY_LESS(a, b) ((a) < (b))
+#include "avl_tree_template.h"
+
+/* Дерево с 16-байтовыми ключами: Key128Tree_CreateSequence, Key128Tree_InsertElement и т. д. */
+#define AVL_NAME Key128Tree
+#define AVL_KEY_TYPE LSQ_Key128T
+#define AVL_KEY_LESS(a, b) ((a).high < (b).high || ((a).high == (b).high && (a).low < (b).low))
+#include "avl_tree_template.h"
+
+#endif
@@ -0,0 +1,279 @@
+/* Шаблон AVL-дерева, у которого тип ключа и сравнение задаются на этапе компиляции.               *
+ * Сравнение подставляется в код спуска, вызова функции через указатель нет. Перед включением нужно  *
+ * определить:                                                                                       *
+ *   AVL_NAME             - имя типа дерева, оно же префикс имен функций (например, Key64Tree)        *
+ *   AVL_KEY_TYPE         - тип ключа                                                                *
+ *   AVL_KEY_LESS(a, b)   - выражение, истинное, если ключ a строго меньше ключа b                    *
+ * Файл можно включать несколько раз с разными параметрами, параметры после включения сбрасываются.  */
+
+#include <stdlib.h>
+#include "linear_sequence_assoc.h"
+
+#if !defined(AVL_NAME) || !defined(AVL_KEY_TYPE) || !defined(AVL_KEY_LESS)
+#error "AVL_NAME, AVL_KEY_TYPE and AVL_KEY_LESS must be defined before including avl_tree_template.h"
+#endif
+
+#ifndef AVL_JOIN
+#define AVL_JOIN_(a, b) a##_##b
+#define AVL_JOIN(a, b) AVL_JOIN_(a, b)
+#define AVL_ITEM(name) AVL_JOIN(AVL_NAME, name)
+#define AVL_MAXIMUM(a, b) ((a) > (b) ? (a) : (b))
+#endif
+
+typedef struct AVL_ITEM(Node_) {
+    AVL_KEY_TYPE key;
+    LSQ_BaseTypeT value;
+    LSQ_IntegerIndexT height;
+    struct AVL_ITEM(Node_) *parent;
+    struct AVL_ITEM(Node_) *leftChild;
+    struct AVL_ITEM(Node_) *rightChild;
+} AVL_ITEM(Node);
+
+typedef struct {
+    AVL_ITEM(Node) *root;
+    LSQ_IntegerIndexT size;
+} AVL_NAME;
+
+/* Функция, создающая пустое дерево */
+static inline AVL_NAME *AVL_ITEM(CreateSequence)(void) {
+    AVL_NAME *newTree = (AVL_NAME *) malloc(sizeof(AVL_NAME));
+    if (newTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newTree->root = LSQ_HandleInvalid;
+    newTree->size = 0;
+    return newTree;
+}
+
+/* Функция, уничтожающая дерево. Узлы освобождаются без рекурсии: левые поддеревья поворотами *
+ * переносятся вправо, после чего узел без левого сына освобождается                          */
+static inline void AVL_ITEM(DestroySequence)(AVL_NAME *tree) {
+    if (tree == LSQ_HandleInvalid)
+        return;
+    AVL_ITEM(Node) *node = tree->root;
+    while (node != LSQ_HandleInvalid) {
+        AVL_ITEM(Node) *next = node->leftChild;
+        if (next != LSQ_HandleInvalid) {
+            node->leftChild = next->rightChild;
+            next->rightChild = node;
+        }
+        else {
+            next = node->rightChild;
+            free(node);
+        }
+        node = next;
+    }
+    free(tree);
+}
+
+/* Функция, возвращающая количество элементов дерева */
+static inline LSQ_IntegerIndexT AVL_ITEM(GetSize)(AVL_NAME *tree) {
+    return (tree == LSQ_HandleInvalid) ? 0 : tree->size;
+}
+
+static inline LSQ_IntegerIndexT AVL_ITEM(getHeight)(AVL_ITEM(Node) *node) {
+    return (node != LSQ_HandleInvalid) ? node->height : -1;
+}
+
+static inline void AVL_ITEM(fixHeight)(AVL_ITEM(Node) *node) {
+    node->height = AVL_MAXIMUM(AVL_ITEM(getHeight)(node->leftChild), AVL_ITEM(getHeight)(node->rightChild)) + 1;
+}
+
+static inline LSQ_IntegerIndexT AVL_ITEM(getBalanceFactor)(AVL_ITEM(Node) *node) {
+    return AVL_ITEM(getHeight)(node->leftChild) - AVL_ITEM(getHeight)(node->rightChild);
+}
+
+static inline void AVL_ITEM(replaceChild)(AVL_NAME *tree, AVL_ITEM(Node) *parent, AVL_ITEM(Node) *node,
+                                          AVL_ITEM(Node) *substitute) {
+    if (substitute != LSQ_HandleInvalid)
+        substitute->parent = parent;
+    if (parent == LSQ_HandleInvalid)
+        tree->root = substitute;
+    else if (parent->leftChild == node)
+        parent->leftChild = substitute;
+    else
+        parent->rightChild = substitute;
+}
+
+static inline AVL_ITEM(Node) *AVL_ITEM(leftRotation)(AVL_NAME *tree, AVL_ITEM(Node) *root) {
+    AVL_ITEM(Node) *newRoot = root->rightChild;
+    root->rightChild = newRoot->leftChild;
+    if (newRoot->leftChild != LSQ_HandleInvalid)
+        newRoot->leftChild->parent = root;
+    AVL_ITEM(replaceChild)(tree, root->parent, root, newRoot);
+    newRoot->leftChild = root;
+    root->parent = newRoot;
+    AVL_ITEM(fixHeight)(root);
+    AVL_ITEM(fixHeight)(newRoot);
+    return newRoot;
+}
+
+static inline AVL_ITEM(Node) *AVL_ITEM(rightRotation)(AVL_NAME *tree, AVL_ITEM(Node) *root) {
+    AVL_ITEM(Node) *newRoot = root->leftChild;
+    root->leftChild = newRoot->rightChild;
+    if (newRoot->rightChild != LSQ_HandleInvalid)
+        newRoot->rightChild->parent = root;
+    AVL_ITEM(replaceChild)(tree, root->parent, root, newRoot);
+    newRoot->rightChild = root;
+    root->parent = newRoot;
+    AVL_ITEM(fixHeight)(root);
+    AVL_ITEM(fixHeight)(newRoot);
+    return newRoot;
+}
+
+static inline AVL_ITEM(Node) *AVL_ITEM(balancing)(AVL_NAME *tree, AVL_ITEM(Node) *root) {
+    LSQ_IntegerIndexT balanceFactor = AVL_ITEM(getBalanceFactor)(root);
+    if (balanceFactor == 2) {
+        if (AVL_ITEM(getBalanceFactor)(root->leftChild) < 0)
+            AVL_ITEM(leftRotation)(tree, root->leftChild);
+        return AVL_ITEM(rightRotation)(tree, root);
+    }
+    if (balanceFactor == -2) {
+        if (AVL_ITEM(getBalanceFactor)(root->rightChild) > 0)
+            AVL_ITEM(rightRotation)(tree, root->rightChild);
+        return AVL_ITEM(leftRotation)(tree, root);
+    }
+    return root;
+}
+
+/* Функция, добавляющая пару ключ-значение. Если ключ уже есть, его значение обновляется */
+static inline void AVL_ITEM(InsertElement)(AVL_NAME *tree, AVL_KEY_TYPE key, LSQ_BaseTypeT value) {
+    if (tree == LSQ_HandleInvalid)
+        return;
+    AVL_ITEM(Node) *parent = LSQ_HandleInvalid;
+    AVL_ITEM(Node) *node = tree->root;
+    int goLeft = 0;
+    while (node != LSQ_HandleInvalid) {
+        parent = node;
+        if (AVL_KEY_LESS(key, node->key)) {
+            node = node->leftChild;
+            goLeft = 1;
+        }
+        else if (AVL_KEY_LESS(node->key, key)) {
+            node = node->rightChild;
+            goLeft = 0;
+        }
+        else {
+            node->value = value;
+            return;
+        }
+    }
+
+    AVL_ITEM(Node) *newNode = (AVL_ITEM(Node) *) malloc(sizeof(AVL_ITEM(Node)));
+    if (newNode == LSQ_HandleInvalid)
+        return;
+    newNode->key = key;
+    newNode->value = value;
+    newNode->height = 0;
+    newNode->parent = parent;
+    newNode->leftChild = newNode->rightChild = LSQ_HandleInvalid;
+    if (parent == LSQ_HandleInvalid)
+        tree->root = newNode;
+    else if (goLeft)
+        parent->leftChild = newNode;
+    else
+        parent->rightChild = newNode;
+    tree->size++;
+
+    while (parent != LSQ_HandleInvalid) {
+        LSQ_IntegerIndexT oldHeight = parent->height;
+        AVL_ITEM(fixHeight)(parent);
+        LSQ_IntegerIndexT balanceFactor = AVL_ITEM(getBalanceFactor)(parent);
+        if (balanceFactor == 2 || balanceFactor == -2) {
+            AVL_ITEM(balancing)(tree, parent);
+            return;
+        }
+        if (parent->height == oldHeight)
+            return;
+        parent = parent->parent;
+    }
+}
+
+/* Функция, возвращающая указатель на значение с заданным ключом или NULL, если ключа нет */
+static inline LSQ_BaseTypeT *AVL_ITEM(GetElementByKey)(AVL_NAME *tree, AVL_KEY_TYPE key) {
+    if (tree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    AVL_ITEM(Node) *node = tree->root;
+    while (node != LSQ_HandleInvalid) {
+        if (AVL_KEY_LESS(key, node->key))
+            node = node->leftChild;
+        else if (AVL_KEY_LESS(node->key, key))
+            node = node->rightChild;
+        else
+            return &node->value;
+    }
+    return LSQ_HandleInvalid;
+}
+
+/* Функция, возвращающая первый в порядке ключей узел дерева или NULL */
+static inline AVL_ITEM(Node) *AVL_ITEM(GetFrontNode)(AVL_NAME *tree) {
+    AVL_ITEM(Node) *node = (tree == LSQ_HandleInvalid) ? LSQ_HandleInvalid : tree->root;
+    if (node == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    while (node->leftChild != LSQ_HandleInvalid)
+        node = node->leftChild;
+    return node;
+}
+
+/* Функция, возвращающая следующий в порядке ключей узел или NULL */
+static inline AVL_ITEM(Node) *AVL_ITEM(GetNextNode)(AVL_ITEM(Node) *node) {
+    if (node->rightChild != LSQ_HandleInvalid) {
+        node = node->rightChild;
+        while (node->leftChild != LSQ_HandleInvalid)
+            node = node->leftChild;
+        return node;
+    }
+    while (node->parent != LSQ_HandleInvalid && node == node->parent->rightChild)
+        node = node->parent;
+    return node->parent;
+}
+
+/* Функция, удаляющая элемент с заданным ключом */
+static inline void AVL_ITEM(DeleteElement)(AVL_NAME *tree, AVL_KEY_TYPE key) {
+    if (tree == LSQ_HandleInvalid)
+        return;
+    AVL_ITEM(Node) *node = tree->root;
+    while (node != LSQ_HandleInvalid) {
+        if (AVL_KEY_LESS(key, node->key))
+            node = node->leftChild;
+        else if (AVL_KEY_LESS(node->key, key))
+            node = node->rightChild;
+        else
+            break;
+    }
+    if (node == LSQ_HandleInvalid)
+        return;
+
+    AVL_ITEM(Node) *start = node->parent;
+    if (node->leftChild == LSQ_HandleInvalid) {
+        AVL_ITEM(replaceChild)(tree, node->parent, node, node->rightChild);
+    }
+    else if (node->rightChild == LSQ_HandleInvalid) {
+        AVL_ITEM(replaceChild)(tree, node->parent, node, node->leftChild);
+    }
+    else {
+        AVL_ITEM(Node) *successor = node->rightChild;
+        while (successor->leftChild != LSQ_HandleInvalid)
+            successor = successor->leftChild;
+        start = successor;
+        if (successor->parent != node) {
+            start = successor->parent;
+            AVL_ITEM(replaceChild)(tree, successor->parent, successor, successor->rightChild);
+            successor->rightChild = node->rightChild;
+            successor->rightChild->parent = successor;
+        }
+        AVL_ITEM(replaceChild)(tree, node->parent, node, successor);
+        successor->leftChild = node->leftChild;
+        successor->leftChild->parent = successor;
+    }
+    free(node);
+    tree->size--;
+
+    while (start != LSQ_HandleInvalid) {
+        AVL_ITEM(fixHeight)(start);
+        start = AVL_ITEM(balancing)(tree, start)->parent;
+    }
+}
+
+#undef AVL_NAME
+#undef AVL_KEY_TYPE
+#undef AVL_KEY_LESS
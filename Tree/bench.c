@@ -0,0 +1,422 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <malloc.h>
+#include "linear_sequence_assoc.h"
+#include "avl_tree_keys.h"
+
+/* То же дерево с 64-битным ключом, но сравнение через указатель на функцию, как в qsort */
+static int compareInt64(const int64_t *first, const int64_t *second) {
+    return (*first > *second) - (*first < *second);
+}
+
+int (*keyComparator)(const int64_t *, const int64_t *) = compareInt64;
+
+#define AVL_NAME PointerKeyTree
+#define AVL_KEY_TYPE int64_t
+#define AVL_KEY_LESS(a, b) (keyComparator(&(a), &(b)) < 0)
+#include "avl_tree_template.h"
+
+static unsigned long long seed = 88172645463325252ULL;
+
+static unsigned int nextRandom(void) {
+    seed ^= seed << 13;
+    seed ^= seed >> 7;
+    seed ^= seed << 17;
+    return (unsigned int) (seed >> 32);
+}
+
+static double getTime(void) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+static LSQ_HandleT createRandomTree(LSQ_IntegerIndexT size, LSQ_IntegerIndexT range) {
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) malloc(size * sizeof(LSQ_IntegerIndexT));
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        keys[i] = (LSQ_IntegerIndexT) (nextRandom() % range);
+    LSQ_InsertBatch(handle, keys, keys, size);
+    free(keys);
+    return handle;
+}
+
+static void benchSetOperations(void) {
+    static const char *names[] = {"union", "intersect", "difference"};
+    static const LSQ_IntegerIndexT threads[] = {1, 2, 4, 8};
+    LSQ_IntegerIndexT size = 1000000;
+
+    for (int operation = 0; operation < 3; operation++) {
+        for (int t = 0; t < 4; t++) {
+            LSQ_SetThreadCount(threads[t]);
+            seed = 1;
+            LSQ_HandleT first = createRandomTree(size, 4 * size);
+            LSQ_HandleT second = createRandomTree(size, 4 * size);
+            double start = getTime();
+            if (operation == 0)
+                LSQ_Union(first, second);
+            else if (operation == 1)
+                LSQ_Intersect(first, second);
+            else
+                LSQ_Difference(first, second);
+            double elapsed = getTime() - start;
+            printf("%-10s n=m=%d threads=%d: %8.2f ms, result %d\n", names[operation], size, threads[t],
+                   elapsed * 1e3, LSQ_GetSize(first));
+            LSQ_DestroySequence(first);
+            LSQ_DestroySequence(second);
+        }
+    }
+
+    seed = 1;
+    LSQ_HandleT first = createRandomTree(size, 4 * size);
+    LSQ_HandleT second = createRandomTree(size, 4 * size);
+    double start = getTime();
+    LSQ_IteratorT iterator = LSQ_GetFrontElement(second);
+    for (; !LSQ_IsIteratorPastRear(iterator); LSQ_AdvanceOneElement(iterator))
+        LSQ_InsertElement(first, LSQ_GetIteratorKey(iterator), *LSQ_DereferenceIterator(iterator));
+    LSQ_DestroyIterator(iterator);
+    printf("%-10s n=m=%d element by element: %8.2f ms\n", "union", size, (getTime() - start) * 1e3);
+    LSQ_DestroySequence(first);
+    LSQ_DestroySequence(second);
+}
+
+static size_t getHeapUsage(void) {
+    struct mallinfo2 info = mallinfo2();
+    return info.uordblks + info.hblkhd;
+}
+
+static double lookupKeys(LSQ_HandleT handle, const LSQ_IntegerIndexT *keys, LSQ_IntegerIndexT count,
+                         long long *checksum) {
+    double start = getTime();
+    for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+        LSQ_IteratorT iterator = LSQ_GetElementByIndex(handle, keys[i]);
+        if (LSQ_IsIteratorDereferencable(iterator))
+            *checksum += *LSQ_DereferenceIterator(iterator);
+        LSQ_DestroyIterator(iterator);
+    }
+    return (getTime() - start) * 1e9 / count;
+}
+
+static void benchHashIndex(void) {
+    static const LSQ_IntegerIndexT sizes[] = {1000, 100000, 1000000, 4000000};
+    LSQ_IntegerIndexT lookups = 2000000;
+    LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) malloc(lookups * sizeof(LSQ_IntegerIndexT));
+
+    for (int s = 0; s < 4; s++) {
+        LSQ_IntegerIndexT size = sizes[s];
+        seed = 1;
+        size_t heapBefore = getHeapUsage();
+        LSQ_HandleT handle = createRandomTree(size, 2 * size);
+        size_t treeBytes = getHeapUsage() - heapBefore;
+        for (LSQ_IntegerIndexT i = 0; i < lookups; i++)
+            keys[i] = (LSQ_IntegerIndexT) (nextRandom() % (2 * size));
+
+        long long checksum = 0;
+        double treeTime = lookupKeys(handle, keys, lookups, &checksum);
+        heapBefore = getHeapUsage();
+        LSQ_SetHashIndex(handle, 1);
+        size_t indexBytes = getHeapUsage() - heapBefore;
+        double indexTime = lookupKeys(handle, keys, lookups, &checksum);
+
+        printf("n=%-8d tree %6.1f ns/lookup, indexed %6.1f ns/lookup (x%.2f), "
+               "tree %5.1f B/elem, index +%5.1f B/elem (checksum %lld)\n",
+               LSQ_GetSize(handle), treeTime, indexTime, treeTime / indexTime,
+               (double) treeBytes / LSQ_GetSize(handle), (double) indexBytes / LSQ_GetSize(handle), checksum);
+        LSQ_DestroySequence(handle);
+    }
+    free(keys);
+}
+
+/* 70% поисков промахиваются: нечетные ключи в дерево не попадают */
+static void benchBloomFilter(void) {
+    static const LSQ_IntegerIndexT sizes[] = {1000, 100000, 1000000, 4000000};
+    static const double rates[] = {0.01, 0.001};
+    LSQ_IntegerIndexT lookups = 2000000;
+    LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) malloc(lookups * sizeof(LSQ_IntegerIndexT));
+
+    for (int s = 0; s < 4; s++) {
+        LSQ_IntegerIndexT size = sizes[s];
+        seed = 1;
+        LSQ_HandleT handle = LSQ_CreateSequence();
+        double start = getTime();
+        for (LSQ_IntegerIndexT i = 0; i < size; i++)
+            LSQ_InsertElement(handle, 2 * (LSQ_IntegerIndexT) (nextRandom() % size), i);
+        double plainInsert = (getTime() - start) * 1e9 / size;
+        for (LSQ_IntegerIndexT i = 0; i < lookups; i++)
+            keys[i] = 2 * (LSQ_IntegerIndexT) (nextRandom() % size) + (nextRandom() % 10 < 7);
+
+        long long checksum = 0;
+        double plainTime = lookupKeys(handle, keys, lookups, &checksum);
+        printf("n=%-8d no filter: %6.1f ns/lookup, insert %6.1f ns\n", LSQ_GetSize(handle), plainTime, plainInsert);
+        LSQ_DestroySequence(handle);
+
+        for (int r = 0; r < 2; r++) {
+            seed = 1;
+            size_t heapBefore = getHeapUsage();
+            handle = LSQ_CreateSequence();
+            LSQ_SetBloomFilter(handle, rates[r]);
+            start = getTime();
+            for (LSQ_IntegerIndexT i = 0; i < size; i++)
+                LSQ_InsertElement(handle, 2 * (LSQ_IntegerIndexT) (nextRandom() % size), i);
+            double filterInsert = (getTime() - start) * 1e9 / size;
+            size_t treeBytes = getHeapUsage() - heapBefore;
+            double filterTime = lookupKeys(handle, keys, lookups, &checksum);
+            printf("n=%-8d p=%-5g:  %6.1f ns/lookup (x%.2f), insert %6.1f ns, %5.1f B/elem with filter "
+                   "(checksum %lld)\n", LSQ_GetSize(handle), rates[r], filterTime, plainTime / filterTime,
+                   filterInsert, (double) treeBytes / LSQ_GetSize(handle), checksum);
+            LSQ_DestroySequence(handle);
+        }
+    }
+    free(keys);
+}
+
+static void benchFreeze(void) {
+    static const LSQ_IntegerIndexT sizes[] = {1000, 100000, 1000000, 4000000};
+    LSQ_IntegerIndexT lookups = 2000000;
+    LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) malloc(lookups * sizeof(LSQ_IntegerIndexT));
+
+    for (int s = 0; s < 4; s++) {
+        LSQ_IntegerIndexT size = sizes[s];
+        seed = 1;
+        size_t heapBefore = getHeapUsage();
+        LSQ_HandleT handle = createRandomTree(size, 2 * size);
+        size_t treeBytes = getHeapUsage() - heapBefore;
+        for (LSQ_IntegerIndexT i = 0; i < lookups; i++)
+            keys[i] = (LSQ_IntegerIndexT) (nextRandom() % (2 * size));
+
+        long long checksum = 0;
+        double treeTime = lookupKeys(handle, keys, lookups, &checksum);
+        LSQ_Freeze(handle);
+        size_t frozenBytes = getHeapUsage() - heapBefore;
+        double frozenTime = lookupKeys(handle, keys, lookups, &checksum);
+
+        double start = getTime();
+        LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+        for (; !LSQ_IsIteratorPastRear(iterator); LSQ_AdvanceOneElement(iterator))
+            checksum += *LSQ_DereferenceIterator(iterator);
+        LSQ_DestroyIterator(iterator);
+        double scanTime = (getTime() - start) * 1e9 / LSQ_GetSize(handle);
+
+        printf("n=%-8d tree %6.1f ns/lookup %5.1f B/elem, frozen %6.1f ns/lookup %5.1f B/elem, "
+               "frozen scan %4.1f ns/elem (checksum %lld)\n",
+               LSQ_GetSize(handle), treeTime, (double) treeBytes / LSQ_GetSize(handle), frozenTime,
+               (double) frozenBytes / LSQ_GetSize(handle), scanTime, checksum);
+        LSQ_DestroySequence(handle);
+    }
+    free(keys);
+}
+
+static void benchAscendingInsert(void) {
+    LSQ_IntegerIndexT size = 10000000;
+
+    LSQ_HandleT handle = LSQ_CreateSequence();
+    double start = getTime();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        LSQ_InsertElement(handle, i, i);
+    printf("ascending  LSQ_InsertElement     n=%d: %6.1f ns/insert\n", size, (getTime() - start) * 1e9 / size);
+    LSQ_DestroySequence(handle);
+
+    handle = LSQ_CreateSequence();
+    LSQ_IteratorT hint = LSQ_GetPastRearElement(handle);
+    start = getTime();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        LSQ_InsertElementHint(handle, hint, i, i);
+    printf("ascending  LSQ_InsertElementHint n=%d: %6.1f ns/insert\n", size, (getTime() - start) * 1e9 / size);
+    LSQ_DestroyIterator(hint);
+    LSQ_DestroySequence(handle);
+
+    // почти упорядоченные метки времени: каждая десятая приходит с опозданием
+    handle = LSQ_CreateSequence();
+    hint = LSQ_GetPastRearElement(handle);
+    seed = 1;
+    start = getTime();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++) {
+        LSQ_IntegerIndexT key = 16 * i;
+        if (nextRandom() % 10 == 0)
+            key -= 16 * (LSQ_IntegerIndexT) (nextRandom() % 100) + 1;
+        LSQ_InsertElementHint(handle, hint, key, i);
+    }
+    printf("nearly ascending LSQ_InsertElementHint n=%d: %6.1f ns/insert\n", size, (getTime() - start) * 1e9 / size);
+    LSQ_DestroyIterator(hint);
+    LSQ_DestroySequence(handle);
+
+    seed = 1;
+    start = getTime();
+    handle = LSQ_CreateSequence();
+    for (LSQ_IntegerIndexT i = 0; i < size; i++)
+        LSQ_InsertElement(handle, (LSQ_IntegerIndexT) nextRandom(), i);
+    printf("random     LSQ_InsertElement     n=%d: %6.1f ns/insert\n", size, (getTime() - start) * 1e9 / size);
+    LSQ_DestroySequence(handle);
+}
+
+/* Поиск повторяется rounds раз, чтобы на малых деревьях время не терялось в шуме таймера */
+#define BENCH_KEY_TREE(name, keyExpression)                                                         \
+    do {                                                                                            \
+        seed = 1;                                                                                   \
+        double start = getTime();                                                                   \
+        name *tree = name##_CreateSequence();                                                       \
+        for (LSQ_IntegerIndexT i = 0; i < size; i++) {                                              \
+            unsigned int random = nextRandom();                                                     \
+            name##_InsertElement(tree, keyExpression, i);                                           \
+        }                                                                                           \
+        double insertTime = getTime() - start;                                                      \
+        long long found = 0;                                                                        \
+        start = getTime();                                                                          \
+        for (int round = 0; round < rounds; round++) {                                              \
+            seed = 1;                                                                               \
+            for (LSQ_IntegerIndexT i = 0; i < size; i++) {                                          \
+                unsigned int random = nextRandom();                                                 \
+                found += (name##_GetElementByKey(tree, keyExpression) != LSQ_HandleInvalid);        \
+            }                                                                                       \
+        }                                                                                           \
+        double lookupTime = getTime() - start;                                                      \
+        printf("%-16s n=%-7d: insert %6.1f ns, lookup %6.1f ns, found %lld\n", #name, size,        \
+               insertTime * 1e9 / size, lookupTime * 1e9 / size / rounds, found);                   \
+        name##_DestroySequence(tree);                                                               \
+    } while (0)
+
+static void benchKeyTypes(void) {
+    static const LSQ_IntegerIndexT sizes[] = {10000, 1000000};
+
+    for (int s = 0; s < 2; s++) {
+        LSQ_IntegerIndexT size = sizes[s];
+        int rounds = 1000000 / size;
+
+        seed = 1;
+        double start = getTime();
+        LSQ_HandleT handle = LSQ_CreateSequence();
+        for (LSQ_IntegerIndexT i = 0; i < size; i++)
+            LSQ_InsertElement(handle, (LSQ_IntegerIndexT) nextRandom(), i);
+        double insertTime = getTime() - start;
+        seed = 1;
+        LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) malloc(size * sizeof(LSQ_IntegerIndexT));
+        for (LSQ_IntegerIndexT i = 0; i < size; i++)
+            keys[i] = (LSQ_IntegerIndexT) nextRandom();
+        long long checksum = 0;
+        double lookupTime = 0;
+        for (int round = 0; round < rounds; round++)
+            lookupTime += lookupKeys(handle, keys, size, &checksum);
+        printf("%-16s n=%-7d: insert %6.1f ns, lookup %6.1f ns, checksum %lld\n", "LSQ (int)", size,
+               insertTime * 1e9 / size, lookupTime / rounds, checksum);
+        free(keys);
+        LSQ_DestroySequence(handle);
+
+        BENCH_KEY_TREE(Key64Tree, (int64_t) random);
+        BENCH_KEY_TREE(PointerKeyTree, (int64_t) random);
+        BENCH_KEY_TREE(Key128Tree, ((LSQ_Key128T) {random & 0xFF, random}));
+    }
+}
+
+static void benchLookupBatch(void) {
+    static const LSQ_IntegerIndexT sizes[] = {100000, 1000000, 8000000};
+    LSQ_IntegerIndexT lookups = 1000000;
+    LSQ_IntegerIndexT *keys = (LSQ_IntegerIndexT *) malloc(lookups * sizeof(LSQ_IntegerIndexT));
+    LSQ_BaseTypeT **values = (LSQ_BaseTypeT **) malloc(lookups * sizeof(LSQ_BaseTypeT *));
+
+    for (int s = 0; s < 3; s++) {
+        LSQ_IntegerIndexT size = sizes[s];
+        seed = 1;
+        LSQ_HandleT handle = createRandomTree(size, 2 * size);
+        for (LSQ_IntegerIndexT i = 0; i < lookups; i++)
+            keys[i] = (LSQ_IntegerIndexT) (nextRandom() % (2 * size));
+
+        long long checksum = 0;
+        double iteratorTime = lookupKeys(handle, keys, lookups, &checksum);
+
+        long long sequentialSum = 0;
+        double start = getTime();
+        for (LSQ_IntegerIndexT i = 0; i < lookups; i++) {
+            LSQ_LookupBatch(handle, keys + i, values + i, 1);
+            if (values[i] != LSQ_HandleInvalid)
+                sequentialSum += *values[i];
+        }
+        double sequentialTime = (getTime() - start) * 1e9 / lookups;
+
+        long long batchSum = 0;
+        start = getTime();
+        LSQ_LookupBatch(handle, keys, values, lookups);
+        for (LSQ_IntegerIndexT i = 0; i < lookups; i++)
+            if (values[i] != LSQ_HandleInvalid)
+                batchSum += *values[i];
+        double batchTime = (getTime() - start) * 1e9 / lookups;
+
+        printf("n=%-8d: iterator %6.1f ns, one at a time %6.1f ns, batch %6.1f ns (%.2fx), checksums %s\n",
+               size, iteratorTime, sequentialTime, batchTime, sequentialTime / batchTime,
+               (checksum == sequentialSum && checksum == batchSum) ? "match" : "DIFFER");
+        LSQ_DestroySequence(handle);
+    }
+    free(keys);
+    free(values);
+}
+
+/* Очередь с приоритетом: извлечение минимума и вставка ключа не меньше текущего минимума */
+static void benchPopMin(void) {
+    static const LSQ_IntegerIndexT sizes[] = {10000, 100000, 1000000};
+
+    for (int s = 0; s < 3; s++) {
+        LSQ_IntegerIndexT size = sizes[s];
+        seed = 1;
+        LSQ_HandleT handle = LSQ_CreateSequence();
+        for (LSQ_IntegerIndexT i = 0; i < size; i++)
+            LSQ_InsertElement(handle, (LSQ_IntegerIndexT) (nextRandom() % (16 * size)), i);
+
+        LSQ_IntegerIndexT operations = 2000000;
+        long long checksum = 0;
+        double start = getTime();
+        for (LSQ_IntegerIndexT i = 0; i < operations; i++) {
+            LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+            LSQ_IntegerIndexT key = LSQ_GetIteratorKey(iterator);
+            checksum += *LSQ_DereferenceIterator(iterator);
+            LSQ_DestroyIterator(iterator);
+            LSQ_DeleteFrontElement(handle);
+            LSQ_InsertElement(handle, key + 1 + (LSQ_IntegerIndexT) (nextRandom() % (16 * size)), i);
+        }
+        double holdTime = (getTime() - start) * 1e9 / operations;
+
+        LSQ_IntegerIndexT count = LSQ_GetSize(handle);
+        start = getTime();
+        while (LSQ_GetSize(handle) > 0) {
+            LSQ_IteratorT iterator = LSQ_GetFrontElement(handle);
+            checksum += *LSQ_DereferenceIterator(iterator);
+            LSQ_DestroyIterator(iterator);
+            LSQ_DeleteFrontElement(handle);
+        }
+        double drainTime = (getTime() - start) * 1e9 / count;
+
+        printf("n=%-8d: peek + pop-min + insert %6.1f ns, drain (peek + pop-min) %6.1f ns, checksum %lld\n",
+               size, holdTime, drainTime, checksum);
+        LSQ_DestroySequence(handle);
+    }
+}
+
+typedef struct {
+    const char *name;
+    void (*run)(void);
+} Benchmark;
+
+static const Benchmark benchmarks[] = {
+    {"setops", benchSetOperations},
+    {"hashindex", benchHashIndex},
+    {"bloom", benchBloomFilter},
+    {"freeze", benchFreeze},
+    {"ascending", benchAscendingInsert},
+    {"keytypes", benchKeyTypes},
+    {"lookupbatch", benchLookupBatch},
+    {"popmin", benchPopMin},
+};
+
+int main(int argc, char **argv) {
+    int count = sizeof(benchmarks) / sizeof(benchmarks[0]);
+    for (int i = 0; i < count; i++) {
+        int selected = (argc == 1);
+        for (int j = 1; j < argc; j++)
+            selected |= (strcmp(argv[j], benchmarks[i].name) == 0);
+        if (selected) {
+            printf("== %s\n", benchmarks[i].name);
+            benchmarks[i].run();
+        }
+    }
+    return 0;
+}
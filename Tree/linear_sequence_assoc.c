@@ -1,9 +1,35 @@
 #include <stdlib.h>
+#include <stdio.h>
 #include <math.h>
+#include <string.h>
+#include <limits.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 #include "linear_sequence_assoc.h"
+#include "thread_pool.h"
+#include "../Instrumentation/instrumentation.h"
  
  
 #define MAXIMUM(a, b) ((a) > (b) ? (a) : (b))
+#define PARALLEL_MIN_HEIGHT 12
+#define HASH_INDEX_MIN_CAPACITY 16
+#define HASH_INDEX_MULTIPLIER 0x9E3779B97F4A7C15ULL
+#define CACHE_LINE_SIZE 64
+#define LOOKUP_BATCH_WIDTH 16
+#define BLOOM_MIN_CAPACITY 1024
+#define BLOOM_BLOCK_BITS 512
+#define BLOOM_MAX_HASHES 16
+#define BLOOM_BITS_PER_HASH 1.4427
+/* Высота АВЛ-дерева из не более чем INT_MAX узлов меньше 1.45 * 31 */
+#define TREE_MAX_HEIGHT 64
+#define TREE_FILE_MAGIC "LSQTREE"
+#define TREE_FILE_MAGIC_SIZE 8
+#define TREE_FILE_VERSION 1
+/* Меньшие деревья LSQ_DestroySequenceAsync освобождает на месте: передача потоку обойдется дороже */
+#define ASYNC_DESTROY_MIN_SIZE 4096
  
 typedef struct Node_ {
     LSQ_BaseTypeT value;
@@ -15,29 +41,184 @@ typedef struct Node_ {
 } Node;
  
 typedef struct {
+    LSQ_IntegerIndexT key;
+    Node *node;
+} HashSlot;
+ 
+/* Хеш-индекс ключ -> узел с открытой адресацией и линейным пробированием */
+typedef struct {
+    HashSlot *slots;
+    size_t mask;
+    int shift;
+    LSQ_IntegerIndexT count;
+} HashIndex;
+ 
+/* Замороженное дерево: ключи и значения в порядке Эйтцингера (дети слота i - слоты 2i и 2i + 1). *
+ * Слот 0 не используется и означает отсутствие элемента. Если mapping задан, массивы лежат в    *
+ * отображении файла LSQ_Save и освобождаются вместе с ним.                                      */
+typedef struct {
+    LSQ_IntegerIndexT *keys;
+    LSQ_BaseTypeT *values;
+    size_t count;
+    void *mapping;
+    size_t mappedBytes;
+} FrozenTree;
+ 
+/* Файл LSQ_Save: заголовок длиной в строку кэша, затем массивы замороженного дерева как есть - ключи *
+ * (frozenKeyBytes байт) и count + 1 значений, в порядке байтов машины. Ключи и значения выровнены   *
+ * на строку кэша, так что файл можно использовать на месте.                                         */
+typedef struct {
+    char magic[TREE_FILE_MAGIC_SIZE];
+    LSQ_IntegerIndexT version;
+    LSQ_IntegerIndexT size;
+    char reserved[CACHE_LINE_SIZE - TREE_FILE_MAGIC_SIZE - 2 * sizeof(LSQ_IntegerIndexT)];
+} TreeFileHeader;
+ 
+/* Блочный фильтр Блума: все биты ключа лежат в одном блоке размером со строку кэша, так что проверка  *
+ * стоит не больше одного промаха. Снять биты удаленного ключа нельзя: удаления копятся в removed, и    *
+ * при их избытке фильтр перестраивается по дереву, как и при переполнении added сверх capacity.       */
+typedef struct {
+    unsigned long long *bits;
+    size_t blockMask;
+    int hashCount;
+    double falsePositiveRate;
+    LSQ_IntegerIndexT capacity;
+    LSQ_IntegerIndexT added;
+    LSQ_IntegerIndexT removed;
+} BloomFilter;
+ 
+typedef struct Tree_ {
     Node *root;
     LSQ_IntegerIndexT size;
     Node *nodePastRear;
     Node *nodeBeforeFirst;
+    HashIndex *index;
+    FrozenTree *frozen;
+    BloomFilter *bloom;
+    Node *minNode;
+    Node *maxNode;
+#ifdef LSQ_STATS
+    LSQ_StatsT stats;
+#endif
+#ifdef LSQ_LATENCY
+    LatencyProfile *latency;
+#endif
+    /* Соседи в списке живых контейнеров */
+    struct Tree_ *nextLive;
+    struct Tree_ *prevLive;
 } Tree;
  
+/* Для замороженного дерева node равен NULL, а позицию задает slot; фиктивные элементы - как обычно */
 typedef struct {
     Tree *tree;
     Node *node;
+    size_t slot;
 } Iterator;
  
+typedef struct {
+    LSQ_IntegerIndexT key;
+    LSQ_BaseTypeT value;
+    LSQ_IntegerIndexT order;
+} BatchItem;
+ 
+/* Один из параллельно идущих спусков пакетного поиска: текущий узел и номер ключа в пакете */
+typedef struct {
+    Node *node;
+    LSQ_IntegerIndexT position;
+} LookupLane;
+ 
+typedef enum {
+    SET_UNION,
+    SET_INTERSECT,
+    SET_DIFFERENCE
+} SetOperation;
+ 
+typedef struct {
+    SetOperation operation;
+    Node *first;
+    Node *second;
+    Node *result;
+    LSQ_IntegerIndexT matches;
+} SetTask;
+ 
+LIVE_CONTAINERS(Tree)
+ 
+/* Очередь деревьев, переданных LSQ_DestroySequenceAsync. Дерево уже исключено из списка живых, *
+ * поэтому очередь связана через nextLive. Фоновый поток запускается при первой передаче.       */
+static Tree *reclaimQueue = LSQ_HandleInvalid;
+static LSQ_IntegerIndexT reclaimPending = 0;
+static int reclaimerStarted = 0;
+static pthread_mutex_t reclaimMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t reclaimAvailable = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t reclaimDone = PTHREAD_COND_INITIALIZER;
+ 
 static Iterator *createIterator(Tree *, Node *);
 static Node *createNode(LSQ_BaseTypeT , LSQ_IntegerIndexT , Node *);
 static Node *getMinNode(Node *);
 static Node *getMaxNode(Node *);
 static Node *getSuccessor(Node *);
 static Node *getPredecessor(Node *);
-static Node *getByKey(Node *, LSQ_IntegerIndexT );
+static Node *getByKey(Tree *, LSQ_IntegerIndexT );
+static Node *findNode(Tree *, LSQ_IntegerIndexT );
 static LSQ_IntegerIndexT getBalanceFactor(Node *);
 static void fixHeight(Node *);
 static void replaceNode(Tree *, Node *, Node *);
 static void balancing(Tree *, Node *);
+static void retrace(Tree *, Node *);
+static void retraceInsertion(Tree *, Node *);
+static void deleteNode(Tree *, Node *);
+static void attachNode(Tree *, Node *, LSQ_IntegerIndexT , LSQ_BaseTypeT );
 static void freeNode(Node *);
+static void freeTree(Tree *);
+static int enqueueReclaim(Tree *);
+static void *reclaimLoop(void *);
+static int compareBatchItems(const void *, const void *);
+static Node *buildBalanced(BatchItem *, LSQ_IntegerIndexT );
+static Node *linkNode(Node *, Node *, Node *);
+static Node *joinNodes(Node *, Node *, Node *);
+static Node *splitNodes(Node *, LSQ_IntegerIndexT , Node **, Node **);
+static Node *setOperationNodes(SetOperation , Node *, Node *, LSQ_IntegerIndexT *);
+static void applySetOperation(Tree *, Tree *, SetOperation );
+static HashIndex *createHashIndex(LSQ_IntegerIndexT );
+static void destroyHashIndex(HashIndex *);
+static size_t hashIndexHome(HashIndex *, LSQ_IntegerIndexT );
+static Node *hashIndexFind(HashIndex *, LSQ_IntegerIndexT );
+static void hashIndexInsert(HashIndex *, Node *);
+static void hashIndexRemove(HashIndex *, LSQ_IntegerIndexT );
+static void hashIndexClear(HashIndex *);
+static void hashIndexAddNodes(HashIndex *, Node *);
+static void hashIndexRemoveNodes(HashIndex *, Node *);
+static BloomFilter *createBloomFilter(double , LSQ_IntegerIndexT );
+static void destroyBloomFilter(BloomFilter *);
+static void bloomAdd(BloomFilter *, LSQ_IntegerIndexT );
+static int bloomMayContain(BloomFilter *, LSQ_IntegerIndexT );
+static void bloomAddNodes(BloomFilter *, Node *);
+static void rebuildBloomFilter(Tree *, double );
+static void checkBloomFilter(Tree *);
+static LSQ_IntegerIndexT skipAbsentKeys(Tree *, const LSQ_IntegerIndexT *, LSQ_BaseTypeT **, LSQ_IntegerIndexT ,
+                                        LSQ_IntegerIndexT );
+static size_t frozenKeyBytes(size_t );
+static FrozenTree *createFrozenTree(size_t );
+static void destroyFrozenTree(FrozenTree *);
+static Node *fillFrozenTree(FrozenTree *, Node *, size_t );
+static Node *buildFromFrozen(FrozenTree *, size_t );
+static int frozenIsSorted(FrozenTree *);
+static size_t treeFileBytes(size_t );
+static int checkTreeFileHeader(TreeFileHeader *);
+static int writeTreeFile(FrozenTree *, const char *);
+static FrozenTree *readTreeFile(const char *);
+static FrozenTree *mapTreeFile(const char *);
+static size_t frozenLowerBound(FrozenTree *, LSQ_IntegerIndexT );
+static size_t frozenFind(FrozenTree *, LSQ_IntegerIndexT );
+static size_t frozenFirst(FrozenTree *);
+static size_t frozenLast(FrozenTree *);
+static size_t frozenSuccessor(FrozenTree *, size_t );
+static size_t frozenPredecessor(FrozenTree *, size_t );
+static Iterator *createFrozenIterator(Tree *, size_t );
+static void setFrozenPosition(Iterator *, size_t , Node *);
+static void forEachNode(Node *, LSQ_IntegerIndexT , LSQ_IntegerIndexT , int , LSQ_VisitorT , void *);
+static void forEachFrozen(FrozenTree *, LSQ_IntegerIndexT , LSQ_IntegerIndexT , int , LSQ_VisitorT , void *);
+static LSQ_IntegerIndexT transferBlock(Iterator *, LSQ_BaseTypeT *, LSQ_IntegerIndexT , int );
  
 LSQ_HandleT LSQ_CreateSequence(void) {
     Tree *newTree = (Tree *) malloc(sizeof(Tree));
@@ -45,8 +226,20 @@ LSQ_HandleT LSQ_CreateSequence(void) {
         return LSQ_HandleInvalid;
     newTree->root = NULL;
     newTree->size = 0;
+    newTree->index = LSQ_HandleInvalid;
+    newTree->frozen = LSQ_HandleInvalid;
+    newTree->bloom = LSQ_HandleInvalid;
+    newTree->minNode = LSQ_HandleInvalid;
+    newTree->maxNode = LSQ_HandleInvalid;
+#ifdef LSQ_STATS
+    newTree->stats = (LSQ_StatsT) {0, 0, 0, 0};
+#endif
+#ifdef LSQ_LATENCY
+    newTree->latency = LSQ_HandleInvalid;
+#endif
     newTree->nodePastRear = createNode(0, 0, NULL);
     newTree->nodeBeforeFirst = createNode(0, 0, NULL);
+    registerContainer(newTree);
     return newTree;
 }
  
@@ -54,12 +247,26 @@ void LSQ_DestroySequence(LSQ_HandleT handle) {
     Tree *tmpTree = (Tree *) handle;
     if (tmpTree == LSQ_HandleInvalid)
         return;
-    if (tmpTree->root != LSQ_HandleInvalid) {
-        freeNode(tmpTree->root);
-    }
-    free(tmpTree->nodeBeforeFirst);
-    free(tmpTree->nodePastRear);
-    free(tmpTree);
+    LATENCY(tmpTree, LATENCY_DESTROY_SEQUENCE);
+    unregisterContainer(tmpTree);
+    freeTree(tmpTree);
+}
+ 
+void LSQ_DestroySequenceAsync(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    LATENCY(tmpTree, LATENCY_DESTROY_SEQUENCE);
+    unregisterContainer(tmpTree);
+    if (tmpTree->size < ASYNC_DESTROY_MIN_SIZE || !enqueueReclaim(tmpTree))
+        freeTree(tmpTree);
+}
+ 
+void LSQ_WaitForAsyncDestroy(void) {
+    pthread_mutex_lock(&reclaimMutex);
+    while (reclaimPending > 0)
+        pthread_cond_wait(&reclaimDone, &reclaimMutex);
+    pthread_mutex_unlock(&reclaimMutex);
 }
  
 LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle){
@@ -92,6 +299,8 @@ extern LSQ_BaseTypeT* LSQ_DereferenceIterator(LSQ_IteratorT iterator) {
         return LSQ_HandleInvalid;
     }
     Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator->tree->frozen != LSQ_HandleInvalid)
+        return &(tmpIterator->tree->frozen->values[tmpIterator->slot]);
     return &(tmpIterator->node->value);
 }
  
@@ -100,6 +309,8 @@ extern LSQ_IntegerIndexT LSQ_GetIteratorKey(LSQ_IteratorT iterator) {
         return -1;
     }
     Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator->tree->frozen != LSQ_HandleInvalid)
+        return tmpIterator->tree->frozen->keys[tmpIterator->slot];
     return (tmpIterator->node->key);
 }
  
@@ -108,7 +319,13 @@ extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT
     if (tmpTree == LSQ_HandleInvalid) {
         return LSQ_HandleInvalid;
     }
-    Node *tmpNode = getByKey(tmpTree->root, index);
+    LATENCY(tmpTree, LATENCY_GET_ELEMENT_BY_INDEX);
+    if (tmpTree->frozen != LSQ_HandleInvalid) {
+        if (tmpTree->bloom != LSQ_HandleInvalid && !bloomMayContain(tmpTree->bloom, index))
+            return createFrozenIterator(tmpTree, 0);
+        return createFrozenIterator(tmpTree, frozenFind(tmpTree->frozen, index));
+    }
+    Node *tmpNode = findNode(tmpTree, index);
     if (tmpNode == LSQ_HandleInvalid) {
         tmpNode = tmpTree->nodePastRear;
     }
@@ -116,11 +333,76 @@ extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT
  
 }
  
+/* Спуски идут вперемешку: каждый делает один шаг и запрашивает предвыборку следующего узла, *
+ * так что промахи кэша разных ключей перекрываются. Закончивший спуск берет следующий ключ.   */
+extern void LSQ_LookupBatch(LSQ_HandleT handle, const LSQ_IntegerIndexT *keys, LSQ_BaseTypeT **values,
+                            LSQ_IntegerIndexT count) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || count <= 0)
+        return;
+    if (tmpTree->frozen != LSQ_HandleInvalid) {
+        FrozenTree *frozen = tmpTree->frozen;
+        for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+            if ((i = skipAbsentKeys(tmpTree, keys, values, i, count)) == count)
+                break;
+            size_t slot = frozenFind(frozen, keys[i]);
+            values[i] = (slot != 0) ? &frozen->values[slot] : LSQ_HandleInvalid;
+        }
+        return;
+    }
+    if (tmpTree->index != LSQ_HandleInvalid) {
+        HashIndex *index = tmpTree->index;
+        for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+            if (i + LOOKUP_BATCH_WIDTH < count)
+                __builtin_prefetch(index->slots + hashIndexHome(index, keys[i + LOOKUP_BATCH_WIDTH]));
+            if ((i = skipAbsentKeys(tmpTree, keys, values, i, count)) == count)
+                break;
+            Node *tmpNode = hashIndexFind(index, keys[i]);
+            values[i] = (tmpNode != LSQ_HandleInvalid) ? &tmpNode->value : LSQ_HandleInvalid;
+        }
+        return;
+    }
+ 
+    LookupLane lanes[LOOKUP_BATCH_WIDTH];
+    LSQ_IntegerIndexT next = skipAbsentKeys(tmpTree, keys, values, 0, count);
+    int active = 0;
+    while (active < LOOKUP_BATCH_WIDTH && next < count) {
+        lanes[active].node = tmpTree->root;
+        lanes[active++].position = next;
+        next = skipAbsentKeys(tmpTree, keys, values, next + 1, count);
+    }
+    while (active > 0) {
+        for (int lane = 0; lane < active; ) {
+            LookupLane *tmpLane = &lanes[lane];
+            Node *tmpNode = tmpLane->node;
+            LSQ_IntegerIndexT key = keys[tmpLane->position];
+            if (tmpNode != LSQ_HandleInvalid && tmpNode->key != key) {
+                tmpLane->node = (key < tmpNode->key) ? tmpNode->leftChild : tmpNode->rightChild;
+                __builtin_prefetch(tmpLane->node);
+                lane++;
+                continue;
+            }
+            values[tmpLane->position] = (tmpNode != LSQ_HandleInvalid) ? &tmpNode->value : LSQ_HandleInvalid;
+            if (next < count) {
+                tmpLane->node = tmpTree->root;
+                tmpLane->position = next;
+                next = skipAbsentKeys(tmpTree, keys, values, next + 1, count);
+                lane++;
+            }
+            else
+                *tmpLane = lanes[--active];
+        }
+    }
+}
+ 
 extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
     Tree *tmpTree = (Tree *) handle;
     if (tmpTree == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
-    Node *tmpNode = getMinNode(tmpTree->root);
+    LATENCY(tmpTree, LATENCY_GET_FRONT_ELEMENT);
+    if (tmpTree->frozen != LSQ_HandleInvalid)
+        return createFrozenIterator(tmpTree, frozenFirst(tmpTree->frozen));
+    Node *tmpNode = tmpTree->minNode;
     if (tmpNode == LSQ_HandleInvalid) {
         tmpNode = tmpTree->nodePastRear;
     }
@@ -131,6 +413,7 @@ extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
     Tree *tmpTree = (Tree *) handle;
     if (tmpTree == LSQ_HandleInvalid)
         return LSQ_HandleInvalid;
+    LATENCY(tmpTree, LATENCY_GET_PAST_REAR_ELEMENT);
     return createIterator(tmpTree, tmpTree->nodePastRear);
 }
  
@@ -144,9 +427,18 @@ extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *)iterator;
     if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid || LSQ_IsIteratorPastRear(tmpIterator))
         return;
+    LATENCY(tmpIterator->tree, LATENCY_ADVANCE_ONE_ELEMENT);
+ 
+    FrozenTree *frozen = tmpIterator->tree->frozen;
+    if (frozen != LSQ_HandleInvalid) {
+        size_t slot = LSQ_IsIteratorBeforeFirst(tmpIterator) ? frozenFirst(frozen)
+                                                             : frozenSuccessor(frozen, tmpIterator->slot);
+        setFrozenPosition(tmpIterator, slot, tmpIterator->tree->nodePastRear);
+        return;
+    }
  
     if (LSQ_IsIteratorBeforeFirst(tmpIterator)) {
-        tmpIterator->node = getMinNode(tmpIterator->tree->root);
+        tmpIterator->node = tmpIterator->tree->minNode;
     }
     else {
         tmpIterator->node = getSuccessor(tmpIterator->node);
@@ -161,9 +453,18 @@ extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
     Iterator *tmpIterator = (Iterator *) iterator;
     if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid || LSQ_IsIteratorBeforeFirst(tmpIterator))
         return;
+    LATENCY(tmpIterator->tree, LATENCY_REWIND_ONE_ELEMENT);
+ 
+    FrozenTree *frozen = tmpIterator->tree->frozen;
+    if (frozen != LSQ_HandleInvalid) {
+        size_t slot = LSQ_IsIteratorPastRear(tmpIterator) ? frozenLast(frozen)
+                                                          : frozenPredecessor(frozen, tmpIterator->slot);
+        setFrozenPosition(tmpIterator, slot, tmpIterator->tree->nodeBeforeFirst);
+        return;
+    }
  
     if (LSQ_IsIteratorPastRear(tmpIterator)) {
-        tmpIterator->node = getMaxNode(tmpIterator->tree->root);
+        tmpIterator->node = tmpIterator->tree->maxNode;
     } else {
         tmpIterator->node = getPredecessor(tmpIterator->node);
     }
@@ -178,6 +479,7 @@ extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
     Iterator *tmpIterator = (Iterator *) iterator;
     if (tmpIterator == LSQ_HandleInvalid || shift == 0)
         return;
+    LATENCY(tmpIterator->tree, LATENCY_SHIFT_POSITION);
     if (shift > 0) {
         for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorPastRear(tmpIterator); i--) {
             LSQ_AdvanceOneElement(tmpIterator);
@@ -195,136 +497,495 @@ extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos){ ///
     if (tmpIterator == LSQ_HandleInvalid) {
         return;
     }
+    LATENCY(tmpIterator->tree, LATENCY_SET_POSITION);
     tmpIterator->node = tmpIterator->tree->nodeBeforeFirst;
     for (LSQ_IntegerIndexT i = 0; i < pos && !LSQ_IsIteratorPastRear(tmpIterator); i++) {
         LSQ_AdvanceOneElement(tmpIterator);
     }
 }
  
-extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+extern void LSQ_ForEach(LSQ_HandleT handle, LSQ_VisitorT visitor, void *context) {
     Tree *tmpTree = (Tree *) handle;
-    if (tmpTree == LSQ_HandleInvalid)
+    if (tmpTree == LSQ_HandleInvalid || visitor == LSQ_HandleInvalid)
         return;
+    if (tmpTree->frozen != LSQ_HandleInvalid)
+        forEachFrozen(tmpTree->frozen, INT_MIN, 0, 0, visitor, context);
+    else
+        forEachNode(tmpTree->root, INT_MIN, 0, 0, visitor, context);
+}
  
-    Node *tmpNode = tmpTree->root;
-    Node *parent = LSQ_HandleInvalid;
+extern void LSQ_ForEachRange(LSQ_HandleT handle, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last,
+                             LSQ_VisitorT visitor, void *context) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || visitor == LSQ_HandleInvalid || first >= last)
+        return;
+    if (tmpTree->frozen != LSQ_HandleInvalid)
+        forEachFrozen(tmpTree->frozen, first, last, 1, visitor, context);
+    else
+        forEachNode(tmpTree->root, first, last, 1, visitor, context);
+}
  
-    while (tmpNode != LSQ_HandleInvalid) {
-        parent = tmpNode;
-        if (key < tmpNode->key) // == ?
-            tmpNode = tmpNode->leftChild;
-        else if (key > tmpNode->key)
-            tmpNode = tmpNode->rightChild;
-        else if (key == tmpNode->key) {
-            tmpNode->value = value;
-            return;
+/* Симметричный обход с явным стеком: спуск к первому ключу не меньше first кладет на стек узлы, в которых *
+ * поворачивали налево, то есть все еще не посещенные предки. Указатели parent не нужны.                  */
+static void forEachNode(Node *root, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last, int bounded,
+                        LSQ_VisitorT visitor, void *context) {
+    Node *stack[TREE_MAX_HEIGHT];
+    int depth = 0;
+    for (Node *node = root; node != LSQ_HandleInvalid; )
+        if (node->key >= first) {
+            stack[depth++] = node;
+            node = node->leftChild;
         }
+        else
+            node = node->rightChild;
+    while (depth > 0) {
+        Node *node = stack[--depth];
+        if (bounded && node->key >= last)
+            return;
+        if (visitor(node->key, &node->value, context))
+            return;
+        for (node = node->rightChild; node != LSQ_HandleInvalid; node = node->leftChild)
+            stack[depth++] = node;
     }
+}
  
-    Node *newNode = createNode(value, key, parent);
-    if (parent == LSQ_HandleInvalid) {
-        tmpTree->root = newNode;
-    }
-    else if (key < parent->key) {
-        parent->leftChild = newNode;
-    }
-    else {
-        parent->rightChild = newNode;
+static void forEachFrozen(FrozenTree *frozen, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last, int bounded,
+                          LSQ_VisitorT visitor, void *context) {
+    for (size_t slot = frozenLowerBound(frozen, first); slot != 0 && (!bounded || frozen->keys[slot] < last); slot = frozenSuccessor(frozen, slot))
+        if (visitor(frozen->keys[slot], &frozen->values[slot], context))
+            return;
+}
+ 
+extern LSQ_IntegerIndexT LSQ_ReadBlock(LSQ_IteratorT iterator, LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count) {
+    if (buffer == LSQ_HandleInvalid || !LSQ_IsIteratorDereferencable(iterator))
+        return 0;
+    return transferBlock((Iterator *) iterator, buffer, count, 0);
+}
+ 
+extern LSQ_IntegerIndexT LSQ_WriteBlock(LSQ_IteratorT iterator, const LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count) {
+    if (buffer == LSQ_HandleInvalid || !LSQ_IsIteratorDereferencable(iterator))
+        return 0;
+    return transferBlock((Iterator *) iterator, (LSQ_BaseTypeT *) buffer, count, 1);
+}
+ 
+/* Переносит значения между buffer и элементами, начиная с итератора (write - в элементы), и ставит итератор *
+ * за последний перенесенный. Обход идет по узлам напрямую, без проверок фиктивных элементов на каждом шаге. */
+static LSQ_IntegerIndexT transferBlock(Iterator *iterator, LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count, int write) {
+    LSQ_IntegerIndexT i = 0;
+    FrozenTree *frozen = iterator->tree->frozen;
+    if (frozen != LSQ_HandleInvalid) {
+        size_t slot = iterator->slot;
+        for (; i < count && slot != 0; i++, slot = frozenSuccessor(frozen, slot))
+            if (write)
+                frozen->values[slot] = buffer[i];
+            else
+                buffer[i] = frozen->values[slot];
+        setFrozenPosition(iterator, slot, iterator->tree->nodePastRear);
+        return i;
     }
+    Node *node = iterator->node;
+    for (; i < count && node != LSQ_HandleInvalid; i++, node = getSuccessor(node))
+        if (write)
+            node->value = buffer[i];
+        else
+            buffer[i] = node->value;
+    iterator->node = (node != LSQ_HandleInvalid) ? node : iterator->tree->nodePastRear;
+    return i;
+}
  
-    tmpTree->size++;
+extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->frozen != LSQ_HandleInvalid)
+        return;
+    LATENCY(tmpTree, LATENCY_INSERT_ELEMENT);
+ 
+    // ключи, большие максимального, подвешиваются к самому правому узлу без спуска от корня
+    Node *parent = tmpTree->maxNode;
+    if (parent == LSQ_HandleInvalid || key <= parent->key) {
+        if (tmpTree->index != LSQ_HandleInvalid) {
+            Node *found = hashIndexFind(tmpTree->index, key);
+            if (found != LSQ_HandleInvalid) {
+                found->value = value;
+                return;
+            }
+        }
  
-    if (parent == LSQ_HandleInvalid) {
-        parent = tmpTree->root;
+        Node *tmpNode = tmpTree->root;
+        parent = LSQ_HandleInvalid;
+        while (tmpNode != LSQ_HandleInvalid) {
+            parent = tmpNode;
+            if (key < tmpNode->key)
+                tmpNode = tmpNode->leftChild;
+            else if (key > tmpNode->key)
+                tmpNode = tmpNode->rightChild;
+            else {
+                tmpNode->value = value;
+                return;
+            }
+        }
     }
-    tmpNode = parent;
-    while (tmpNode != LSQ_HandleInvalid) {
-        fixHeight(tmpNode);
-        tmpNode = tmpNode->parent;
+ 
+    attachNode(tmpTree, parent, key, value);
+}
+ 
+extern void LSQ_InsertElementHint(LSQ_HandleT handle, LSQ_IteratorT hint, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    Tree *tmpTree = (Tree *) handle;
+    Iterator *tmpIterator = (Iterator *) hint;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->frozen != LSQ_HandleInvalid)
+        return;
+    LATENCY(tmpTree, LATENCY_INSERT_ELEMENT);
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree != tmpTree || LSQ_IsIteratorBeforeFirst(tmpIterator)
+        || tmpTree->root == LSQ_HandleInvalid) {
+        LSQ_InsertElement(handle, key, value);
+        return;
     }
  
-    tmpNode = parent;
-    while (tmpNode != LSQ_HandleInvalid) {
-        balancing(tmpTree, tmpNode);
-        tmpNode = tmpNode->parent;
+    Node *next = LSQ_IsIteratorPastRear(tmpIterator) ? LSQ_HandleInvalid : tmpIterator->node;
+    if (next != LSQ_HandleInvalid && next->key == key) {
+        next->value = value;
+        return;
+    }
+    Node *prev = (next == LSQ_HandleInvalid) ? tmpTree->maxNode : getPredecessor(next);
+    if ((next != LSQ_HandleInvalid && key > next->key) || (prev != LSQ_HandleInvalid && key <= prev->key)) {
+        LSQ_InsertElement(handle, key, value);
+        return;
     }
  
+    // prev и next соседние, поэтому у prev нет правого сына или у next нет левого
+    if (prev != LSQ_HandleInvalid && prev->rightChild == LSQ_HandleInvalid)
+        attachNode(tmpTree, prev, key, value);
+    else
+        attachNode(tmpTree, next, key, value);
 }
  
 extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
     Tree *tmpTree = (Tree *) handle;
     if (tmpTree == LSQ_HandleInvalid || tmpTree->root == LSQ_HandleInvalid)
         return;
-    Node *tmpNode = getMinNode(tmpTree->root);
-    LSQ_DeleteElement(handle, tmpNode->key);
+    LATENCY(tmpTree, LATENCY_DELETE_FRONT_ELEMENT);
+    deleteNode(tmpTree, tmpTree->minNode);
 }
  
 extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
     Tree *tmpTree = (Tree *) handle;
     if (tmpTree == LSQ_HandleInvalid || tmpTree->root == LSQ_HandleInvalid)
         return;
-    Node *tmpNode = getMaxNode(tmpTree->root);
-    LSQ_DeleteElement(handle, tmpNode->key);
+    LATENCY(tmpTree, LATENCY_DELETE_REAR_ELEMENT);
+    deleteNode(tmpTree, tmpTree->maxNode);
 }
  
 extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
     Tree *tmpTree = (Tree *) handle;
     if (tmpTree == LSQ_HandleInvalid || tmpTree->root == LSQ_HandleInvalid || LSQ_GetSize(tmpTree) == 0)
         return;
+    LATENCY(tmpTree, LATENCY_DELETE_ELEMENT);
  
-    Node *tmpNode = getByKey(tmpTree->root, key);
+    Node *tmpNode = findNode(tmpTree, key);
     if (tmpNode == LSQ_HandleInvalid)
         return;
+    deleteNode(tmpTree, tmpNode);
+}
  
-    Node *parent = tmpNode->parent;
-    if (tmpNode->rightChild == LSQ_HandleInvalid && tmpNode->leftChild == LSQ_HandleInvalid) {
-        replaceNode(tmpTree, tmpNode, LSQ_HandleInvalid);
+extern void LSQ_InsertBatch(LSQ_HandleT handle, const LSQ_IntegerIndexT *keys, const LSQ_BaseTypeT *values,
+                            LSQ_IntegerIndexT count) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->frozen != LSQ_HandleInvalid || keys == LSQ_HandleInvalid
+        || values == LSQ_HandleInvalid || count <= 0)
+        return;
+ 
+    BatchItem *items = (BatchItem *) malloc(count * sizeof(BatchItem));
+    if (items == LSQ_HandleInvalid)
+        return;
+    for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+        items[i].key = keys[i];
+        items[i].value = values[i];
+        items[i].order = i;
     }
-    else if (tmpNode->leftChild == LSQ_HandleInvalid) {
-        replaceNode(tmpTree, tmpNode, tmpNode->rightChild);
+    qsort(items, count, sizeof(BatchItem), compareBatchItems);
+ 
+    // из повторяющихся ключей остается последний по порядку в пакете, как при поэлементной вставке
+    LSQ_IntegerIndexT uniqueCount = 0;
+    for (LSQ_IntegerIndexT i = 0; i < count; i++) {
+        if (uniqueCount > 0 && items[uniqueCount - 1].key == items[i].key) {
+            items[uniqueCount - 1] = items[i];
+        }
+        else {
+            items[uniqueCount++] = items[i];
+        }
     }
-    else if (tmpNode->rightChild == LSQ_HandleInvalid) {
-        replaceNode(tmpTree, tmpNode, tmpNode->leftChild);
+ 
+    // при нехватке памяти пакет не вставляется целиком
+    Node *batchRoot = buildBalanced(items, uniqueCount);
+    free(items);
+    if (batchRoot == LSQ_HandleInvalid)
+        return;
+ 
+    Tree batchTree = {0};
+    batchTree.root = batchRoot;
+    batchTree.size = uniqueCount;
+    applySetOperation(tmpTree, &batchTree, SET_UNION);
+}
+ 
+static int canApplySetOperation(Tree *first, Tree *second) {
+    return (first != LSQ_HandleInvalid && second != LSQ_HandleInvalid && first->frozen == LSQ_HandleInvalid
+            && second->frozen == LSQ_HandleInvalid);
+}
+ 
+extern void LSQ_Union(LSQ_HandleT first, LSQ_HandleT second) {
+    if (!canApplySetOperation((Tree *) first, (Tree *) second) || first == second)
+        return;
+    applySetOperation((Tree *) first, (Tree *) second, SET_UNION);
+}
+ 
+extern void LSQ_Intersect(LSQ_HandleT first, LSQ_HandleT second) {
+    if (!canApplySetOperation((Tree *) first, (Tree *) second) || first == second)
+        return;
+    applySetOperation((Tree *) first, (Tree *) second, SET_INTERSECT);
+}
+ 
+extern void LSQ_Difference(LSQ_HandleT first, LSQ_HandleT second) {
+    Tree *firstTree = (Tree *) first;
+    if (!canApplySetOperation(firstTree, (Tree *) second))
+        return;
+    if (first == second) {
+        if (firstTree->root != LSQ_HandleInvalid)
+            freeNode(firstTree->root);
+        firstTree->root = LSQ_HandleInvalid;
+        firstTree->minNode = LSQ_HandleInvalid;
+        firstTree->maxNode = LSQ_HandleInvalid;
+        firstTree->size = 0;
+        if (firstTree->index != LSQ_HandleInvalid)
+            hashIndexClear(firstTree->index);
+        if (firstTree->bloom != LSQ_HandleInvalid)
+            rebuildBloomFilter(firstTree, firstTree->bloom->falsePositiveRate);
+        return;
     }
-    else {
-        Node *successorNode = getMinNode(tmpNode->rightChild);
-        if (successorNode->parent != tmpNode) {
-            replaceNode(tmpTree, successorNode, successorNode->rightChild);
-            successorNode->rightChild = tmpNode->rightChild;
-            successorNode->rightChild->parent = successorNode;
-        }
-        replaceNode(tmpTree, tmpNode, successorNode);
-        successorNode->leftChild = tmpNode->leftChild;
-        successorNode->leftChild->parent = successorNode;
+    applySetOperation(firstTree, (Tree *) second, SET_DIFFERENCE);
+}
+ 
+extern void LSQ_SetThreadCount(LSQ_IntegerIndexT count) {
+    threadPoolSetSize(count);
+}
+ 
+extern void LSQ_SetHashIndex(LSQ_HandleT handle, int enabled) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->frozen != LSQ_HandleInvalid)
+        return;
+    if (!enabled) {
+        destroyHashIndex(tmpTree->index);
+        tmpTree->index = LSQ_HandleInvalid;
+        return;
     }
+    if (tmpTree->index != LSQ_HandleInvalid)
+        return;
+    tmpTree->index = createHashIndex(tmpTree->size);
+    if (tmpTree->index != LSQ_HandleInvalid)
+        hashIndexAddNodes(tmpTree->index, tmpTree->root);
+}
  
-    tmpTree->size--;
-    free(tmpNode);
-    if (parent == LSQ_HandleInvalid) {
-        parent = tmpTree->root;
+extern void LSQ_SetBloomFilter(LSQ_HandleT handle, double falsePositiveRate) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    if (falsePositiveRate <= 0 || falsePositiveRate >= 1) {
+        destroyBloomFilter(tmpTree->bloom);
+        tmpTree->bloom = LSQ_HandleInvalid;
+        return;
     }
+    rebuildBloomFilter(tmpTree, falsePositiveRate);
+}
  
-    tmpNode = parent;
-    while (tmpNode != LSQ_HandleInvalid) {
-        fixHeight(tmpNode);
-        tmpNode = tmpNode->parent;
+extern void LSQ_GetStats(LSQ_HandleT handle, LSQ_StatsT *stats) {
+    if (stats == LSQ_HandleInvalid)
+        return;
+#ifdef LSQ_STATS
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree != LSQ_HandleInvalid) {
+        *stats = tmpTree->stats;
+        return;
     }
-    tmpNode = parent;
-    while (tmpNode != LSQ_HandleInvalid) {
-        balancing(tmpTree, tmpNode);
-        tmpNode = tmpNode->parent;
+#else
+    (void) handle;
+#endif
+    *stats = (LSQ_StatsT) {0, 0, 0, 0};
+}
+ 
+extern void LSQ_SetLatencyProfile(LSQ_HandleT handle, struct LatencyProfile_ *profile) {
+#ifdef LSQ_LATENCY
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree != LSQ_HandleInvalid)
+        tmpTree->latency = profile;
+#else
+    (void) handle;
+    (void) profile;
+#endif
+}
+ 
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    Tree *tmpTree = (Tree *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    size_t elementBytes = sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT);
+    usage->payload = tmpTree->size * elementBytes;
+    usage->overhead = sizeof(Tree) + 2 * sizeof(Node);
+    if (tmpTree->frozen != LSQ_HandleInvalid)
+        usage->overhead += sizeof(FrozenTree) + frozenKeyBytes(tmpTree->frozen->count)
+                           + (tmpTree->frozen->count + 1) * sizeof(LSQ_BaseTypeT) - usage->payload;
+    else
+        usage->overhead += tmpTree->size * (sizeof(Node) - elementBytes);
+    if (tmpTree->index != LSQ_HandleInvalid)
+        usage->overhead += sizeof(HashIndex) + (tmpTree->index->mask + 1) * sizeof(HashSlot);
+    if (tmpTree->bloom != LSQ_HandleInvalid)
+        usage->overhead += sizeof(BloomFilter) + (tmpTree->bloom->blockMask + 1) * CACHE_LINE_SIZE;
+}
+ 
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (Tree *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
     }
+    unlockLiveContainers();
 }
  
+extern void LSQ_Freeze(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->frozen != LSQ_HandleInvalid)
+        return;
+    FrozenTree *frozen = createFrozenTree(tmpTree->size);
+    if (frozen == LSQ_HandleInvalid)
+        return;
+    fillFrozenTree(frozen, getMinNode(tmpTree->root), 1);
+ 
+    if (tmpTree->root != LSQ_HandleInvalid)
+        freeNode(tmpTree->root);
+    tmpTree->root = LSQ_HandleInvalid;
+    tmpTree->minNode = LSQ_HandleInvalid;
+    tmpTree->maxNode = LSQ_HandleInvalid;
+    destroyHashIndex(tmpTree->index);
+    tmpTree->index = LSQ_HandleInvalid;
+    tmpTree->frozen = frozen;
+}
  
+extern int LSQ_Save(LSQ_HandleT handle, const char *path) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || path == LSQ_HandleInvalid)
+        return 0;
+    FrozenTree *frozen = tmpTree->frozen;
+    if (frozen == LSQ_HandleInvalid) {
+        frozen = createFrozenTree(tmpTree->size);
+        if (frozen == LSQ_HandleInvalid)
+            return 0;
+        fillFrozenTree(frozen, getMinNode(tmpTree->root), 1);
+    }
+    int saved = writeTreeFile(frozen, path);
+    if (frozen != tmpTree->frozen)
+        destroyFrozenTree(frozen);
+    return saved;
+}
+ 
+extern LSQ_HandleT LSQ_Load(const char *path) {
+    FrozenTree *frozen = readTreeFile(path);
+    if (frozen == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Tree *newTree = LSQ_CreateSequence();
+    if (newTree != LSQ_HandleInvalid) {
+        newTree->root = buildFromFrozen(frozen, 1);
+        newTree->size = (LSQ_IntegerIndexT) frozen->count;
+        newTree->minNode = getMinNode(newTree->root);
+        newTree->maxNode = getMaxNode(newTree->root);
+    }
+    destroyFrozenTree(frozen);
+    return newTree;
+}
+ 
+extern LSQ_HandleT LSQ_LoadMapped(const char *path) {
+    FrozenTree *frozen = mapTreeFile(path);
+    if (frozen == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Tree *newTree = LSQ_CreateSequence();
+    if (newTree == LSQ_HandleInvalid) {
+        destroyFrozenTree(frozen);
+        return LSQ_HandleInvalid;
+    }
+    newTree->frozen = frozen;
+    newTree->size = (LSQ_IntegerIndexT) frozen->count;
+    return newTree;
+}
+ 
+ 
+/* Обход без стека: левый ребенок поворотом поднимается на место корня, пока левых детей не останется. *
+ * Каждый поворот удлиняет правую цепочку на узел, так что поворотов и освобождений всего O(n).        */
 static void freeNode(Node *root) {
-    if (root->leftChild != LSQ_HandleInvalid) {
-        freeNode(root->leftChild);
+    while (root != LSQ_HandleInvalid) {
+        Node *left = root->leftChild;
+        if (left != LSQ_HandleInvalid) {
+            root->leftChild = left->rightChild;
+            left->rightChild = root;
+            root = left;
+        } else {
+            Node *right = root->rightChild;
+            free(root);
+            root = right;
+        }
     }
-    if (root->rightChild != LSQ_HandleInvalid) {
-        freeNode(root->rightChild);
+}
+ 
+static void freeTree(Tree *tree) {
+    if (tree->root != LSQ_HandleInvalid)
+        freeNode(tree->root);
+    destroyHashIndex(tree->index);
+    destroyFrozenTree(tree->frozen);
+    destroyBloomFilter(tree->bloom);
+    free(tree->nodeBeforeFirst);
+    free(tree->nodePastRear);
+    free(tree);
+}
+ 
+/* Возвращает 0, если фоновый поток запустить не удалось: тогда дерево освобождает вызывающий */
+static int enqueueReclaim(Tree *tree) {
+    pthread_mutex_lock(&reclaimMutex);
+    if (!reclaimerStarted) {
+        pthread_t thread;
+        if (pthread_create(&thread, NULL, reclaimLoop, NULL) == 0) {
+            pthread_detach(thread);
+            reclaimerStarted = 1;
+        }
     }
-    free(root);
+    if (reclaimerStarted) {
+        tree->nextLive = reclaimQueue;
+        reclaimQueue = tree;
+        reclaimPending++;
+        pthread_cond_signal(&reclaimAvailable);
+    }
+    pthread_mutex_unlock(&reclaimMutex);
+    return reclaimerStarted;
+}
+ 
+static void *reclaimLoop(void *argument) {
+    (void) argument;
+    pthread_mutex_lock(&reclaimMutex);
+    while (1) {
+        while (reclaimQueue == LSQ_HandleInvalid)
+            pthread_cond_wait(&reclaimAvailable, &reclaimMutex);
+        Tree *tree = reclaimQueue;
+        reclaimQueue = tree->nextLive;
+        pthread_mutex_unlock(&reclaimMutex);
+        freeTree(tree);
+        pthread_mutex_lock(&reclaimMutex);
+        if (--reclaimPending == 0)
+            pthread_cond_broadcast(&reclaimDone);
+    }
+    return NULL;
 }
  
 static Iterator *createIterator(Tree *tree, Node *node) {
@@ -334,9 +995,22 @@ static Iterator *createIterator(Tree *tree, Node *node) {
     }
     newIterator->tree = tree;
     newIterator->node = node;
+    newIterator->slot = 0;
+    return newIterator;
+}
+ 
+static Iterator *createFrozenIterator(Tree *tree, size_t slot) {
+    Iterator *newIterator = createIterator(tree, LSQ_HandleInvalid);
+    if (newIterator != LSQ_HandleInvalid)
+        setFrozenPosition(newIterator, slot, tree->nodePastRear);
     return newIterator;
 }
  
+static void setFrozenPosition(Iterator *iterator, size_t slot, Node *sentinel) {
+    iterator->slot = slot;
+    iterator->node = (slot == 0) ? sentinel : LSQ_HandleInvalid;
+}
+ 
 static Node *createNode(LSQ_BaseTypeT value, LSQ_IntegerIndexT key, Node *parent) {
     Node *tmpNode = (Node *) malloc(sizeof(Node));
     if (tmpNode == LSQ_HandleInvalid)
@@ -395,8 +1069,12 @@ static Node *getPredecessor(Node *node) {
     return parent;
 }
  
-static Node *getByKey(Node *root, LSQ_IntegerIndexT key){
+/* Глубина спуска считается в локальной переменной и добавляется в счетчик один раз */
+static Node *getByKey(Tree *tree, LSQ_IntegerIndexT key){
+    Node *root = tree->root;
+    LSQ_IntegerIndexT depth = 0;
     while (root != LSQ_HandleInvalid) {
+        depth++;
         if (root->key > key) {
             root = root->leftChild;
         }
@@ -404,9 +1082,50 @@ static Node *getByKey(Node *root, LSQ_IntegerIndexT key){
             root = root->rightChild;
         }
         else
-            return root;
+            break;
     }
-    return LSQ_HandleInvalid;
+    STATS_ADD(tree, lookups, 1);
+    STATS_ADD(tree, lookupDepth, depth);
+    (void) depth;
+    return root;
+}
+ 
+static Node *findNode(Tree *tree, LSQ_IntegerIndexT key) {
+    if (tree->bloom != LSQ_HandleInvalid && !bloomMayContain(tree->bloom, key))
+        return LSQ_HandleInvalid;
+    if (tree->index != LSQ_HandleInvalid)
+        return hashIndexFind(tree->index, key);
+    return getByKey(tree, key);
+}
+ 
+static int compareBatchItems(const void *first, const void *second) {
+    const BatchItem *a = (const BatchItem *) first;
+    const BatchItem *b = (const BatchItem *) second;
+    if (a->key != b->key)
+        return (a->key < b->key) ? -1 : 1;
+    return (a->order < b->order) ? -1 : (a->order > b->order);
+}
+ 
+/* Если какой-то узел не удалось выделить, уже построенная часть освобождается и возвращается *
+ * LSQ_HandleInvalid: дерево с пропущенными поддеревьями было бы несбалансированным.          */
+static Node *buildBalanced(BatchItem *items, LSQ_IntegerIndexT count) {
+    if (count <= 0)
+        return LSQ_HandleInvalid;
+    LSQ_IntegerIndexT middle = count / 2;
+    Node *root = createNode(items[middle].value, items[middle].key, LSQ_HandleInvalid);
+    if (root == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Node *left = buildBalanced(items, middle);
+    Node *right = LSQ_HandleInvalid;
+    if (middle == 0 || left != LSQ_HandleInvalid)
+        right = buildBalanced(items + middle + 1, count - middle - 1);
+    if ((middle > 0 && left == LSQ_HandleInvalid) || (count - middle - 1 > 0 && right == LSQ_HandleInvalid)) {
+        if (left != LSQ_HandleInvalid)
+            freeNode(left);
+        free(root);
+        return LSQ_HandleInvalid;
+    }
+    return linkNode(left, root, right);
 }
  
 static LSQ_IntegerIndexT getHeight(Node *node) {
@@ -422,6 +1141,664 @@ static void fixHeight(Node *node) {
     node->height = MAXIMUM(getHeight(node->leftChild), getHeight(node->rightChild)) + 1; // node != NULL
 }
  
+/* Подвешивает left и right к root и пересчитывает его высоту. Родителя root устанавливает вызывающий */
+static Node *linkNode(Node *left, Node *root, Node *right) {
+    root->leftChild = left;
+    root->rightChild = right;
+    if (left != LSQ_HandleInvalid)
+        left->parent = root;
+    if (right != LSQ_HandleInvalid)
+        right->parent = root;
+    fixHeight(root);
+    return root;
+}
+ 
+static Node *rotateLeftNode(Node *root) {
+    Node *newRoot = root->rightChild;
+    linkNode(root->leftChild, root, newRoot->leftChild);
+    return linkNode(root, newRoot, newRoot->rightChild);
+}
+ 
+static Node *rotateRightNode(Node *root) {
+    Node *newRoot = root->leftChild;
+    linkNode(newRoot->rightChild, root, root->rightChild);
+    return linkNode(newRoot->leftChild, newRoot, root);
+}
+ 
+static Node *joinRight(Node *left, Node *middle, Node *right) {
+    Node *child = left->rightChild;
+    if (getHeight(child) <= getHeight(right) + 1) {
+        Node *tmpNode = linkNode(child, middle, right);
+        if (getHeight(tmpNode) <= getHeight(left->leftChild) + 1)
+            return linkNode(left->leftChild, left, tmpNode);
+        return rotateLeftNode(linkNode(left->leftChild, left, rotateRightNode(tmpNode)));
+    }
+    Node *tmpNode = joinRight(child, middle, right);
+    linkNode(left->leftChild, left, tmpNode);
+    if (getHeight(tmpNode) <= getHeight(left->leftChild) + 1)
+        return left;
+    return rotateLeftNode(left);
+}
+ 
+static Node *joinLeft(Node *left, Node *middle, Node *right) {
+    Node *child = right->leftChild;
+    if (getHeight(child) <= getHeight(left) + 1) {
+        Node *tmpNode = linkNode(left, middle, child);
+        if (getHeight(tmpNode) <= getHeight(right->rightChild) + 1)
+            return linkNode(tmpNode, right, right->rightChild);
+        return rotateRightNode(linkNode(rotateLeftNode(tmpNode), right, right->rightChild));
+    }
+    Node *tmpNode = joinLeft(left, middle, child);
+    linkNode(tmpNode, right, right->rightChild);
+    if (getHeight(tmpNode) <= getHeight(right->rightChild) + 1)
+        return right;
+    return rotateRightNode(right);
+}
+ 
+/* Сливает два AVL-дерева через узел middle; все ключи left меньше middle->key, все ключи right больше */
+static Node *joinNodes(Node *left, Node *middle, Node *right) {
+    if (getHeight(left) > getHeight(right) + 1)
+        return joinRight(left, middle, right);
+    if (getHeight(right) > getHeight(left) + 1)
+        return joinLeft(left, middle, right);
+    return linkNode(left, middle, right);
+}
+ 
+/* Разрезает дерево по ключу на части с меньшими и большими ключами. Возвращает узел с этим ключом или NULL */
+static Node *splitNodes(Node *root, LSQ_IntegerIndexT key, Node **left, Node **right) {
+    if (root == LSQ_HandleInvalid) {
+        *left = *right = LSQ_HandleInvalid;
+        return LSQ_HandleInvalid;
+    }
+    Node *leftChild = root->leftChild;
+    Node *rightChild = root->rightChild;
+    Node *tmpNode = LSQ_HandleInvalid;
+    Node *found = LSQ_HandleInvalid;
+    if (key < root->key) {
+        found = splitNodes(leftChild, key, left, &tmpNode);
+        *right = joinNodes(tmpNode, root, rightChild);
+    }
+    else if (key > root->key) {
+        found = splitNodes(rightChild, key, &tmpNode, right);
+        *left = joinNodes(leftChild, root, tmpNode);
+    }
+    else {
+        *left = leftChild;
+        *right = rightChild;
+        found = root;
+    }
+    return found;
+}
+ 
+static Node *splitLast(Node *root, Node **rest) {
+    if (root->rightChild == LSQ_HandleInvalid) {
+        *rest = root->leftChild;
+        return root;
+    }
+    Node *tmpNode = LSQ_HandleInvalid;
+    Node *last = splitLast(root->rightChild, &tmpNode);
+    *rest = joinNodes(root->leftChild, root, tmpNode);
+    return last;
+}
+ 
+/* Сливает два дерева без разделяющего узла; все ключи left меньше ключей right */
+static Node *joinTwoNodes(Node *left, Node *right) {
+    if (left == LSQ_HandleInvalid)
+        return right;
+    if (right == LSQ_HandleInvalid)
+        return left;
+    Node *rest = LSQ_HandleInvalid;
+    Node *middle = splitLast(left, &rest);
+    return joinNodes(rest, middle, right);
+}
+ 
+static void runSetTask(void *argument) {
+    SetTask *task = (SetTask *) argument;
+    task->result = setOperationNodes(task->operation, task->first, task->second, &task->matches);
+}
+ 
+/* Операция над множествами за O(m log(n/m + 1)), m <= n. Узлы second поглощаются или освобождаются.    *
+ * При совпадении ключей остается узел first; при объединении он получает значение из second.           *
+ * Половины крупных поддеревьев обрабатываются параллельно в пуле потоков. matches - число общих ключей */
+static Node *setOperationNodes(SetOperation operation, Node *first, Node *second, LSQ_IntegerIndexT *matches) {
+    if (first == LSQ_HandleInvalid) {
+        if (operation == SET_UNION)
+            return second;
+        if (second != LSQ_HandleInvalid)
+            freeNode(second);
+        return LSQ_HandleInvalid;
+    }
+    if (second == LSQ_HandleInvalid) {
+        if (operation == SET_INTERSECT) {
+            freeNode(first);
+            return LSQ_HandleInvalid;
+        }
+        return first;
+    }
+ 
+    SetTask leftTask = {operation, LSQ_HandleInvalid, second->leftChild, LSQ_HandleInvalid, 0};
+    SetTask rightTask = {operation, LSQ_HandleInvalid, second->rightChild, LSQ_HandleInvalid, 0};
+    Node *middle = splitNodes(first, second->key, &leftTask.first, &rightTask.first);
+    if (middle != LSQ_HandleInvalid) {
+        (*matches)++;
+        if (operation == SET_UNION)
+            middle->value = second->value;
+        free(second);
+        if (operation == SET_DIFFERENCE) {
+            free(middle);
+            middle = LSQ_HandleInvalid;
+        }
+    }
+    else if (operation == SET_UNION) {
+        middle = second;
+    }
+    else {
+        free(second);
+    }
+ 
+    if (getHeight(leftTask.first) >= PARALLEL_MIN_HEIGHT && getHeight(leftTask.second) >= PARALLEL_MIN_HEIGHT
+        && threadPoolGetSize() > 1) {
+        ThreadPoolTask poolTask;
+        threadPoolSubmit(&poolTask, runSetTask, &leftTask);
+        runSetTask(&rightTask);
+        threadPoolWait(&poolTask);
+    }
+    else {
+        runSetTask(&leftTask);
+        runSetTask(&rightTask);
+    }
+    *matches += leftTask.matches + rightTask.matches;
+ 
+    if (middle == LSQ_HandleInvalid)
+        return joinTwoNodes(leftTask.result, rightTask.result);
+    return joinNodes(leftTask.result, middle, rightTask.result);
+}
+ 
+static void applySetOperation(Tree *first, Tree *second, SetOperation operation) {
+    // узлы second еще живы: добавляем в индекс новые ключи или удаляем из него вычитаемые
+    if (first->index != LSQ_HandleInvalid && operation == SET_UNION)
+        hashIndexAddNodes(first->index, second->root);
+    if (first->index != LSQ_HandleInvalid && operation == SET_DIFFERENCE)
+        hashIndexRemoveNodes(first->index, second->root);
+    if (first->bloom != LSQ_HandleInvalid && operation == SET_UNION)
+        bloomAddNodes(first->bloom, second->root);
+ 
+    LSQ_IntegerIndexT matches = 0;
+    LSQ_IntegerIndexT secondSize = second->size;
+    first->root = setOperationNodes(operation, first->root, second->root, &matches);
+    if (first->root != LSQ_HandleInvalid)
+        first->root->parent = LSQ_HandleInvalid;
+    first->minNode = getMinNode(first->root);
+    first->maxNode = getMaxNode(first->root);
+    second->root = LSQ_HandleInvalid;
+    second->minNode = LSQ_HandleInvalid;
+    second->maxNode = LSQ_HandleInvalid;
+    second->size = 0;
+    if (second->index != LSQ_HandleInvalid)
+        hashIndexClear(second->index);
+    if (first->index != LSQ_HandleInvalid && operation == SET_INTERSECT) {
+        hashIndexClear(first->index);
+        hashIndexAddNodes(first->index, first->root);
+    }
+    LSQ_IntegerIndexT firstSize = first->size;
+    if (operation == SET_UNION)
+        first->size += secondSize - matches;
+    else if (operation == SET_INTERSECT)
+        first->size = matches;
+    else
+        first->size -= matches;
+    if (first->bloom != LSQ_HandleInvalid) {
+        if (operation != SET_UNION)
+            first->bloom->removed += firstSize - first->size;
+        checkBloomFilter(first);
+    }
+}
+ 
+static size_t hashIndexHome(HashIndex *index, LSQ_IntegerIndexT key) {
+    return (size_t) (((unsigned long long) (unsigned int) key * HASH_INDEX_MULTIPLIER) >> index->shift);
+}
+ 
+static int hashIndexAllocate(HashIndex *index, size_t capacity) {
+    index->slots = (HashSlot *) calloc(capacity, sizeof(HashSlot));
+    if (index->slots == LSQ_HandleInvalid)
+        return 0;
+    index->mask = capacity - 1;
+    index->shift = 64;
+    for (size_t i = capacity; i > 1; i >>= 1)
+        index->shift--;
+    index->count = 0;
+    return 1;
+}
+ 
+static HashIndex *createHashIndex(LSQ_IntegerIndexT expectedCount) {
+    HashIndex *index = (HashIndex *) malloc(sizeof(HashIndex));
+    if (index == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    size_t capacity = HASH_INDEX_MIN_CAPACITY;
+    while (capacity * 3 < (size_t) expectedCount * 4)
+        capacity *= 2;
+    if (!hashIndexAllocate(index, capacity)) {
+        free(index);
+        return LSQ_HandleInvalid;
+    }
+    return index;
+}
+ 
+static void destroyHashIndex(HashIndex *index) {
+    if (index == LSQ_HandleInvalid)
+        return;
+    free(index->slots);
+    free(index);
+}
+ 
+static Node *hashIndexFind(HashIndex *index, LSQ_IntegerIndexT key) {
+    size_t i = hashIndexHome(index, key);
+    while (index->slots[i].node != LSQ_HandleInvalid) {
+        if (index->slots[i].key == key)
+            return index->slots[i].node;
+        i = (i + 1) & index->mask;
+    }
+    return LSQ_HandleInvalid;
+}
+ 
+static void hashIndexGrow(HashIndex *index) {
+    HashSlot *oldSlots = index->slots;
+    size_t oldCapacity = index->mask + 1;
+    if (!hashIndexAllocate(index, oldCapacity * 2)) {
+        index->slots = oldSlots;
+        return;
+    }
+    for (size_t i = 0; i < oldCapacity; i++) {
+        if (oldSlots[i].node != LSQ_HandleInvalid)
+            hashIndexInsert(index, oldSlots[i].node);
+    }
+    free(oldSlots);
+}
+ 
+static void hashIndexInsert(HashIndex *index, Node *node) {
+    if ((size_t) (index->count + 1) * 4 > (index->mask + 1) * 3)
+        hashIndexGrow(index);
+    size_t i = hashIndexHome(index, node->key);
+    while (index->slots[i].node != LSQ_HandleInvalid && index->slots[i].key != node->key)
+        i = (i + 1) & index->mask;
+    if (index->slots[i].node == LSQ_HandleInvalid)
+        index->count++;
+    index->slots[i].key = node->key;
+    index->slots[i].node = node;
+}
+ 
+/* Удаление со сдвигом назад: цепочки пробирования остаются непрерывными без специальных меток */
+static void hashIndexRemove(HashIndex *index, LSQ_IntegerIndexT key) {
+    size_t i = hashIndexHome(index, key);
+    while (index->slots[i].node != LSQ_HandleInvalid && index->slots[i].key != key)
+        i = (i + 1) & index->mask;
+    if (index->slots[i].node == LSQ_HandleInvalid)
+        return;
+    size_t j = i;
+    while (1) {
+        j = (j + 1) & index->mask;
+        if (index->slots[j].node == LSQ_HandleInvalid)
+            break;
+        size_t home = hashIndexHome(index, index->slots[j].key);
+        if (((j - home) & index->mask) >= ((j - i) & index->mask)) {
+            index->slots[i] = index->slots[j];
+            i = j;
+        }
+    }
+    index->slots[i].node = LSQ_HandleInvalid;
+    index->count--;
+}
+ 
+static void hashIndexClear(HashIndex *index) {
+    for (size_t i = 0; i <= index->mask; i++)
+        index->slots[i].node = LSQ_HandleInvalid;
+    index->count = 0;
+}
+ 
+static void hashIndexAddNodes(HashIndex *index, Node *root) {
+    if (root == LSQ_HandleInvalid)
+        return;
+    if (hashIndexFind(index, root->key) == LSQ_HandleInvalid)
+        hashIndexInsert(index, root);
+    hashIndexAddNodes(index, root->leftChild);
+    hashIndexAddNodes(index, root->rightChild);
+}
+ 
+static void hashIndexRemoveNodes(HashIndex *index, Node *root) {
+    if (root == LSQ_HandleInvalid)
+        return;
+    hashIndexRemove(index, root->key);
+    hashIndexRemoveNodes(index, root->leftChild);
+    hashIndexRemoveNodes(index, root->rightChild);
+}
+ 
+/* При оптимальном числе хешей k доля ложных срабатываний равна 2^-k, а бит на ключ нужно k / ln 2. *
+ * Берется k = ceil(log2(1 / p)); блочный фильтр при той же памяти ошибается чуть чаще обычного.    */
+static BloomFilter *createBloomFilter(double falsePositiveRate, LSQ_IntegerIndexT expectedCount) {
+    BloomFilter *bloom = (BloomFilter *) malloc(sizeof(BloomFilter));
+    if (bloom == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    int hashCount = 1;
+    for (double rate = 0.5; rate > falsePositiveRate && hashCount < BLOOM_MAX_HASHES; rate /= 2)
+        hashCount++;
+    double bitsPerKey = hashCount * BLOOM_BITS_PER_HASH;
+    bloom->hashCount = hashCount;
+    bloom->falsePositiveRate = falsePositiveRate;
+    bloom->capacity = MAXIMUM(2 * expectedCount, BLOOM_MIN_CAPACITY);
+    bloom->added = 0;
+    bloom->removed = 0;
+ 
+    size_t blocks = 1;
+    while ((double) blocks * BLOOM_BLOCK_BITS < bloom->capacity * bitsPerKey)
+        blocks *= 2;
+    bloom->blockMask = blocks - 1;
+    bloom->bits = (unsigned long long *) aligned_alloc(CACHE_LINE_SIZE, blocks * CACHE_LINE_SIZE);
+    if (bloom->bits == LSQ_HandleInvalid) {
+        free(bloom);
+        return LSQ_HandleInvalid;
+    }
+    memset(bloom->bits, 0, blocks * CACHE_LINE_SIZE);
+    return bloom;
+}
+ 
+static void destroyBloomFilter(BloomFilter *bloom) {
+    if (bloom == LSQ_HandleInvalid)
+        return;
+    free(bloom->bits);
+    free(bloom);
+}
+ 
+/* Старшие 32 бита хеша выбирают блок, из младших по двойному хешированию получаются номера битов в блоке */
+static unsigned long long bloomHash(LSQ_IntegerIndexT key) {
+    unsigned long long hash = (unsigned long long) (unsigned int) key + HASH_INDEX_MULTIPLIER;
+    hash = (hash ^ (hash >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    hash = (hash ^ (hash >> 27)) * 0x94D049BB133111EBULL;
+    return hash ^ (hash >> 31);
+}
+ 
+static void bloomAdd(BloomFilter *bloom, LSQ_IntegerIndexT key) {
+    unsigned long long hash = bloomHash(key);
+    unsigned long long *block = bloom->bits + ((hash >> 32) & bloom->blockMask) * (BLOOM_BLOCK_BITS / 64);
+    unsigned int bit = (unsigned int) hash;
+    unsigned int step = (unsigned int) (hash >> 16) | 1;
+    for (int i = 0; i < bloom->hashCount; i++, bit += step)
+        block[(bit % BLOOM_BLOCK_BITS) / 64] |= 1ULL << (bit % 64);
+    bloom->added++;
+}
+ 
+static int bloomMayContain(BloomFilter *bloom, LSQ_IntegerIndexT key) {
+    unsigned long long hash = bloomHash(key);
+    const unsigned long long *block = bloom->bits + ((hash >> 32) & bloom->blockMask) * (BLOOM_BLOCK_BITS / 64);
+    unsigned int bit = (unsigned int) hash;
+    unsigned int step = (unsigned int) (hash >> 16) | 1;
+    for (int i = 0; i < bloom->hashCount; i++, bit += step)
+        if (!(block[(bit % BLOOM_BLOCK_BITS) / 64] & (1ULL << (bit % 64))))
+            return 0;
+    return 1;
+}
+ 
+static void bloomAddNodes(BloomFilter *bloom, Node *root) {
+    if (root == LSQ_HandleInvalid)
+        return;
+    bloomAdd(bloom, root->key);
+    bloomAddNodes(bloom, root->leftChild);
+    bloomAddNodes(bloom, root->rightChild);
+}
+ 
+/* Если память под новый фильтр выделить не удалось, остается старый: он по-прежнему не теряет ключей */
+static void rebuildBloomFilter(Tree *tree, double falsePositiveRate) {
+    BloomFilter *bloom = createBloomFilter(falsePositiveRate, tree->size);
+    if (bloom == LSQ_HandleInvalid)
+        return;
+    if (tree->frozen != LSQ_HandleInvalid) {
+        for (size_t slot = 1; slot <= tree->frozen->count; slot++)
+            bloomAdd(bloom, tree->frozen->keys[slot]);
+    }
+    else
+        bloomAddNodes(bloom, tree->root);
+    destroyBloomFilter(tree->bloom);
+    tree->bloom = bloom;
+}
+ 
+/* Перестройка после удалений, когда удаленных ключей в фильтре больше, чем живых, обходится в O(1) *
+ * амортизированно на удаление; после вставок - при удвоении числа ключей.                         */
+static void checkBloomFilter(Tree *tree) {
+    BloomFilter *bloom = tree->bloom;
+    if (bloom->added > bloom->capacity || bloom->removed > tree->size)
+        rebuildBloomFilter(tree, bloom->falsePositiveRate);
+}
+ 
+/* Номер первого ключа начиная с position, который может быть в дереве; для пропущенных значения NULL */
+static LSQ_IntegerIndexT skipAbsentKeys(Tree *tree, const LSQ_IntegerIndexT *keys, LSQ_BaseTypeT **values,
+                                        LSQ_IntegerIndexT position, LSQ_IntegerIndexT count) {
+    if (tree->bloom == LSQ_HandleInvalid)
+        return position;
+    while (position < count && !bloomMayContain(tree->bloom, keys[position]))
+        values[position++] = LSQ_HandleInvalid;
+    return position;
+}
+ 
+/* Размер массива ключей кратен строке кэша, как требует aligned_alloc */
+static size_t frozenKeyBytes(size_t count) {
+    return ((count + 1) * sizeof(LSQ_IntegerIndexT) + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+}
+ 
+static FrozenTree *createFrozenTree(size_t count) {
+    FrozenTree *frozen = (FrozenTree *) malloc(sizeof(FrozenTree));
+    if (frozen == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    frozen->keys = (LSQ_IntegerIndexT *) aligned_alloc(CACHE_LINE_SIZE, frozenKeyBytes(count));
+    frozen->values = (LSQ_BaseTypeT *) malloc((count + 1) * sizeof(LSQ_BaseTypeT));
+    frozen->count = count;
+    frozen->mapping = LSQ_HandleInvalid;
+    if (frozen->keys == LSQ_HandleInvalid || frozen->values == LSQ_HandleInvalid) {
+        destroyFrozenTree(frozen);
+        return LSQ_HandleInvalid;
+    }
+    return frozen;
+}
+ 
+static void destroyFrozenTree(FrozenTree *frozen) {
+    if (frozen == LSQ_HandleInvalid)
+        return;
+    if (frozen->mapping != LSQ_HandleInvalid) {
+        munmap(frozen->mapping, frozen->mappedBytes);
+    } else {
+        free(frozen->keys);
+        free(frozen->values);
+    }
+    free(frozen);
+}
+ 
+/* Раскладывает узлы, начиная с node, по слотам поддерева slot в симметричном порядке */
+static Node *fillFrozenTree(FrozenTree *frozen, Node *node, size_t slot) {
+    if (slot > frozen->count)
+        return node;
+    node = fillFrozenTree(frozen, node, 2 * slot);
+    frozen->keys[slot] = node->key;
+    frozen->values[slot] = node->value;
+    node = getSuccessor(node);
+    return fillFrozenTree(frozen, node, 2 * slot + 1);
+}
+ 
+/* Слоты замороженного дерева образуют полное двоичное дерево, поэтому построенное по ним дерево *
+ * сбалансировано без поворотов                                                                   */
+static Node *buildFromFrozen(FrozenTree *frozen, size_t slot) {
+    if (slot > frozen->count)
+        return LSQ_HandleInvalid;
+    Node *root = createNode(frozen->values[slot], frozen->keys[slot], LSQ_HandleInvalid);
+    if (root == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Node *left = buildFromFrozen(frozen, 2 * slot);
+    Node *right = buildFromFrozen(frozen, 2 * slot + 1);
+    return linkNode(left, root, right);
+}
+ 
+static int frozenIsSorted(FrozenTree *frozen) {
+    size_t slot = frozenFirst(frozen);
+    size_t next = (slot != 0) ? frozenSuccessor(frozen, slot) : 0;
+    while (next != 0) {
+        if (frozen->keys[slot] >= frozen->keys[next])
+            return 0;
+        slot = next;
+        next = frozenSuccessor(frozen, next);
+    }
+    return 1;
+}
+ 
+static size_t treeFileBytes(size_t count) {
+    return sizeof(TreeFileHeader) + frozenKeyBytes(count) + (count + 1) * sizeof(LSQ_BaseTypeT);
+}
+ 
+static int checkTreeFileHeader(TreeFileHeader *header) {
+    return memcmp(header->magic, TREE_FILE_MAGIC, TREE_FILE_MAGIC_SIZE) == 0 && header->version == TREE_FILE_VERSION
+           && header->size >= 0;
+}
+ 
+/* Файл пишется под временным именем и переименовывается: path может быть отображен LSQ_LoadMapped,  *
+ * и усечение файла на месте сломало бы отображение. Неиспользуемый слот 0 и хвост выравнивания ключей *
+ * обнуляются, чтобы содержимое файла было определенным.                                              */
+static int writeTreeFile(FrozenTree *frozen, const char *path) {
+    size_t length = strlen(path);
+    char *temporary = (char *) malloc(length + sizeof(".tmp"));
+    if (temporary == LSQ_HandleInvalid)
+        return 0;
+    memcpy(temporary, path, length);
+    memcpy(temporary + length, ".tmp", sizeof(".tmp"));
+    FILE *stream = fopen(temporary, "wb");
+    if (stream == LSQ_HandleInvalid) {
+        free(temporary);
+        return 0;
+    }
+    TreeFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TREE_FILE_MAGIC, TREE_FILE_MAGIC_SIZE);
+    header.version = TREE_FILE_VERSION;
+    header.size = (LSQ_IntegerIndexT) frozen->count;
+    size_t keyBytes = frozenKeyBytes(frozen->count);
+    frozen->keys[0] = 0;
+    frozen->values[0] = 0;
+    memset(frozen->keys + frozen->count + 1, 0, keyBytes - (frozen->count + 1) * sizeof(LSQ_IntegerIndexT));
+    int written = fwrite(&header, sizeof(header), 1, stream) == 1 && fwrite(frozen->keys, keyBytes, 1, stream) == 1
+                  && fwrite(frozen->values, (frozen->count + 1) * sizeof(LSQ_BaseTypeT), 1, stream) == 1;
+    int saved = (fclose(stream) == 0) && written && rename(temporary, path) == 0;
+    if (!saved)
+        remove(temporary);
+    free(temporary);
+    return saved;
+}
+ 
+static FrozenTree *readTreeFile(const char *path) {
+    if (path == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    FILE *stream = fopen(path, "rb");
+    if (stream == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    TreeFileHeader header;
+    FrozenTree *frozen = LSQ_HandleInvalid;
+    if (fread(&header, sizeof(header), 1, stream) == 1 && checkTreeFileHeader(&header))
+        frozen = createFrozenTree((size_t) header.size);
+    if (frozen != LSQ_HandleInvalid) {
+        int complete = fread(frozen->keys, frozenKeyBytes(frozen->count), 1, stream) == 1
+                       && fread(frozen->values, (frozen->count + 1) * sizeof(LSQ_BaseTypeT), 1, stream) == 1;
+        if (!complete || !frozenIsSorted(frozen)) {
+            destroyFrozenTree(frozen);
+            frozen = LSQ_HandleInvalid;
+        }
+    }
+    fclose(stream);
+    return frozen;
+}
+ 
+/* Отображение закрытое: значения можно менять через итераторы, но изменения не попадают в файл. *
+ * Порядок ключей не проверяется, чтобы открытие не читало файл целиком.                          */
+static FrozenTree *mapTreeFile(const char *path) {
+    if (path == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    int descriptor = open(path, O_RDONLY);
+    if (descriptor < 0)
+        return LSQ_HandleInvalid;
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(descriptor, &status) == 0 && (size_t) status.st_size >= sizeof(TreeFileHeader))
+        mapping = mmap(NULL, (size_t) status.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, descriptor, 0);
+    close(descriptor);
+    if (mapping == MAP_FAILED)
+        return LSQ_HandleInvalid;
+    TreeFileHeader *header = (TreeFileHeader *) mapping;
+    FrozenTree *frozen = LSQ_HandleInvalid;
+    if (checkTreeFileHeader(header) && treeFileBytes((size_t) header->size) == (size_t) status.st_size)
+        frozen = (FrozenTree *) malloc(sizeof(FrozenTree));
+    if (frozen == LSQ_HandleInvalid) {
+        munmap(mapping, (size_t) status.st_size);
+        return LSQ_HandleInvalid;
+    }
+    frozen->count = (size_t) header->size;
+    frozen->keys = (LSQ_IntegerIndexT *) (header + 1);
+    frozen->values = (LSQ_BaseTypeT *) ((char *) frozen->keys + frozenKeyBytes(frozen->count));
+    frozen->mapping = mapping;
+    frozen->mappedBytes = (size_t) status.st_size;
+    return frozen;
+}
+ 
+/* Поиск без ветвлений: спуск до листа с предвыборкой правнуков, затем возврат к последнему повороту налево. *
+ * Возвращает слот первого ключа, не меньшего key, или 0, если такого нет.                                  */
+static size_t frozenLowerBound(FrozenTree *frozen, LSQ_IntegerIndexT key) {
+    size_t slot = 1;
+    while (slot <= frozen->count) {
+        __builtin_prefetch(frozen->keys + 16 * slot);
+        slot = 2 * slot + (frozen->keys[slot] < key);
+    }
+    return slot >> __builtin_ffsll((long long) ~slot);
+}
+ 
+static size_t frozenFind(FrozenTree *frozen, LSQ_IntegerIndexT key) {
+    size_t slot = frozenLowerBound(frozen, key);
+    return (slot != 0 && frozen->keys[slot] == key) ? slot : 0;
+}
+ 
+static size_t frozenFirst(FrozenTree *frozen) {
+    if (frozen->count == 0)
+        return 0;
+    size_t slot = 1;
+    while (2 * slot <= frozen->count)
+        slot = 2 * slot;
+    return slot;
+}
+ 
+static size_t frozenLast(FrozenTree *frozen) {
+    if (frozen->count == 0)
+        return 0;
+    size_t slot = 1;
+    while (2 * slot + 1 <= frozen->count)
+        slot = 2 * slot + 1;
+    return slot;
+}
+ 
+static size_t frozenSuccessor(FrozenTree *frozen, size_t slot) {
+    if (2 * slot + 1 <= frozen->count) {
+        slot = 2 * slot + 1;
+        while (2 * slot <= frozen->count)
+            slot = 2 * slot;
+        return slot;
+    }
+    while (slot & 1)
+        slot >>= 1;
+    return slot >> 1;
+}
+ 
+static size_t frozenPredecessor(FrozenTree *frozen, size_t slot) {
+    if (2 * slot <= frozen->count) {
+        slot = 2 * slot;
+        while (2 * slot + 1 <= frozen->count)
+            slot = 2 * slot + 1;
+        return slot;
+    }
+    while (!(slot & 1))
+        slot >>= 1;
+    return slot >> 1;
+}
+ 
 static void replaceNode(Tree *tree, Node *node, Node *substitute) {
     if (node == LSQ_HandleInvalid)
         return;
@@ -438,6 +1815,7 @@ static void replaceNode(Tree *tree, Node *node, Node *substitute) {
 static void leftRotation(Tree *tree, Node *root) {
     if (root == LSQ_HandleInvalid || root->rightChild == LSQ_HandleInvalid)
         return;
+    STATS_ADD(tree, rotations, 1);
     Node *newRoot = root->rightChild;
  
     root->rightChild = newRoot->leftChild;
@@ -464,6 +1842,7 @@ static void leftRotation(Tree *tree, Node *root) {
 static void rightRotation(Tree *tree, Node *root) {
     if (root == LSQ_HandleInvalid || root->leftChild == LSQ_HandleInvalid)
         return;
+    STATS_ADD(tree, rotations, 1);
     Node *newRoot = root->leftChild;
  
     root->leftChild = newRoot->rightChild;
@@ -522,3 +1901,110 @@ static void balancing(Tree *tree, Node *root) {
  
     }
 }
+ 
+/* Удаление узла по указателю, без повторного поиска по ключу */
+static void deleteNode(Tree *tree, Node *node) {
+    if (tree->index != LSQ_HandleInvalid)
+        hashIndexRemove(tree->index, node->key);
+    if (node == tree->minNode)
+        tree->minNode = getSuccessor(node);
+    if (node == tree->maxNode)
+        tree->maxNode = getPredecessor(node);
+ 
+    Node *parent = node->parent;
+    if (node->rightChild == LSQ_HandleInvalid && node->leftChild == LSQ_HandleInvalid) {
+        replaceNode(tree, node, LSQ_HandleInvalid);
+    }
+    else if (node->leftChild == LSQ_HandleInvalid) {
+        replaceNode(tree, node, node->rightChild);
+    }
+    else if (node->rightChild == LSQ_HandleInvalid) {
+        replaceNode(tree, node, node->leftChild);
+    }
+    else {
+        Node *successorNode = getMinNode(node->rightChild);
+        parent = successorNode;
+        if (successorNode->parent != node) {
+            parent = successorNode->parent;
+            replaceNode(tree, successorNode, successorNode->rightChild);
+            successorNode->rightChild = node->rightChild;
+            successorNode->rightChild->parent = successorNode;
+        }
+        replaceNode(tree, node, successorNode);
+        successorNode->leftChild = node->leftChild;
+        successorNode->leftChild->parent = successorNode;
+        successorNode->height = node->height;
+    }
+ 
+    tree->size--;
+    free(node);
+    retrace(tree, parent);
+    if (tree->bloom != LSQ_HandleInvalid) {
+        tree->bloom->removed++;
+        checkBloomFilter(tree);
+    }
+}
+ 
+/* Подъем после удаления: как только высота поддерева оказывается прежней, выше ничего не меняется */
+static void retrace(Tree *tree, Node *node) {
+    while (node != LSQ_HandleInvalid) {
+        STATS_ADD(tree, retraceSteps, 1);
+        LSQ_IntegerIndexT oldHeight = node->height;
+        fixHeight(node);
+        LSQ_IntegerIndexT balanceFactor = getBalanceFactor(node);
+        if (balanceFactor == 2 || balanceFactor == -2) {
+            balancing(tree, node);
+            node = node->parent;
+        }
+        if (node->height == oldHeight)
+            return;
+        node = node->parent;
+    }
+}
+ 
+/* После вставки одного узла: подъем прекращается, когда высота поддерева не изменилась или выполнен  *
+ * поворот, восстанавливающий прежнюю высоту. В среднем число шагов O(1).                              */
+static void retraceInsertion(Tree *tree, Node *node) {
+    while (node != LSQ_HandleInvalid) {
+        STATS_ADD(tree, retraceSteps, 1);
+        LSQ_IntegerIndexT oldHeight = node->height;
+        fixHeight(node);
+        LSQ_IntegerIndexT balanceFactor = getBalanceFactor(node);
+        if (balanceFactor == 2 || balanceFactor == -2) {
+            balancing(tree, node);
+            return;
+        }
+        if (node->height == oldHeight)
+            return;
+        node = node->parent;
+    }
+}
+ 
+static void attachNode(Tree *tree, Node *parent, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    Node *newNode = createNode(value, key, parent);
+    if (newNode == LSQ_HandleInvalid)
+        return;
+    if (parent == LSQ_HandleInvalid) {
+        tree->root = newNode;
+    }
+    else if (key < parent->key) {
+        parent->leftChild = newNode;
+    }
+    else {
+        parent->rightChild = newNode;
+    }
+ 
+    tree->size++;
+    if (tree->minNode == LSQ_HandleInvalid || key < tree->minNode->key)
+        tree->minNode = newNode;
+    if (tree->maxNode == LSQ_HandleInvalid || key > tree->maxNode->key)
+        tree->maxNode = newNode;
+    if (tree->index != LSQ_HandleInvalid)
+        hashIndexInsert(tree->index, newNode);
+ 
+    retraceInsertion(tree, parent);
+    if (tree->bloom != LSQ_HandleInvalid) {
+        bloomAdd(tree->bloom, key);
+        checkBloomFilter(tree);
+    }
+}
\ No newline at end of file
@@ -23,6 +23,11 @@ typedef int LSQ_IntegerIndexT;
 extern LSQ_HandleT LSQ_CreateSequence(void);
 /* Функция, уничтожающая контейнер с заданным дескриптором. Освобождает принадлежащую ему память */
 extern void LSQ_DestroySequence(LSQ_HandleT handle);
+/* Функция, уничтожающая контейнер с заданным дескриптором за O(1): дескриптор сразу становится недействительным, *
+ * а память крупного контейнера освобождает фоновый поток                                                       */
+extern void LSQ_DestroySequenceAsync(LSQ_HandleT handle);
+/* Функция, ожидающая, пока фоновый поток освободит все контейнеры, переданные LSQ_DestroySequenceAsync */
+extern void LSQ_WaitForAsyncDestroy(void);
 
 /* Функция, возвращающая текущее количество элементов в контейнере */
 extern LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle);
@@ -47,6 +52,10 @@ extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT
 extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle);
 /* Функция, возвращающая итератор, ссылающийся на фиктивный элемент, следующий за последним элементом контейнера */
 extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle);
+/* Функция пакетного поиска count ключей: values[i] получает указатель на значение с ключом keys[i] или NULL, *
+ * если такого ключа нет. Спуски по дереву для разных ключей чередуются, и их промахи кэша перекрываются.    */
+extern void LSQ_LookupBatch(LSQ_HandleT handle, const LSQ_IntegerIndexT *keys, LSQ_BaseTypeT **values,
+                            LSQ_IntegerIndexT count);
 
 /* Функция, уничтожающая итератор с заданным дескриптором и освобождающая принадлежащую ему память */
 extern void LSQ_DestroyIterator(LSQ_IteratorT iterator);
@@ -62,9 +71,88 @@ extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift);
 /* Функция, устанавливающая итератор на элемент с указанным номером */
 extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos);
 
+/* Функция обратного вызова для обхода: получает ключ элемента, указатель на его значение и context.       *
+ * Ненулевой результат прекращает обход. Менять состав контейнера из нее нельзя.                          */
+typedef int (*LSQ_VisitorT)(LSQ_IntegerIndexT key, LSQ_BaseTypeT *value, void *context);
+/* Функция, вызывающая visitor для всех элементов контейнера в порядке возрастания ключей. Обход идет     *
+ * внутри дерева, без итератора и проверок фиктивных элементов на каждом шаге.                           */
+extern void LSQ_ForEach(LSQ_HandleT handle, LSQ_VisitorT visitor, void *context);
+/* Функция, вызывающая visitor для элементов с ключами из [first, last) */
+extern void LSQ_ForEachRange(LSQ_HandleT handle, LSQ_IntegerIndexT first, LSQ_IntegerIndexT last,
+                             LSQ_VisitorT visitor, void *context);
+
+/* Функция, копирующая в buffer значения до count элементов в порядке ключей, начиная с указываемого       *
+ * итератором, и передвигающая итератор за последний скопированный. Возвращает число скопированных        *
+ * значений, меньшее count, если контейнер кончился раньше, и 0, если итератор не указывает на элемент.   */
+extern LSQ_IntegerIndexT LSQ_ReadBlock(LSQ_IteratorT iterator, LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count);
+/* Функция, записывающая до count значений из buffer поверх значений элементов по тем же правилам.         *
+ * Ключи не меняются, поэтому запись разрешена и для замороженного контейнера.                           */
+extern LSQ_IntegerIndexT LSQ_WriteBlock(LSQ_IteratorT iterator, const LSQ_BaseTypeT *buffer, LSQ_IntegerIndexT count);
+
 /* Функция, добавляющая новую пару ключ-значение в контейнер. Если элемент с данным ключом существует,  *
  * его значение обновляется указанным.                                                                  */
 extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value);
+/* Функция, добавляющая пару ключ-значение с подсказкой: hint указывает на элемент, перед которым должен  *
+ * оказаться ключ (PastRear - в конец). При верной подсказке поиск места занимает O(1) в среднем,        *
+ * при неверной выполняется обычная вставка.                                                            */
+extern void LSQ_InsertElementHint(LSQ_HandleT handle, LSQ_IteratorT hint, LSQ_IntegerIndexT key, LSQ_BaseTypeT value);
+/* Функция, добавляющая в контейнер пакет из count пар ключ-значение. Пакет сортируется и сливается с деревом *
+ * за один проход. Если ключ встречается несколько раз, остается последнее значение. Если памяти на пакет    *
+ * не хватило, контейнер не меняется.                                                                       */
+extern void LSQ_InsertBatch(LSQ_HandleT handle, const LSQ_IntegerIndexT *keys, const LSQ_BaseTypeT *values,
+                            LSQ_IntegerIndexT count);
+
+/* Следующие функции выполняют операции над множествами ключей за O(m log(n/m + 1)). Результат остается в  *
+ * контейнере first, контейнер second после вызова пуст. Половины крупных поддеревьев обрабатываются       *
+ * параллельно.                                                                                          */
+/* Функция, добавляющая в first элементы second. Для общих ключей берется значение из second */
+extern void LSQ_Union(LSQ_HandleT first, LSQ_HandleT second);
+/* Функция, оставляющая в first только ключи, присутствующие в second. Значения берутся из first */
+extern void LSQ_Intersect(LSQ_HandleT first, LSQ_HandleT second);
+/* Функция, удаляющая из first ключи, присутствующие в second */
+extern void LSQ_Difference(LSQ_HandleT first, LSQ_HandleT second);
+/* Функция, задающая число потоков для операций над множествами, включая вызывающий. 0 - по числу процессоров */
+extern void LSQ_SetThreadCount(LSQ_IntegerIndexT count);
+
+/* Функция, включающая (enabled != 0) или выключающая хеш-индекс ключей. С индексом точный поиск по ключу  *
+ * выполняется в среднем за O(1), упорядоченный обход по-прежнему идет по дереву.                          */
+extern void LSQ_SetHashIndex(LSQ_HandleT handle, int enabled);
+
+/* Функция, включающая блочный фильтр Блума с заданной долей ложных срабатываний (0 или 1 - выключает) или  *
+ * меняющая ее. Фильтр проверяется перед спуском по дереву, так что поиск отсутствующего ключа обычно      *
+ * заканчивается одним обращением к памяти. После многих удалений фильтр перестраивается сам.              */
+extern void LSQ_SetBloomFilter(LSQ_HandleT handle, double falsePositiveRate);
+
+/* Счетчики операций контейнера: lookups и lookupDepth - число поисков по ключу в дереве и сумма пройденных *
+ * ими узлов, rotations - одинарные повороты, retraceSteps - узлы, пройденные при подъеме после вставки     *
+ * и удаления.                                                                                            */
+typedef struct {
+    unsigned long long lookups;
+    unsigned long long lookupDepth;
+    unsigned long long rotations;
+    unsigned long long retraceSteps;
+} LSQ_StatsT;
+/* Функция, записывающая счетчики контейнера в stats. Счетчики ведутся, только если библиотека собрана  *
+ * с LSQ_STATS, иначе все они равны нулю, а операции контейнера не тратят на них ни одной инструкции.   */
+extern void LSQ_GetStats(LSQ_HandleT handle, LSQ_StatsT *stats);
+
+/* Функция, назначающая контейнеру профиль задержек (NULL - снимает его). Профиль создается и печатается   *
+ * функциями Instrumentation/latency.h и должен жить, пока назначен. Замеры ведутся, только если            *
+ * библиотека собрана с LSQ_LATENCY, иначе функция ничего не делает.                                       */
+struct LatencyProfile_;
+extern void LSQ_SetLatencyProfile(LSQ_HandleT handle, struct LatencyProfile_ *profile);
+
+/* Функция, замораживающая контейнер: дерево переводится в компактный массив без указателей с поиском   *
+ * без ветвлений. Поиск и итерация продолжают работать, функции, меняющие состав контейнера, ничего не делают. */
+extern void LSQ_Freeze(LSQ_HandleT handle);
+/* Функция, записывающая контейнер в файл path в двоичном формате с номером версии. Возвращает 0 при ошибке */
+extern int LSQ_Save(LSQ_HandleT handle, const char *path);
+/* Функция, создающая контейнер из файла, записанного LSQ_Save, за O(n). Возвращает LSQ_HandleInvalid, *
+ * если файл не удалось прочитать или его формат либо версия не подходят                            */
+extern LSQ_HandleT LSQ_Load(const char *path);
+/* Функция, отображающая файл LSQ_Save в память и возвращающая замороженный контейнер, который работает *
+ * прямо с файлом, не читая его целиком. Изменения значений через итераторы в файл не попадают         */
+extern LSQ_HandleT LSQ_LoadMapped(const char *path);
 
 /* Функция, удаляющая первый элемент контейнера */
 extern void LSQ_DeleteFrontElement(LSQ_HandleT handle);
@@ -73,4 +161,17 @@ extern void LSQ_DeleteRearElement(LSQ_HandleT handle);
 /* Функция, удаляющая элемент контейнера, указываемый заданным ключом. */
 extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key);
 
+/* Память контейнера в байтах без учета заголовков malloc: payload - ключи и значения,     *
+ * overhead - служебные поля и структуры, slack - выделенная, но не занятая емкость.       *
+ * Узлы выделяются по одному, slack всегда 0; хеш-индекс и фильтр Блума входят в overhead. */
+typedef struct {
+    size_t payload;
+    size_t overhead;
+    size_t slack;
+} LSQ_MemoryUsageT;
+/* Функция, записывающая в usage память, занимаемую контейнером */
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage);
+/* Функция, записывающая в usage суммарную память всех существующих контейнеров процесса */
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage);
+
 #endif
\ No newline at end of file
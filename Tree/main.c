@@ -3,9 +3,14 @@
 #include <stdarg.h>
 #include <string.h>
 #include <ctype.h>
+#include <unistd.h>
 //#include <conio.h>
 //#include <Windows.h>
 #include "linear_sequence_assoc.h"
+#include "avl_tree_keys.h"
+#ifdef LSQ_LATENCY
+#include "../Instrumentation/latency.h"
+#endif
 
 #define TEST { test_line = __LINE__; test_init(); } {
 #define ENDTEST } { test_teardown(); test_line = 0; }
@@ -82,6 +87,32 @@ void dump(LSQ_HandleT seq)
 }
 
 
+/* Запоминает ключи и значения посещенных элементов, увеличивает значения на 1 и останавливает обход после limit */
+typedef struct {
+    int keys[16];
+    int values[16];
+    int count;
+    int limit;
+} Visited;
+
+int visit(LSQ_IntegerIndexT key, LSQ_BaseTypeT *value, void *context)
+{
+    Visited *visited = (Visited *) context;
+    visited->keys[visited->count] = key;
+    visited->values[visited->count] = (*value)++;
+    return ++visited->count == visited->limit;
+}
+
+/* state[0] - число посещенных элементов, state[1] - последний ключ, state[2] - нарушения порядка и значения */
+int visitOrdered(LSQ_IntegerIndexT key, LSQ_BaseTypeT *value, void *context)
+{
+    int *state = (int *) context;
+    state[2] += (state[0] > 0 && key <= state[1]) || *value != key;
+    state[0]++;
+    state[1] = key;
+    return 0;
+}
+
 int main()
 {
     int i,j, count, a[10];
@@ -235,6 +266,449 @@ int main()
         test_assert(LSQ_DereferenceIterator(iter) == NULL);
     ENDTEST
 
+    TEST
+        int keys[] = {5, 1, 9, 3, 7, 3, 0};
+        int values[] = {5, 1, 9, 30, 7, 3, 0};
+        seq_push(seq, 3, 4, 8, 9);
+        LSQ_InsertBatch(seq, keys, values, 7);
+        test_assert_seq(seq, 8, 0, 1, 3, 4, 5, 7, 8, 9);
+
+        LSQ_InsertBatch(seq, keys, values, 0);
+        test_assert(LSQ_GetSize(seq) == 8);
+
+        for(i = 0; i < 10; i++)
+            a[i] = 9 - i;
+        LSQ_InsertBatch(seq, a, a, 10);
+        test_assert_seq(seq, 10, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9);
+    ENDTEST
+
+    TEST
+        LSQ_HandleT other = LSQ_CreateSequence();
+        seq_push(seq, 5, 1, 3, 5, 7, 9);
+        seq_push(other, 4, 2, 3, 8, 9);
+        LSQ_InsertElement(other, 9, 90);
+        LSQ_Union(seq, other);
+        test_assert_seq(seq, 7, 1, 2, 3, 5, 7, 8, 90);
+        test_assert(LSQ_GetSize(other) == 0);
+
+        seq_push(other, 3, 0, 5, 8);
+        LSQ_Intersect(seq, other);
+        test_assert_seq(seq, 2, 5, 8);
+        test_assert(LSQ_GetSize(other) == 0);
+
+        seq_push(seq, 3, 1, 2, 3);
+        seq_push(other, 2, 2, 8);
+        LSQ_Difference(seq, other);
+        test_assert_seq(seq, 3, 1, 3, 5);
+
+        LSQ_Difference(seq, seq);
+        test_assert(LSQ_GetSize(seq) == 0);
+        LSQ_DestroySequence(other);
+    ENDTEST
+
+    TEST
+        seq_push(seq, 5, 5, 1, 4, 2, 3);
+        LSQ_SetHashIndex(seq, 1);
+        for(i = 6; i <= 100; i++)
+            LSQ_InsertElement(seq, i, i);
+        for(i = 10; i <= 100; i++)
+            LSQ_DeleteElement(seq, i);
+        LSQ_InsertElement(seq, 3, 30);
+        test_assert_seq(seq, 9, 1, 2, 30, 4, 5, 6, 7, 8, 9);
+
+        iter = LSQ_GetElementByIndex(seq, 7);
+        test_assert(LSQ_GetIteratorKey(iter) == 7);
+        LSQ_DestroyIterator(iter);
+        iter = LSQ_GetElementByIndex(seq, 50);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+
+        LSQ_SetHashIndex(seq, 0);
+        iter = LSQ_GetElementByIndex(seq, 4);
+        test_assert(*LSQ_DereferenceIterator(iter) == 4);
+        LSQ_DestroyIterator(iter);
+    ENDTEST
+
+    TEST
+        LSQ_SetBloomFilter(seq, 0.01);
+        for(i = 0; i < 5000; i++)
+            LSQ_InsertElement(seq, 2 * i, i);
+        for(i = 0, j = 0; i < 10000; i++){
+            iter = LSQ_GetElementByIndex(seq, i);
+            if(i % 2 == 0)
+                test_assert(LSQ_IsIteratorDereferencable(iter) && ITER_VAL(iter) == i / 2);
+            j += !LSQ_IsIteratorPastRear(iter);
+            LSQ_DestroyIterator(iter);
+        }
+        test_assert(j == 5000);
+
+        for(i = 0; i < 5000; i += 2)
+            LSQ_DeleteElement(seq, 2 * i);
+        test_assert(LSQ_GetSize(seq) == 2500);
+        iter = LSQ_GetElementByIndex(seq, 4);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        iter = LSQ_GetElementByIndex(seq, 6);
+        test_assert(ITER_VAL(iter) == 3);
+        LSQ_DestroyIterator(iter);
+
+        LSQ_Freeze(seq);
+        iter = LSQ_GetElementByIndex(seq, 9998);
+        test_assert(ITER_VAL(iter) == 4999);
+        LSQ_DestroyIterator(iter);
+        iter = LSQ_GetElementByIndex(seq, 9996);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        LSQ_SetBloomFilter(seq, 0);
+    ENDTEST
+
+    TEST
+        seq_push(seq, 7, 7, 3, 5, 1, 6, 2, 4);
+        LSQ_Freeze(seq);
+        test_assert_seq(seq, 7, 1, 2, 3, 4, 5, 6, 7);
+
+        LSQ_InsertElement(seq, 8, 8);
+        LSQ_DeleteElement(seq, 1);
+        LSQ_DeleteFrontElement(seq);
+        test_assert_seq(seq, 7, 1, 2, 3, 4, 5, 6, 7);
+
+        iter = LSQ_GetElementByIndex(seq, 5);
+        test_assert(LSQ_GetIteratorKey(iter) == 5);
+        *LSQ_DereferenceIterator(iter) = 50;
+        LSQ_ShiftPosition(iter, 2);
+        test_assert(LSQ_GetIteratorKey(iter) == 7);
+        LSQ_AdvanceOneElement(iter);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_ShiftPosition(iter, -7);
+        test_assert(LSQ_GetIteratorKey(iter) == 1);
+        LSQ_RewindOneElement(iter);
+        test_assert(LSQ_IsIteratorBeforeFirst(iter));
+        LSQ_DestroyIterator(iter);
+
+        iter = LSQ_GetElementByIndex(seq, 0);
+        test_assert(LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        test_assert_seq(seq, 7, 1, 2, 3, 4, 50, 6, 7);
+    ENDTEST
+
+    TEST
+        iter = LSQ_GetPastRearElement(seq);
+        for(i = 1; i <= 5; i++)
+            LSQ_InsertElementHint(seq, iter, 2 * i, 2 * i);
+        test_assert_seq(seq, 5, 2, 4, 6, 8, 10);
+        LSQ_DestroyIterator(iter);
+
+        iter = LSQ_GetElementByIndex(seq, 6);
+        LSQ_InsertElementHint(seq, iter, 5, 5);
+        LSQ_InsertElementHint(seq, iter, 6, 60);
+        LSQ_InsertElementHint(seq, iter, 9, 9);
+        LSQ_InsertElementHint(seq, iter, 0, 0);
+        test_assert_seq(seq, 8, 0, 2, 4, 5, 60, 8, 9, 10);
+        LSQ_DestroyIterator(iter);
+
+        LSQ_DeleteRearElement(seq);
+        LSQ_InsertElement(seq, 11, 11);
+        test_assert_seq(seq, 8, 0, 2, 4, 5, 60, 8, 9, 11);
+    ENDTEST
+
+    TEST
+        LSQ_IntegerIndexT keys[40];
+        LSQ_BaseTypeT *values[40];
+        for(i = 0; i < 20; i++)
+            LSQ_InsertElement(seq, 2 * i, i);
+        for(i = 0; i < 40; i++)
+            keys[i] = 39 - i;
+        LSQ_LookupBatch(seq, keys, values, 40);
+        for(i = 0; i < 40; i++)
+            test_assert(keys[i] % 2 ? values[i] == NULL : *values[i] == keys[i] / 2);
+        *values[1] = 100;
+        test_assert(*values[1] == 100);
+
+        LSQ_Freeze(seq);
+        LSQ_LookupBatch(seq, keys, values, 40);
+        test_assert(*values[1] == 100 && values[2] == NULL && *values[39] == 0);
+    ENDTEST
+
+    TEST
+        LSQ_HandleT other = LSQ_CreateSequence();
+        seq_push(seq, 5, 50, 20, 40, 10, 30);
+        seq_push(other, 2, 5, 60);
+        LSQ_Union(seq, other);
+        LSQ_DestroySequence(other);
+        for(i = 0; i < 3; i++) {
+            iter = LSQ_GetFrontElement(seq);
+            test_assert(ITER_VAL(iter) == (i == 0 ? 5 : 10 * i));
+            LSQ_DestroyIterator(iter);
+            LSQ_DeleteFrontElement(seq);
+        }
+        LSQ_InsertElement(seq, 25, 25);
+        LSQ_DeleteRearElement(seq);
+        iter = LSQ_GetPastRearElement(seq);
+        LSQ_RewindOneElement(iter);
+        test_assert(ITER_VAL(iter) == 50);
+        LSQ_DestroyIterator(iter);
+        test_assert_seq(seq, 4, 25, 30, 40, 50);
+    ENDTEST
+
+    TEST
+        Key64Tree *tree64 = Key64Tree_CreateSequence();
+        Key128Tree *tree128 = Key128Tree_CreateSequence();
+        Key64Tree_Node *node64;
+        Key128Tree_Node *node128;
+        LSQ_Key128T key128;
+        for(i = 10; i > 0; i--) {
+            Key64Tree_InsertElement(tree64, (int64_t) i << 40, i);
+            key128.high = i % 2;
+            key128.low = i;
+            Key128Tree_InsertElement(tree128, key128, i);
+        }
+        Key64Tree_InsertElement(tree64, (int64_t) 3 << 40, 30);
+        Key64Tree_DeleteElement(tree64, (int64_t) 4 << 40);
+        Key64Tree_DeleteElement(tree64, 4);
+        test_assert(Key64Tree_GetSize(tree64) == 9);
+        test_assert(*Key64Tree_GetElementByKey(tree64, (int64_t) 3 << 40) == 30);
+        test_assert(Key64Tree_GetElementByKey(tree64, (int64_t) 4 << 40) == NULL);
+        node64 = Key64Tree_GetFrontNode(tree64);
+        test_assert(node64->key == (int64_t) 1 << 40);
+        test_assert(Key64Tree_GetNextNode(node64)->value == 2);
+
+        key128.high = 1;
+        key128.low = 2;
+        test_assert(Key128Tree_GetElementByKey(tree128, key128) == NULL);
+        key128.high = 0;
+        Key128Tree_DeleteElement(tree128, key128);
+        test_assert(Key128Tree_GetSize(tree128) == 9);
+        node128 = Key128Tree_GetFrontNode(tree128);
+        for(i = 4; i <= 10; i += 2, node128 = Key128Tree_GetNextNode(node128))
+            test_assert(node128->key.high == 0 && node128->value == i);
+        for(i = 1; i <= 9; i += 2, node128 = Key128Tree_GetNextNode(node128))
+            test_assert(node128->key.high == 1 && node128->value == i);
+        test_assert(node128 == NULL);
+
+        Key64Tree_DestroySequence(tree64);
+        Key128Tree_DestroySequence(tree128);
+    ENDTEST
+
+    TEST
+        LSQ_StatsT stats;
+        for(i = 1; i <= 7; i++)
+            LSQ_InsertElement(seq, i, i);
+        iter = LSQ_GetElementByIndex(seq, 7);
+        LSQ_DestroyIterator(iter);
+        LSQ_GetStats(seq, &stats);
+#ifdef LSQ_STATS
+        test_assert(stats.lookups == 1 && stats.lookupDepth == 3);
+        test_assert(stats.rotations == 4 && stats.retraceSteps > 0);
+#else
+        test_assert(stats.lookups == 0 && stats.lookupDepth == 0 && stats.rotations == 0 && stats.retraceSteps == 0);
+#endif
+    ENDTEST
+
+    TEST
+#ifdef LSQ_LATENCY
+        LatencyProfile *profile = latencyCreateProfile();
+        LSQ_SetLatencyProfile(seq, profile);
+        for(i = 1; i <= 7; i++)
+            LSQ_InsertElement(seq, i, i);
+        iter = LSQ_GetFrontElement(seq);
+        LSQ_SetPosition(iter, 5);
+        test_assert(LSQ_GetIteratorKey(iter) == 5);
+        LSQ_DestroyIterator(iter);
+        test_assert(profile->histograms[LATENCY_INSERT_ELEMENT].count == 7);
+        test_assert(profile->histograms[LATENCY_SET_POSITION].count == 1);
+        test_assert(profile->histograms[LATENCY_ADVANCE_ONE_ELEMENT].count == 0);
+        LSQ_DestroySequence(seq);
+        seq = LSQ_CreateSequence();
+        test_assert(profile->histograms[LATENCY_DESTROY_SEQUENCE].count == 1 && profile->nesting == 0);
+        latencyDestroyProfile(profile);
+#else
+        LSQ_SetLatencyProfile(seq, LSQ_HandleInvalid);
+        LSQ_InsertElement(seq, 1, 1);
+        test_assert(LSQ_GetSize(seq) == 1);
+#endif
+    ENDTEST
+
+    TEST
+        Visited visited = {{0}, {0}, 0, 16};
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 0);
+        seq_push(seq, 6, 50, 10, 40, 20, 60, 30);
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 6 && visited.keys[0] == 10 && visited.keys[5] == 60 && visited.values[2] == 30);
+        visited.count = 0;
+        LSQ_ForEachRange(seq, 15, 50, visit, &visited);
+        test_assert(visited.count == 3 && visited.keys[0] == 20 && visited.keys[2] == 40 && visited.values[0] == 21);
+        visited.count = 0;
+        LSQ_ForEachRange(seq, 61, 100, visit, &visited);
+        LSQ_ForEachRange(seq, 40, 40, visit, &visited);
+        test_assert(visited.count == 0);
+        visited.limit = 1;
+        LSQ_ForEachRange(seq, 0, 100, visit, &visited);
+        test_assert(visited.count == 1 && visited.keys[0] == 10);
+        LSQ_Freeze(seq);
+        visited.count = 0;
+        visited.limit = 16;
+        LSQ_ForEachRange(seq, 15, 50, visit, &visited);
+        test_assert(visited.count == 3 && visited.keys[0] == 20 && visited.values[0] == 22);
+        visited.count = 0;
+        LSQ_ForEach(seq, visit, &visited);
+        test_assert(visited.count == 6 && visited.keys[5] == 60 && visited.values[0] == 12);
+        iter = LSQ_GetElementByIndex(seq, 20);
+        test_assert(ITER_VAL(iter) == 24);
+        LSQ_DestroyIterator(iter);
+    ENDTEST
+
+    TEST
+        int state[3] = {0, 0, 0};
+        for(i = 0; i < 2000; i++) {
+            j = Random(10000);
+            LSQ_InsertElement(seq, j, j);
+        }
+        LSQ_ForEach(seq, visitOrdered, state);
+        test_assert(state[0] == LSQ_GetSize(seq) && state[2] == 0);
+        count = 0;
+        iter = LSQ_GetFrontElement(seq);
+        for(; !LSQ_IsIteratorPastRear(iter); LSQ_AdvanceOneElement(iter))
+            count += (LSQ_GetIteratorKey(iter) >= 2500 && LSQ_GetIteratorKey(iter) < 7500);
+        LSQ_DestroyIterator(iter);
+        state[0] = 0;
+        LSQ_ForEachRange(seq, 2500, 7500, visitOrdered, state);
+        test_assert(state[0] == count && state[1] < 7500 && state[2] == 0);
+        LSQ_Freeze(seq);
+        state[0] = 0;
+        LSQ_ForEachRange(seq, 2500, 7500, visitOrdered, state);
+        test_assert(state[0] == count && state[2] == 0);
+        state[0] = 0;
+        LSQ_ForEach(seq, visitOrdered, state);
+        test_assert(state[0] == LSQ_GetSize(seq) && state[2] == 0);
+    ENDTEST
+
+    TEST
+        LSQ_BaseTypeT block[8] = {0};
+        LSQ_BaseTypeT values[3] = {-1, -2, -3};
+        for(i = 0; i < 10; i++)
+            LSQ_InsertElement(seq, 10 * i, i);
+        iter = LSQ_GetElementByIndex(seq, 20);
+        test_assert(LSQ_ReadBlock(iter, block, 5) == 5);
+        test_assert(block[0] == 2 && block[4] == 6 && LSQ_GetIteratorKey(iter) == 70);
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 3 && block[2] == 9 && LSQ_IsIteratorPastRear(iter));
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 0 && LSQ_WriteBlock(iter, values, 3) == 0);
+        LSQ_DestroyIterator(iter);
+        iter = LSQ_GetElementByIndex(seq, 80);
+        test_assert(LSQ_WriteBlock(iter, values, 3) == 2 && LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        test_assert_seq(seq, 10, 0,1,2,3,4,5,6,7,-1,-2);
+        LSQ_Freeze(seq);
+        iter = LSQ_GetElementByIndex(seq, 30);
+        test_assert(LSQ_WriteBlock(iter, values, 3) == 3 && LSQ_GetIteratorKey(iter) == 60);
+        test_assert(LSQ_ReadBlock(iter, block, 8) == 4 && block[0] == 6 && block[3] == -2 && LSQ_IsIteratorPastRear(iter));
+        LSQ_DestroyIterator(iter);
+        test_assert_seq(seq, 10, 0,1,2,-1,-2,-3,6,7,-1,-2);
+    ENDTEST
+
+    TEST
+        LSQ_MemoryUsageT usage, total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 100; i++)
+            LSQ_InsertElement(other, i, i);
+        LSQ_GetMemoryUsage(other, &usage);
+        test_assert(usage.payload == 100 * (sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT)));
+        test_assert(usage.slack == 0 && usage.overhead >= 100 * 3 * sizeof(void *));
+        LSQ_SetHashIndex(other, 1);
+        LSQ_GetMemoryUsage(other, &reduced);
+        test_assert(reduced.overhead > usage.overhead);
+        LSQ_Freeze(other);
+        LSQ_GetMemoryUsage(other, &usage);
+        test_assert(usage.payload == 100 * (sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT)));
+        test_assert(usage.overhead < reduced.overhead / 4);
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequence(other);
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == usage.payload && total.overhead - reduced.overhead == usage.overhead);
+        test_assert(total.slack - reduced.slack == usage.slack);
+    ENDTEST
+
+    TEST
+        LSQ_MemoryUsageT total, reduced;
+        LSQ_HandleT other = LSQ_CreateSequence();
+        for(i = 0; i < 10000; i++)
+            LSQ_InsertElement(other, i, i);
+        LSQ_HandleT small = LSQ_CreateSequence();
+        LSQ_InsertElement(small, 1, 1);
+        LSQ_GetTotalMemoryUsage(&total);
+        LSQ_DestroySequenceAsync(other);
+        LSQ_DestroySequenceAsync(small);
+        LSQ_DestroySequenceAsync(LSQ_HandleInvalid);
+        LSQ_GetTotalMemoryUsage(&reduced);
+        test_assert(total.payload - reduced.payload == 10001 * (sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT)));
+        other = LSQ_CreateSequence();
+        for(i = 0; i < 10000; i++)
+            LSQ_InsertElement(other, i, i);
+        LSQ_Freeze(other);
+        LSQ_DestroySequenceAsync(other);
+        LSQ_WaitForAsyncDestroy();
+        LSQ_GetTotalMemoryUsage(&total);
+        test_assert(total.payload == reduced.payload);
+    ENDTEST
+
+    TEST
+        char path[] = "/tmp/lsq_treeXXXXXX";
+        int descriptor = mkstemp(path);
+        test_assert(descriptor >= 0);
+        close(descriptor);
+        for(i = 0; i < 1000; i++)
+            LSQ_InsertElement(seq, 3 * i, i);
+        test_assert(LSQ_Save(seq, path));
+        LSQ_HandleT other = LSQ_Load(path);
+        test_assert(LSQ_GetSize(other) == 1000);
+        iter = LSQ_GetElementByIndex(other, 2997);
+        test_assert(ITER_VAL(iter) == 999);
+        LSQ_DestroyIterator(iter);
+        LSQ_InsertElement(other, 1, -1);
+        LSQ_DeleteElement(other, 0);
+        iter = LSQ_GetFrontElement(other);
+        test_assert(LSQ_GetIteratorKey(iter) == 1 && ITER_VAL(iter) == -1);
+        LSQ_DestroyIterator(iter);
+        LSQ_DestroySequence(other);
+
+        other = LSQ_LoadMapped(path);
+        test_assert(LSQ_GetSize(other) == 1000);
+        iter = LSQ_GetElementByIndex(other, 300);
+        test_assert(ITER_VAL(iter) == 100);
+        *LSQ_DereferenceIterator(iter) = -1;
+        LSQ_DestroyIterator(iter);
+        LSQ_InsertElement(other, 1, 1);
+        test_assert(LSQ_GetSize(other) == 1000);
+        test_assert(LSQ_Save(other, path));
+        iter = LSQ_GetPastRearElement(other);
+        LSQ_RewindOneElement(iter);
+        test_assert(LSQ_GetIteratorKey(iter) == 2997 && ITER_VAL(iter) == 999);
+        LSQ_DestroyIterator(iter);
+        LSQ_DestroySequence(other);
+        other = LSQ_Load(path);
+        iter = LSQ_GetElementByIndex(other, 300);
+        test_assert(ITER_VAL(iter) == -1);
+        LSQ_DestroyIterator(iter);
+        LSQ_DestroySequence(other);
+
+        other = LSQ_CreateSequence();
+        test_assert(LSQ_Save(other, path));
+        LSQ_DestroySequence(other);
+        other = LSQ_LoadMapped(path);
+        test_assert(other != LSQ_HandleInvalid && LSQ_GetSize(other) == 0);
+        LSQ_DestroySequence(other);
+        other = LSQ_Load(path);
+        test_assert(other != LSQ_HandleInvalid && LSQ_GetSize(other) == 0);
+        LSQ_DestroySequence(other);
+
+        FILE *stream = fopen(path, "w");
+        fputs("not a tree", stream);
+        fclose(stream);
+        test_assert(LSQ_Load(path) == LSQ_HandleInvalid && LSQ_LoadMapped(path) == LSQ_HandleInvalid);
+        unlink(path);
+        test_assert(LSQ_Load(path) == LSQ_HandleInvalid && LSQ_LoadMapped(path) == LSQ_HandleInvalid);
+    ENDTEST
+
     TEST
         seq_push(seq, 7, 7, 4, 2, 0, 1, 3, 9);
         iter = LSQ_GetElementByIndex(seq, 2);
@@ -330,6 +804,7 @@ int main()
             LSQ_DestroyIterator(iter);
         }
     ENDTEST
+
     printf("All tests passed!\n");
 }
 
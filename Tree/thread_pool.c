@@ -0,0 +1,150 @@
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "thread_pool.h"
+
+#define TASK_QUEUED 0
+#define TASK_RUNNING 1
+#define TASK_DONE 2
+
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t taskAvailable;
+    pthread_cond_t taskDone;
+    ThreadPoolTask *head;
+    ThreadPoolTask *tail;
+    pthread_t *workers;
+    int workerCount;
+    int size;
+    int stopping;
+} ThreadPool;
+
+static ThreadPool pool = {PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, PTHREAD_COND_INITIALIZER,
+                          NULL, NULL, NULL, 0, 0, 0};
+
+/* Защищает смену размера пула. Это не pool.mutex: под ним нельзя ждать работников, которым он нужен */
+static pthread_mutex_t resizeMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void unlinkTask(ThreadPoolTask *task) {
+    if (task->prev != NULL)
+        task->prev->next = task->next;
+    else
+        pool.head = task->next;
+    if (task->next != NULL)
+        task->next->prev = task->prev;
+    else
+        pool.tail = task->prev;
+    task->prev = task->next = NULL;
+}
+
+static void runTask(ThreadPoolTask *task) {
+    task->function(task->argument);
+    pthread_mutex_lock(&pool.mutex);
+    task->state = TASK_DONE;
+    pthread_cond_broadcast(&pool.taskDone);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+static void *workerLoop(void *argument) {
+    (void) argument;
+    pthread_mutex_lock(&pool.mutex);
+    while (1) {
+        while (pool.head == NULL && !pool.stopping)
+            pthread_cond_wait(&pool.taskAvailable, &pool.mutex);
+        if (pool.stopping)
+            break;
+        // берем самую старую задачу: она ближе к корню рекурсии и потому крупнее
+        ThreadPoolTask *task = pool.tail;
+        unlinkTask(task);
+        task->state = TASK_RUNNING;
+        pthread_mutex_unlock(&pool.mutex);
+        runTask(task);
+        pthread_mutex_lock(&pool.mutex);
+    }
+    pthread_mutex_unlock(&pool.mutex);
+    return NULL;
+}
+
+static void stopWorkers(void) {
+    pthread_mutex_lock(&pool.mutex);
+    pool.stopping = 1;
+    pthread_cond_broadcast(&pool.taskAvailable);
+    pthread_mutex_unlock(&pool.mutex);
+    for (int i = 0; i < pool.workerCount; i++)
+        pthread_join(pool.workers[i], NULL);
+    free(pool.workers);
+    pool.workers = NULL;
+    pool.workerCount = 0;
+    pool.stopping = 0;
+}
+
+static void startWorkers(int size) {
+    pool.size = size;
+    pool.workers = (pthread_t *) malloc((size - 1) * sizeof(pthread_t));
+    if (pool.workers == NULL)
+        return;
+    for (int i = 0; i < size - 1; i++) {
+        if (pthread_create(&pool.workers[pool.workerCount], NULL, workerLoop, NULL) != 0)
+            break;
+        pool.workerCount++;
+    }
+}
+
+static void resizePool(int size) {
+    if (size <= 0)
+        size = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if (size <= 0)
+        size = 1;
+    if (size == pool.size)
+        return;
+    stopWorkers();
+    startWorkers(size);
+}
+
+extern void threadPoolSetSize(int size) {
+    pthread_mutex_lock(&resizeMutex);
+    resizePool(size);
+    pthread_mutex_unlock(&resizeMutex);
+}
+
+/* Пул запускается при первом обращении; проверка и запуск идут под resizeMutex, иначе два потока, *
+ * одновременно начавшие операции над множествами, запустили бы по набору работников              */
+extern int threadPoolGetSize(void) {
+    pthread_mutex_lock(&resizeMutex);
+    if (pool.size == 0)
+        resizePool(0);
+    int size = pool.workerCount + 1;
+    pthread_mutex_unlock(&resizeMutex);
+    return size;
+}
+
+extern void threadPoolSubmit(ThreadPoolTask *task, void (*function)(void *), void *argument) {
+    task->function = function;
+    task->argument = argument;
+    task->state = TASK_QUEUED;
+    task->prev = NULL;
+    pthread_mutex_lock(&pool.mutex);
+    task->next = pool.head;
+    if (pool.head != NULL)
+        pool.head->prev = task;
+    else
+        pool.tail = task;
+    pool.head = task;
+    pthread_cond_signal(&pool.taskAvailable);
+    pthread_mutex_unlock(&pool.mutex);
+}
+
+extern void threadPoolWait(ThreadPoolTask *task) {
+    pthread_mutex_lock(&pool.mutex);
+    if (task->state == TASK_QUEUED) {
+        unlinkTask(task);
+        task->state = TASK_RUNNING;
+        pthread_mutex_unlock(&pool.mutex);
+        task->function(task->argument);
+        task->state = TASK_DONE;
+        return;
+    }
+    while (task->state != TASK_DONE)
+        pthread_cond_wait(&pool.taskDone, &pool.mutex);
+    pthread_mutex_unlock(&pool.mutex);
+}
@@ -0,0 +1,22 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+/* Задача пула потоков. Память под задачу выделяет вызывающий, задача должна жить до threadPoolWait */
+typedef struct ThreadPoolTask_ {
+    void (*function)(void *);
+    void *argument;
+    int state;
+    struct ThreadPoolTask_ *prev;
+    struct ThreadPoolTask_ *next;
+} ThreadPoolTask;
+
+/* Функция, задающая общее число потоков, включая вызывающий. 0 - по числу процессоров */
+extern void threadPoolSetSize(int size);
+/* Функция, возвращающая общее число потоков пула, включая вызывающий */
+extern int threadPoolGetSize(void);
+/* Функция, ставящая задачу в очередь пула */
+extern void threadPoolSubmit(ThreadPoolTask *task, void (*function)(void *), void *argument);
+/* Функция, ожидающая завершения задачи. Если задача еще не взята потоком пула, она выполняется на месте */
+extern void threadPoolWait(ThreadPoolTask *task);
+
+#endif
@@ -0,0 +1,571 @@
+#include <stdlib.h>
+#include <string.h>
+#include "linear_sequence_assoc.h"
+#include "../Instrumentation/instrumentation.h"
+ 
+
+#define MAXIMUM(a, b) ((a) > (b) ? (a) : (b))
+#define NODE_NONE 0
+#define MAX_DEPTH 48
+#define MIN_CAPACITY 16
+#define CACHE_LINE_SIZE 64
+ 
+/* Горячая часть узла: только то, что читает спуск. Сыновья задаются номерами в пуле узлов, *
+ * NODE_NONE - нет сына. В строку кэша помещаются четыре узла.                              */
+typedef struct {
+    LSQ_IntegerIndexT key;
+    LSQ_IntegerIndexT height;
+    unsigned int leftChild;
+    unsigned int rightChild;
+} Node;
+ 
+/* Узлы и значения лежат в параллельных массивах: значение узла i - values[i], слот 0 не используется. *
+ * Освобожденные узлы связаны в список через leftChild. version меняется при каждом изменении формы.  */
+typedef struct Tree_ {
+    Node *nodes;
+    LSQ_BaseTypeT *values;
+    unsigned int capacity;
+    unsigned int used;
+    unsigned int freeList;
+    unsigned int root;
+    LSQ_IntegerIndexT size;
+    unsigned long version;
+    /* Соседи в списке живых контейнеров */
+    struct Tree_ *nextLive;
+    struct Tree_ *prevLive;
+} Tree;
+ 
+typedef enum {
+    POSITION_BEFORE_FIRST,
+    POSITION_ELEMENT,
+    POSITION_PAST_REAR
+} Position;
+ 
+/* Родителей у узлов нет, итератор хранит путь от корня до текущего узла. Если дерево с тех пор менялось, *
+ * путь строится заново спуском по key; удаленный элемент заменяется следующим за ним.                  */
+typedef struct {
+    Tree *tree;
+    Position position;
+    LSQ_IntegerIndexT key;
+    unsigned long version;
+    int depth;
+    unsigned int path[MAX_DEPTH];
+} Iterator;
+ 
+LIVE_CONTAINERS(Tree)
+ 
+static Iterator *createIterator(Tree *, Position );
+static unsigned int allocateNode(Tree *, LSQ_IntegerIndexT , LSQ_BaseTypeT );
+static void releaseNode(Tree *, unsigned int );
+static int findPath(Tree *, LSQ_IntegerIndexT , unsigned int *, int *);
+static int pathToMin(Tree *, unsigned int , unsigned int *, int );
+static int pathToMax(Tree *, unsigned int , unsigned int *, int );
+static void setElement(Iterator *, int );
+static void validateIterator(Iterator *);
+static LSQ_IntegerIndexT getHeight(Tree *, unsigned int );
+static LSQ_IntegerIndexT getBalanceFactor(Tree *, unsigned int );
+static void fixHeight(Tree *, unsigned int );
+static unsigned int leftRotation(Tree *, unsigned int );
+static unsigned int rightRotation(Tree *, unsigned int );
+static unsigned int balancing(Tree *, unsigned int );
+static void replaceChild(Tree *, unsigned int *, int , unsigned int );
+static void retrace(Tree *, unsigned int *, int );
+static void deleteAtPath(Tree *, unsigned int *, int );
+ 
+LSQ_HandleT LSQ_CreateSequence(void) {
+    Tree *newTree = (Tree *) malloc(sizeof(Tree));
+    if (newTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newTree->nodes = (Node *) aligned_alloc(CACHE_LINE_SIZE, MIN_CAPACITY * sizeof(Node));
+    newTree->values = (LSQ_BaseTypeT *) malloc(MIN_CAPACITY * sizeof(LSQ_BaseTypeT));
+    if (newTree->nodes == LSQ_HandleInvalid || newTree->values == LSQ_HandleInvalid) {
+        free(newTree->nodes);
+        free(newTree->values);
+        free(newTree);
+        return LSQ_HandleInvalid;
+    }
+    newTree->capacity = MIN_CAPACITY;
+    newTree->used = 1;
+    newTree->freeList = NODE_NONE;
+    newTree->root = NODE_NONE;
+    newTree->size = 0;
+    newTree->version = 0;
+    registerContainer(newTree);
+    return newTree;
+}
+ 
+void LSQ_DestroySequence(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    unregisterContainer(tmpTree);
+    free(tmpTree->nodes);
+    free(tmpTree->values);
+    free(tmpTree);
+}
+ 
+LSQ_IntegerIndexT LSQ_GetSize(LSQ_HandleT handle){
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid) {
+        return 0;
+    }
+    return tmpTree->size;
+}
+ 
+extern void LSQ_GetMemoryUsage(LSQ_HandleT handle, LSQ_MemoryUsageT *usage) {
+    Tree *tmpTree = (Tree *) handle;
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    size_t elementBytes = sizeof(LSQ_IntegerIndexT) + sizeof(LSQ_BaseTypeT);
+    size_t nodeBytes = sizeof(Node) + sizeof(LSQ_BaseTypeT);
+    usage->payload = tmpTree->size * elementBytes;
+    usage->overhead = sizeof(Tree) + (tmpTree->size + 1) * nodeBytes - usage->payload;
+    usage->slack = (tmpTree->capacity - 1 - tmpTree->size) * nodeBytes;
+}
+ 
+extern void LSQ_GetTotalMemoryUsage(LSQ_MemoryUsageT *usage) {
+    if (usage == LSQ_HandleInvalid)
+        return;
+    *usage = (LSQ_MemoryUsageT) {0, 0, 0};
+    lockLiveContainers();
+    for (Tree *container = liveContainers; container != LSQ_HandleInvalid; container = container->nextLive) {
+        LSQ_MemoryUsageT containerUsage;
+        LSQ_GetMemoryUsage(container, &containerUsage);
+        usage->payload += containerUsage.payload;
+        usage->overhead += containerUsage.overhead;
+        usage->slack += containerUsage.slack;
+    }
+    unlockLiveContainers();
+}
+ 
+
+int LSQ_IsIteratorDereferencable(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_ELEMENT;
+}
+ 
+extern int LSQ_IsIteratorPastRear(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_PAST_REAR;
+}
+ 
+extern int LSQ_IsIteratorBeforeFirst(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid)
+        return 0;
+    validateIterator(tmpIterator);
+    return tmpIterator->position == POSITION_BEFORE_FIRST;
+}
+ 
+extern LSQ_BaseTypeT* LSQ_DereferenceIterator(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return &tmpIterator->tree->values[tmpIterator->path[tmpIterator->depth - 1]];
+}
+ 
+extern LSQ_IntegerIndexT LSQ_GetIteratorKey(LSQ_IteratorT iterator) {
+    if (!LSQ_IsIteratorDereferencable(iterator)){
+        return -1;
+    }
+    Iterator *tmpIterator = (Iterator *) iterator;
+    return tmpIterator->key;
+}
+ 
+extern LSQ_IteratorT LSQ_GetElementByIndex(LSQ_HandleT handle, LSQ_IntegerIndexT index) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid) {
+        return LSQ_HandleInvalid;
+    }
+    Iterator *tmpIterator = createIterator(tmpTree, POSITION_PAST_REAR);
+    if (tmpIterator != LSQ_HandleInvalid && findPath(tmpTree, index, tmpIterator->path, &tmpIterator->depth))
+        setElement(tmpIterator, tmpIterator->depth);
+    return tmpIterator;
+}
+ 
+extern LSQ_IteratorT LSQ_GetFrontElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    Iterator *tmpIterator = createIterator(tmpTree, POSITION_BEFORE_FIRST);
+    LSQ_AdvanceOneElement(tmpIterator);
+    return tmpIterator;
+}
+ 
+extern LSQ_IteratorT LSQ_GetPastRearElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    return createIterator(tmpTree, POSITION_PAST_REAR);
+}
+ 
+extern void LSQ_DestroyIterator(LSQ_IteratorT iterator){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    free(tmpIterator);
+}
+ 
+
+extern void LSQ_AdvanceOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *)iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid || LSQ_IsIteratorPastRear(tmpIterator))
+        return;
+    Tree *tmpTree = tmpIterator->tree;
+    unsigned int *path = tmpIterator->path;
+ 
+    if (tmpIterator->position == POSITION_BEFORE_FIRST) {
+        setElement(tmpIterator, pathToMin(tmpTree, tmpTree->root, path, 0));
+        return;
+    }
+    int depth = tmpIterator->depth;
+    unsigned int child = tmpTree->nodes[path[depth - 1]].rightChild;
+    if (child != NODE_NONE) {
+        setElement(tmpIterator, pathToMin(tmpTree, child, path, depth));
+        return;
+    }
+    child = path[--depth];
+    while (depth > 0 && tmpTree->nodes[path[depth - 1]].rightChild == child)
+        child = path[--depth];
+    setElement(tmpIterator, depth);
+}
+ 
+extern void LSQ_RewindOneElement(LSQ_IteratorT iterator) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || tmpIterator->tree == LSQ_HandleInvalid || LSQ_IsIteratorBeforeFirst(tmpIterator))
+        return;
+    Tree *tmpTree = tmpIterator->tree;
+    unsigned int *path = tmpIterator->path;
+ 
+    if (tmpIterator->position == POSITION_PAST_REAR) {
+        setElement(tmpIterator, pathToMax(tmpTree, tmpTree->root, path, 0));
+        if (tmpIterator->depth == 0)
+            tmpIterator->position = POSITION_BEFORE_FIRST;
+        return;
+    }
+    int depth = tmpIterator->depth;
+    unsigned int child = tmpTree->nodes[path[depth - 1]].leftChild;
+    if (child != NODE_NONE) {
+        setElement(tmpIterator, pathToMax(tmpTree, child, path, depth));
+        return;
+    }
+    child = path[--depth];
+    while (depth > 0 && tmpTree->nodes[path[depth - 1]].leftChild == child)
+        child = path[--depth];
+    setElement(tmpIterator, depth);
+    if (depth == 0)
+        tmpIterator->position = POSITION_BEFORE_FIRST;
+}
+ 
+
+extern void LSQ_ShiftPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT shift) {
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid || shift == 0)
+        return;
+    if (shift > 0) {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorPastRear(tmpIterator); i--) {
+            LSQ_AdvanceOneElement(tmpIterator);
+        }
+    }
+    else {
+        for (LSQ_IntegerIndexT i = shift; i != 0 && !LSQ_IsIteratorBeforeFirst(tmpIterator); i++) {
+            LSQ_RewindOneElement(tmpIterator);
+        }
+    }
+}
+ 
+/* Как и в LSQ_GetElementByIndex, номер элемента ассоциативного контейнера - его ключ */
+extern void LSQ_SetPosition(LSQ_IteratorT iterator, LSQ_IntegerIndexT pos){
+    Iterator *tmpIterator = (Iterator *) iterator;
+    if (tmpIterator == LSQ_HandleInvalid) {
+        return;
+    }
+    tmpIterator->version = tmpIterator->tree->version;
+    tmpIterator->position = POSITION_PAST_REAR;
+    if (findPath(tmpIterator->tree, pos, tmpIterator->path, &tmpIterator->depth))
+        setElement(tmpIterator, tmpIterator->depth);
+}
+ 
+extern void LSQ_InsertElement(LSQ_HandleT handle, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    unsigned int path[MAX_DEPTH];
+    int depth;
+    if (findPath(tmpTree, key, path, &depth)) {
+        tmpTree->values[path[depth - 1]] = value;
+        return;
+    }
+ 
+    unsigned int newNode = allocateNode(tmpTree, key, value);
+    if (newNode == NODE_NONE)
+        return;
+    if (depth == 0)
+        tmpTree->root = newNode;
+    else if (key < tmpTree->nodes[path[depth - 1]].key)
+        tmpTree->nodes[path[depth - 1]].leftChild = newNode;
+    else
+        tmpTree->nodes[path[depth - 1]].rightChild = newNode;
+    tmpTree->size++;
+    tmpTree->version++;
+    retrace(tmpTree, path, depth);
+}
+ 
+extern void LSQ_DeleteFrontElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->root == NODE_NONE)
+        return;
+    unsigned int path[MAX_DEPTH];
+    deleteAtPath(tmpTree, path, pathToMin(tmpTree, tmpTree->root, path, 0));
+}
+ 
+extern void LSQ_DeleteRearElement(LSQ_HandleT handle) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid || tmpTree->root == NODE_NONE)
+        return;
+    unsigned int path[MAX_DEPTH];
+    deleteAtPath(tmpTree, path, pathToMax(tmpTree, tmpTree->root, path, 0));
+}
+ 
+extern void LSQ_DeleteElement(LSQ_HandleT handle, LSQ_IntegerIndexT key) {
+    Tree *tmpTree = (Tree *) handle;
+    if (tmpTree == LSQ_HandleInvalid)
+        return;
+    unsigned int path[MAX_DEPTH];
+    int depth;
+    if (findPath(tmpTree, key, path, &depth))
+        deleteAtPath(tmpTree, path, depth);
+}
+ 
+static Iterator *createIterator(Tree *tree, Position position) {
+    Iterator *newIterator = (Iterator *) malloc(sizeof(Iterator));
+    if (newIterator == LSQ_HandleInvalid)
+        return LSQ_HandleInvalid;
+    newIterator->tree = tree;
+    newIterator->position = position;
+    newIterator->key = 0;
+    newIterator->version = tree->version;
+    newIterator->depth = 0;
+    return newIterator;
+}
+ 
+/* Пул растет вдвое; массив узлов остается выровненным по строке кэша */
+static unsigned int allocateNode(Tree *tree, LSQ_IntegerIndexT key, LSQ_BaseTypeT value) {
+    unsigned int node = tree->freeList;
+    if (node != NODE_NONE) {
+        tree->freeList = tree->nodes[node].leftChild;
+    }
+    else {
+        if (tree->used == tree->capacity) {
+            unsigned int capacity = 2 * tree->capacity;
+            Node *nodes = (Node *) aligned_alloc(CACHE_LINE_SIZE, capacity * sizeof(Node));
+            LSQ_BaseTypeT *values = (LSQ_BaseTypeT *) realloc(tree->values, capacity * sizeof(LSQ_BaseTypeT));
+            if (values != LSQ_HandleInvalid)
+                tree->values = values;
+            if (nodes == LSQ_HandleInvalid || values == LSQ_HandleInvalid) {
+                free(nodes);
+                return NODE_NONE;
+            }
+            memcpy(nodes, tree->nodes, tree->used * sizeof(Node));
+            free(tree->nodes);
+            tree->nodes = nodes;
+            tree->capacity = capacity;
+        }
+        node = tree->used++;
+    }
+    tree->nodes[node].key = key;
+    tree->nodes[node].height = 0;
+    tree->nodes[node].leftChild = NODE_NONE;
+    tree->nodes[node].rightChild = NODE_NONE;
+    tree->values[node] = value;
+    return node;
+}
+ 
+static void releaseNode(Tree *tree, unsigned int node) {
+    tree->nodes[node].leftChild = tree->freeList;
+    tree->freeList = node;
+}
+ 
+/* Спуск по ключу с запоминанием пути. Возвращает 1, если ключ найден (он в конце пути); *
+ * иначе путь заканчивается узлом, к которому следует подвесить новый ключ.             */
+static int findPath(Tree *tree, LSQ_IntegerIndexT key, unsigned int *path, int *depth) {
+    Node *nodes = tree->nodes;
+    unsigned int node = tree->root;
+    int tmpDepth = 0;
+    while (node != NODE_NONE) {
+        path[tmpDepth++] = node;
+        if (key < nodes[node].key)
+            node = nodes[node].leftChild;
+        else if (key > nodes[node].key)
+            node = nodes[node].rightChild;
+        else {
+            *depth = tmpDepth;
+            return 1;
+        }
+    }
+    *depth = tmpDepth;
+    return 0;
+}
+ 
+static int pathToMin(Tree *tree, unsigned int node, unsigned int *path, int depth) {
+    while (node != NODE_NONE) {
+        path[depth++] = node;
+        node = tree->nodes[node].leftChild;
+    }
+    return depth;
+}
+ 
+static int pathToMax(Tree *tree, unsigned int node, unsigned int *path, int depth) {
+    while (node != NODE_NONE) {
+        path[depth++] = node;
+        node = tree->nodes[node].rightChild;
+    }
+    return depth;
+}
+ 
+static void setElement(Iterator *iterator, int depth) {
+    iterator->depth = depth;
+    iterator->position = (depth == 0) ? POSITION_PAST_REAR : POSITION_ELEMENT;
+    if (depth != 0)
+        iterator->key = iterator->tree->nodes[iterator->path[depth - 1]].key;
+}
+ 
+static void validateIterator(Iterator *iterator) {
+    Tree *tree = iterator->tree;
+    if (iterator->version == tree->version)
+        return;
+    iterator->version = tree->version;
+    if (iterator->position != POSITION_ELEMENT)
+        return;
+ 
+    int depth = 0;
+    int nextDepth = 0;
+    unsigned int node = tree->root;
+    while (node != NODE_NONE) {
+        iterator->path[depth++] = node;
+        if (iterator->key < tree->nodes[node].key) {
+            nextDepth = depth;
+            node = tree->nodes[node].leftChild;
+        }
+        else if (iterator->key > tree->nodes[node].key)
+            node = tree->nodes[node].rightChild;
+        else {
+            iterator->depth = depth;
+            return;
+        }
+    }
+    setElement(iterator, nextDepth);
+}
+ 
+static LSQ_IntegerIndexT getHeight(Tree *tree, unsigned int node) {
+    return ((node != NODE_NONE) ? tree->nodes[node].height : -1);
+}
+ 
+static LSQ_IntegerIndexT getBalanceFactor(Tree *tree, unsigned int node) {
+    return getHeight(tree, tree->nodes[node].leftChild) - getHeight(tree, tree->nodes[node].rightChild);
+}
+ 
+static void fixHeight(Tree *tree, unsigned int node) {
+    tree->nodes[node].height = MAXIMUM(getHeight(tree, tree->nodes[node].leftChild),
+                                       getHeight(tree, tree->nodes[node].rightChild)) + 1;
+}
+ 
+static unsigned int leftRotation(Tree *tree, unsigned int root) {
+    unsigned int newRoot = tree->nodes[root].rightChild;
+    tree->nodes[root].rightChild = tree->nodes[newRoot].leftChild;
+    tree->nodes[newRoot].leftChild = root;
+    fixHeight(tree, root);
+    fixHeight(tree, newRoot);
+    return newRoot;
+}
+ 
+static unsigned int rightRotation(Tree *tree, unsigned int root) {
+    unsigned int newRoot = tree->nodes[root].leftChild;
+    tree->nodes[root].leftChild = tree->nodes[newRoot].rightChild;
+    tree->nodes[newRoot].rightChild = root;
+    fixHeight(tree, root);
+    fixHeight(tree, newRoot);
+    return newRoot;
+}
+ 
+/* Возвращает новый корень поддерева */
+static unsigned int balancing(Tree *tree, unsigned int root) {
+    LSQ_IntegerIndexT balanceFactor = getBalanceFactor(tree, root);
+    if (balanceFactor == 2) {
+        if (getBalanceFactor(tree, tree->nodes[root].leftChild) < 0)
+            tree->nodes[root].leftChild = leftRotation(tree, tree->nodes[root].leftChild);
+        return rightRotation(tree, root);
+    }
+    if (balanceFactor == -2) {
+        if (getBalanceFactor(tree, tree->nodes[root].rightChild) > 0)
+            tree->nodes[root].rightChild = rightRotation(tree, tree->nodes[root].rightChild);
+        return leftRotation(tree, root);
+    }
+    return root;
+}
+ 
+/* Заменяет узел path[level] в его родителе (path[level - 1]) на substitute */
+static void replaceChild(Tree *tree, unsigned int *path, int level, unsigned int substitute) {
+    if (level == 0)
+        tree->root = substitute;
+    else if (tree->nodes[path[level - 1]].leftChild == path[level])
+        tree->nodes[path[level - 1]].leftChild = substitute;
+    else
+        tree->nodes[path[level - 1]].rightChild = substitute;
+    path[level] = substitute;
+}
+ 
+/* Пересчет высот и балансировка узлов path[depth - 1] ... path[0]. Как только высота поддерева *
+ * оказывается прежней, выше ничего не меняется.                                               */
+static void retrace(Tree *tree, unsigned int *path, int depth) {
+    for (int level = depth - 1; level >= 0; level--) {
+        unsigned int node = path[level];
+        LSQ_IntegerIndexT oldHeight = tree->nodes[node].height;
+        fixHeight(tree, node);
+        unsigned int newRoot = balancing(tree, node);
+        if (newRoot != node)
+            replaceChild(tree, path, level, newRoot);
+        if (tree->nodes[newRoot].height == oldHeight)
+            return;
+    }
+}
+ 
+/* Удаление узла path[depth - 1]. Узел с двумя сыновьями заменяется преемником перевешиванием, *
+ * ключи и значения не копируются.                                                            */
+static void deleteAtPath(Tree *tree, unsigned int *path, int depth) {
+    int level = depth - 1;
+    unsigned int node = path[level];
+    Node *nodes = tree->nodes;
+    if (nodes[node].leftChild == NODE_NONE || nodes[node].rightChild == NODE_NONE) {
+        unsigned int child = (nodes[node].leftChild != NODE_NONE) ? nodes[node].leftChild : nodes[node].rightChild;
+        replaceChild(tree, path, level, child);
+        depth = level;
+    }
+    else {
+        depth = pathToMin(tree, nodes[node].rightChild, path, depth);
+        unsigned int successor = path[depth - 1];
+        if (depth - 1 > level + 1) {
+            nodes[path[depth - 2]].leftChild = nodes[successor].rightChild;
+            nodes[successor].rightChild = nodes[node].rightChild;
+            depth--;
+        }
+        else {
+            depth = level + 1;
+        }
+        nodes[successor].leftChild = nodes[node].leftChild;
+        nodes[successor].height = nodes[node].height;
+        replaceChild(tree, path, level, successor);
+    }
+    releaseNode(tree, node);
+    tree->size--;
+    tree->version++;
+    retrace(tree, path, depth);
+}